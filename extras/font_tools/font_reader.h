@@ -0,0 +1,273 @@
+// Host side helpers shared by the font tools, used to read ILI9341_t3 and
+// Adafruit GFX fonts into a plain per pixel form.
+//
+// Glyph positions are normalized so that x offsets are from the cursor and
+// y offsets are from the top of the text line (cursor y for ILI fonts).
+#ifndef _FONT_READER_H_
+#define _FONT_READER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "../../src/ILI9341_fonts.h"
+#include "../../src/RLE_fonts.h"
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#ifndef _GFXFONT_H_
+#define _GFXFONT_H_
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t *bitmap;
+    GFXglyph *glyph;
+    uint8_t first;
+    uint8_t last;
+    uint8_t yAdvance;
+} GFXfont;
+#endif // _GFXFONT_H_
+
+struct FontGlyph {
+    bool present = false;
+    int width = 0, height = 0;
+    int xoffset = 0, yoffset = 0;
+    int delta = 0;
+    std::vector<uint8_t> alpha; // width * height values, 0 to FontInfo::alpha_max
+};
+
+struct FontInfo {
+    int alpha_max = 1;
+    int line_space = 0;
+    int cap_height = 0;
+    unsigned first = 0, last = 0;
+    std::vector<FontGlyph> glyphs; // first through last
+};
+
+//-----------------------------------------------------------------------------
+// Same bit readers as Teensy_Parallel_GFX.cpp
+//-----------------------------------------------------------------------------
+inline uint32_t fetchbits_unsigned(const uint8_t *p, uint32_t index, uint32_t required) {
+    uint32_t val = 0;
+    do {
+        uint8_t b = p[index >> 3];
+        uint32_t avail = 8 - (index & 7);
+        if (avail <= required) {
+            val <<= avail;
+            val |= b & ((1 << avail) - 1);
+            index += avail;
+            required -= avail;
+        } else {
+            b >>= avail - required;
+            val <<= required;
+            val |= b & ((1 << required) - 1);
+            break;
+        }
+    } while (required);
+    return val;
+}
+
+inline int32_t fetchbits_signed(const uint8_t *p, uint32_t index, uint32_t required) {
+    uint32_t val = fetchbits_unsigned(p, index, required);
+    if (val & (1 << (required - 1))) {
+        return (int32_t)val - (1 << required);
+    }
+    return (int32_t)val;
+}
+
+//-----------------------------------------------------------------------------
+// ILI9341_t3 fonts
+//-----------------------------------------------------------------------------
+// Subset fonts, unicode is the remap table
+inline bool ili_remapped(const ILI9341_t3_font_t *font) {
+    return (font->version & ILI9341_FONT_VERSION_REMAPPED) && font->unicode;
+}
+// 1 or 23 (anti-aliased), without the remapped flag
+inline unsigned ili_version(const ILI9341_t3_font_t *font) { return font->version & ~ILI9341_FONT_VERSION_REMAPPED; }
+
+inline unsigned ili_glyph_count(const ILI9341_t3_font_t *font) {
+    if (ili_remapped(font)) {
+        // subset font, the remap table holds slot + 1
+        unsigned count = 0;
+        for (unsigned i = 0; i <= (unsigned)(font->index1_last - font->index1_first); i++) {
+            if (font->unicode[i] > count)
+                count = font->unicode[i];
+        }
+        return count;
+    }
+    unsigned count = font->index1_last - font->index1_first + 1;
+    if (font->index2_last >= font->index2_first && font->index2_first)
+        count += font->index2_last - font->index2_first + 1;
+    return count;
+}
+
+// Returns the index slot used for character c, or -1 when not in the font
+inline int ili_glyph_slot(const ILI9341_t3_font_t *font, unsigned c) {
+    if (ili_remapped(font)) {
+        if (c < font->index1_first || c > font->index1_last)
+            return -1;
+        return (int)font->unicode[c - font->index1_first] - 1;
+    }
+    if (c >= font->index1_first && c <= font->index1_last)
+        return c - font->index1_first;
+    if (c >= font->index2_first && c <= font->index2_last)
+        return c - font->index2_first + font->index1_last - font->index1_first + 1;
+    return -1;
+}
+
+// Decodes the glyph for c.  Optionally returns the byte offset of the glyph in
+// font->data and the number of bits the glyph uses.
+inline bool ili_decode_glyph(const ILI9341_t3_font_t *font, unsigned c, FontGlyph &g,
+                             uint32_t *pdata_offset = nullptr, uint32_t *pbits = nullptr) {
+    int slot = ili_glyph_slot(font, c);
+    if (slot < 0)
+        return false;
+    uint32_t data_offset = fetchbits_unsigned(font->index, slot * font->bits_index, font->bits_index);
+    const uint8_t *data = font->data + data_offset;
+    if (fetchbits_unsigned(data, 0, 3) != 0)
+        return false; // unknown encoding
+
+    uint32_t bitoffset = 3;
+    g.width = fetchbits_unsigned(data, bitoffset, font->bits_width);
+    bitoffset += font->bits_width;
+    g.height = fetchbits_unsigned(data, bitoffset, font->bits_height);
+    bitoffset += font->bits_height;
+    g.xoffset = fetchbits_signed(data, bitoffset, font->bits_xoffset);
+    bitoffset += font->bits_xoffset;
+    int yoffset = fetchbits_signed(data, bitoffset, font->bits_yoffset);
+    bitoffset += font->bits_yoffset;
+    g.delta = fetchbits_unsigned(data, bitoffset, font->bits_delta);
+    bitoffset += font->bits_delta;
+    g.yoffset = font->cap_height - g.height - yoffset;
+    g.alpha.assign(g.width * g.height, 0);
+    g.present = true;
+
+    if (ili_version(font) == 23) {
+        // Anti-aliased, fixed number of bits per pixel starting on a byte boundary
+        uint32_t bpp = (font->reserved & 0b000011) + 1;
+        bitoffset = (bitoffset + 7) & ~7;
+        for (int i = 0; i < g.width * g.height; i++) {
+            g.alpha[i] = fetchbits_unsigned(data, bitoffset, bpp);
+            bitoffset += bpp;
+        }
+    } else {
+        int y = 0;
+        while (y < g.height) {
+            uint32_t n = 1;
+            if (fetchbits_unsigned(data, bitoffset++, 1)) {
+                n = fetchbits_unsigned(data, bitoffset, 3) + 2;
+                bitoffset += 3;
+            }
+            for (int x = 0; x < g.width; x++) {
+                uint8_t bit = fetchbits_unsigned(data, bitoffset + x, 1);
+                for (uint32_t r = 0; (r < n) && ((y + (int)r) < g.height); r++)
+                    g.alpha[(y + r) * g.width + x] = bit;
+            }
+            bitoffset += g.width;
+            y += n;
+        }
+    }
+    if (pdata_offset)
+        *pdata_offset = data_offset;
+    if (pbits)
+        *pbits = bitoffset;
+    return true;
+}
+
+inline bool read_ili_font(const ILI9341_t3_font_t *font, FontInfo &info) {
+    info.alpha_max = 1;
+    if (ili_version(font) == 23)
+        info.alpha_max = (1 << ((font->reserved & 0b000011) + 1)) - 1;
+    info.line_space = font->line_space;
+    info.cap_height = font->cap_height;
+    info.first = font->index1_first;
+    info.last = font->index1_last;
+    if (font->index2_first && (font->index2_last >= font->index2_first)) {
+        if (font->index2_first < info.first)
+            info.first = font->index2_first;
+        if (font->index2_last > info.last)
+            info.last = font->index2_last;
+    }
+    info.glyphs.assign(info.last - info.first + 1, FontGlyph());
+    for (unsigned c = info.first; c <= info.last; c++)
+        ili_decode_glyph(font, c, info.glyphs[c - info.first]);
+    return true;
+}
+
+// Size of the index and data arrays of an ILI font, for reporting savings.
+inline uint32_t ili_font_size(const ILI9341_t3_font_t *font) {
+    unsigned count = ili_glyph_count(font);
+    uint32_t data_end = 0;
+    for (unsigned slot = 0; slot < count; slot++) {
+        uint32_t data_offset = fetchbits_unsigned(font->index, slot * font->bits_index, font->bits_index);
+        if (data_offset > data_end)
+            data_end = data_offset;
+    }
+    // add the size of the last glyph
+    FontGlyph g;
+    for (unsigned c = font->index1_first; c <= 0xffff; c++) {
+        uint32_t offset, bits;
+        if (ili_glyph_slot(font, c) < 0) {
+            if (c > font->index1_last && c > font->index2_last)
+                break;
+            continue;
+        }
+        if (ili_decode_glyph(font, c, g, &offset, &bits) && (offset == data_end)) {
+            data_end += (bits + 7) / 8;
+            break;
+        }
+    }
+    data_end += (count * font->bits_index + 7) / 8;
+    if (ili_remapped(font))
+        data_end += font->index1_last - font->index1_first + 1;
+    return data_end;
+}
+
+//-----------------------------------------------------------------------------
+// Adafruit GFX fonts
+//-----------------------------------------------------------------------------
+inline bool read_gfx_font(const GFXfont *font, FontInfo &info) {
+    info.alpha_max = 1;
+    info.first = font->first;
+    info.last = font->last;
+    info.line_space = font->yAdvance;
+    info.glyphs.assign(info.last - info.first + 1, FontGlyph());
+
+    // GFX fonts are relative to the baseline, move it down so the tallest
+    // glyph starts at the top of the line.
+    int baseline = 0;
+    for (unsigned c = info.first; c <= info.last; c++) {
+        int top = -font->glyph[c - info.first].yOffset;
+        if (top > baseline)
+            baseline = top;
+    }
+    info.cap_height = baseline;
+
+    for (unsigned c = info.first; c <= info.last; c++) {
+        const GFXglyph *glyph = &font->glyph[c - info.first];
+        FontGlyph &g = info.glyphs[c - info.first];
+        g.present = true;
+        g.width = glyph->width;
+        g.height = glyph->height;
+        g.xoffset = glyph->xOffset;
+        g.yoffset = baseline + glyph->yOffset;
+        g.delta = glyph->xAdvance;
+        g.alpha.assign(g.width * g.height, 0);
+        const uint8_t *bitmap = font->bitmap + glyph->bitmapOffset;
+        for (int i = 0; i < g.width * g.height; i++)
+            g.alpha[i] = (bitmap[i >> 3] >> (7 - (i & 7))) & 1;
+    }
+    return true;
+}
+
+#endif // _FONT_READER_H_
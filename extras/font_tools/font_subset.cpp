@@ -0,0 +1,225 @@
+// Rebuilds ILI9341_t3 fonts with only the characters an application uses.
+// See README.md for usage.
+//
+// The glyph data is copied over bit for bit, only the index is rebuilt.  The
+// kept characters get a dense index and the font's unicode field points to a
+// remap table from character to index slot + 1 (0 for left out characters),
+// which Teensy_Parallel_GFX uses to find glyphs with a single table read.  The
+// version gets ILI9341_FONT_VERSION_REMAPPED so the table isn't mistaken for
+// anything else.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "fonts_shipped.h"
+
+static void usage() {
+    fprintf(stderr, "usage: font_subset [-o out_base] [-s suffix] [-c chars] [-r first-last] [-f file] font_name ...\n");
+    fprintf(stderr, "  -c chars      keep these characters, e.g. -c \"0123456789:.-\"\n");
+    fprintf(stderr, "  -r first-last keep a range of character codes, e.g. -r 0x30-0x39 or -r 65-90\n");
+    fprintf(stderr, "  -f file       keep every character used in a text file\n");
+    fprintf(stderr, "  -s suffix     appended to the font names (default _subset)\n");
+    fprintf(stderr, "  -o out_base   write out_base.c and out_base.h (default font_subset_out)\n");
+    fprintf(stderr, "  font_name     one of the fonts in src/ like Arial_96 or Arial_32_Bold\n");
+    exit(1);
+}
+
+struct SubsetFontOut {
+    std::string name;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> index;
+    std::vector<uint8_t> remap;
+    ILI9341_t3_font_t font;
+    uint32_t source_size;
+};
+
+// Append value to a MSB first bit stream, the order fetchbits_unsigned reads
+static void put_bits(std::vector<uint8_t> &stream, uint32_t &bit_pos, uint32_t value, uint32_t bits) {
+    while (bits--) {
+        if ((bit_pos >> 3) >= stream.size())
+            stream.push_back(0);
+        if (value & (1 << bits))
+            stream[bit_pos >> 3] |= 0x80 >> (bit_pos & 7);
+        bit_pos++;
+    }
+}
+
+static bool subset_font(const char *font_name, const ILI9341_t3_font_t *src, const bool keep[256],
+                        SubsetFontOut &out) {
+    std::vector<uint32_t> offsets;
+    unsigned first = 256, last = 0;
+    for (unsigned c = 0; c < 256; c++) {
+        FontGlyph g;
+        uint32_t offset, bits;
+        if (!keep[c] || !ili_decode_glyph(src, c, g, &offset, &bits))
+            continue;
+        if (first > c)
+            first = c;
+        last = c;
+        offsets.push_back(out.data.size());
+        out.data.insert(out.data.end(), src->data + offset, src->data + offset + (bits + 7) / 8);
+    }
+    if (offsets.empty()) {
+        fprintf(stderr, "%s: none of the characters are in the font\n", font_name);
+        return false;
+    }
+    if (offsets.size() > 255) {
+        fprintf(stderr, "%s: too many characters for the remap table\n", font_name);
+        return false;
+    }
+
+    uint32_t bits_index = 1;
+    while ((1u << bits_index) <= offsets.back())
+        bits_index++;
+    uint32_t bit_pos = 0;
+    for (uint32_t offset : offsets)
+        put_bits(out.index, bit_pos, offset, bits_index);
+
+    uint8_t slot = 0;
+    for (unsigned c = first; c <= last; c++) {
+        FontGlyph g;
+        out.remap.push_back((keep[c] && ili_decode_glyph(src, c, g)) ? ++slot : 0);
+    }
+
+    out.font = *src;
+    out.font.version |= ILI9341_FONT_VERSION_REMAPPED;
+    out.font.index1_first = first;
+    out.font.index1_last = last;
+    out.font.index2_first = 0;
+    out.font.index2_last = 0;
+    out.font.bits_index = bits_index;
+    out.source_size = ili_font_size(src);
+    return true;
+}
+
+static void write_bytes(FILE *f, const std::vector<uint8_t> &data) {
+    for (size_t i = 0; i < data.size(); i++) {
+        fprintf(f, "0x%02X,", data[i]);
+        if ((i % 10) == 9 || (i + 1) == data.size())
+            fprintf(f, "\n");
+    }
+}
+
+static bool write_output(const char *out_base, const std::vector<SubsetFontOut> &fonts) {
+    std::string base(out_base);
+    std::string file_name = base.substr(base.find_last_of('/') + 1);
+    std::string guard = "_" + file_name + "_";
+
+    FILE *fh = fopen((base + ".h").c_str(), "w");
+    if (!fh) {
+        perror((base + ".h").c_str());
+        return false;
+    }
+    fprintf(fh, "#ifndef %s\n#define %s\n\n#include \"ILI9341_fonts.h\"\n\n", guard.c_str(), guard.c_str());
+    fprintf(fh, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    for (auto &font : fonts)
+        fprintf(fh, "extern const ILI9341_t3_font_t %s;\n", font.name.c_str());
+    fprintf(fh, "\n#ifdef __cplusplus\n} // extern \"C\"\n#endif\n\n#endif\n");
+    fclose(fh);
+
+    FILE *fc = fopen((base + ".c").c_str(), "w");
+    if (!fc) {
+        perror((base + ".c").c_str());
+        return false;
+    }
+    fprintf(fc, "#include \"%s.h\"\n\n", file_name.c_str());
+    for (auto &out : fonts) {
+        const char *name = out.name.c_str();
+        fprintf(fc, "static const unsigned char %s_data[] = {\n", name);
+        write_bytes(fc, out.data);
+        fprintf(fc, "};\n/* font data size: %u bytes */\n\n", (unsigned)out.data.size());
+        fprintf(fc, "static const unsigned char %s_index[] = {\n", name);
+        write_bytes(fc, out.index);
+        fprintf(fc, "};\n/* font index size: %u bytes */\n\n", (unsigned)out.index.size());
+        fprintf(fc, "static const unsigned char %s_remap[] = {\n", name);
+        write_bytes(fc, out.remap);
+        fprintf(fc, "};\n/* font remap size: %u bytes */\n\n", (unsigned)out.remap.size());
+
+        const ILI9341_t3_font_t &f = out.font;
+        fprintf(fc, "const ILI9341_t3_font_t %s = {\n", name);
+        fprintf(fc, "\t%s_index,\n\t%s_remap,\n\t%s_data,\n", name, name, name);
+        fprintf(fc, "\t%d,\n\t%d,\n\t%d,\n\t%d,\n\t%d,\n\t%d,\n", f.version, f.reserved, f.index1_first,
+                f.index1_last, f.index2_first, f.index2_last);
+        fprintf(fc, "\t%d,\n\t%d,\n\t%d,\n\t%d,\n\t%d,\n\t%d,\n", f.bits_index, f.bits_width, f.bits_height,
+                f.bits_xoffset, f.bits_yoffset, f.bits_delta);
+        fprintf(fc, "\t%d,\n\t%d\n};\n\n", f.line_space, f.cap_height);
+    }
+    fclose(fc);
+    return true;
+}
+
+static bool parse_range(const char *arg, bool keep[256]) {
+    char *end;
+    unsigned long first = strtoul(arg, &end, 0);
+    if (*end != '-')
+        return false;
+    unsigned long last = strtoul(end + 1, &end, 0);
+    if (*end || (last < first) || (last > 255))
+        return false;
+    for (unsigned long c = first; c <= last; c++)
+        keep[c] = true;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *out_base = "font_subset_out";
+    const char *suffix = "_subset";
+    bool keep[256] = {};
+    std::vector<const char *> font_names;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            for (const char *p = argv[++i]; *p; p++)
+                keep[(uint8_t)*p] = true;
+        } else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) {
+            if (!parse_range(argv[++i], keep))
+                usage();
+        } else if (!strcmp(argv[i], "-f") && (i + 1 < argc)) {
+            FILE *f = fopen(argv[++i], "rb");
+            if (!f) {
+                perror(argv[i]);
+                return 1;
+            }
+            int ch;
+            while ((ch = fgetc(f)) != EOF) {
+                if (ch >= ' ')
+                    keep[ch] = true;
+            }
+            fclose(f);
+        } else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            suffix = argv[++i];
+        } else if (!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            out_base = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            font_names.push_back(argv[i]);
+        }
+    }
+    if (font_names.empty())
+        usage();
+
+    std::vector<SubsetFontOut> fonts;
+    for (const char *font_name : font_names) {
+        const ILI9341_t3_font_t *font = find_shipped_font(font_name);
+        if (!font) {
+            fprintf(stderr, "unknown font %s\n", font_name);
+            usage();
+        }
+        SubsetFontOut out;
+        out.name = std::string(font_name) + suffix;
+        if (!subset_font(font_name, font, keep, out))
+            return 1;
+        fonts.push_back(out);
+    }
+    if (!write_output(out_base, fonts))
+        return 1;
+
+    for (auto &out : fonts) {
+        fprintf(stderr, "%s: %u bytes (source font %u bytes)\n", out.name.c_str(),
+                (unsigned)(out.data.size() + out.index.size() + out.remap.size()), (unsigned)out.source_size);
+    }
+    return 0;
+}
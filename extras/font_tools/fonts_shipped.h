@@ -0,0 +1,42 @@
+// Table of the ILI9341_t3 fonts shipped in src/, so the tools can look them up
+// by name.
+#ifndef _FONTS_SHIPPED_H_
+#define _FONTS_SHIPPED_H_
+
+#include "font_reader.h"
+
+#include "../../src/ili9488_t3_font_Arial.c"
+#include "../../src/ili9488_t3_font_ArialBold.c"
+#include "../../src/ili9488_t3_font_ComicSansMS.c"
+
+#define FONT_SIZES(name)                                                                         \
+    {#name "_8", &name##_8}, {#name "_9", &name##_9}, {#name "_10", &name##_10},                 \
+    {#name "_11", &name##_11}, {#name "_12", &name##_12}, {#name "_13", &name##_13},             \
+    {#name "_14", &name##_14}, {#name "_16", &name##_16}, {#name "_18", &name##_18},             \
+    {#name "_20", &name##_20}, {#name "_24", &name##_24}, {#name "_28", &name##_28},             \
+    {#name "_32", &name##_32}, {#name "_40", &name##_40}, {#name "_48", &name##_48},             \
+    {#name "_60", &name##_60}, {#name "_72", &name##_72}, {#name "_96", &name##_96}
+
+static const struct {
+    const char *name;
+    const ILI9341_t3_font_t *font;
+} shipped_fonts[] = {
+    FONT_SIZES(Arial),
+    FONT_SIZES(ComicSansMS),
+    {"Arial_8_Bold", &Arial_8_Bold}, {"Arial_9_Bold", &Arial_9_Bold}, {"Arial_10_Bold", &Arial_10_Bold},
+    {"Arial_11_Bold", &Arial_11_Bold}, {"Arial_12_Bold", &Arial_12_Bold}, {"Arial_13_Bold", &Arial_13_Bold},
+    {"Arial_14_Bold", &Arial_14_Bold}, {"Arial_16_Bold", &Arial_16_Bold}, {"Arial_18_Bold", &Arial_18_Bold},
+    {"Arial_20_Bold", &Arial_20_Bold}, {"Arial_24_Bold", &Arial_24_Bold}, {"Arial_28_Bold", &Arial_28_Bold},
+    {"Arial_32_Bold", &Arial_32_Bold}, {"Arial_40_Bold", &Arial_40_Bold}, {"Arial_48_Bold", &Arial_48_Bold},
+    {"Arial_60_Bold", &Arial_60_Bold}, {"Arial_72_Bold", &Arial_72_Bold}, {"Arial_96_Bold", &Arial_96_Bold},
+};
+
+static const ILI9341_t3_font_t *find_shipped_font(const char *name) {
+    for (auto &entry : shipped_fonts) {
+        if (strcmp(entry.name, name) == 0)
+            return entry.font;
+    }
+    return nullptr;
+}
+
+#endif // _FONTS_SHIPPED_H_
@@ -0,0 +1,323 @@
+// Converts ILI9341_t3 or Adafruit GFX fonts into the run length encoded
+// format described in src/RLE_fonts.h.  See README.md for usage.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "fonts_shipped.h"
+
+#ifdef GFX_FONT_HEADER
+#include GFX_FONT_HEADER
+#endif
+#ifdef GFX_FONT
+#define STRINGIFY2(x) #x
+#define STRINGIFY(x) STRINGIFY2(x)
+#define GFX_FONT_NAME STRINGIFY(GFX_FONT)
+#endif
+
+static int out_bpp = 1;
+static int downscale = 1;
+
+static void usage() {
+    fprintf(stderr, "usage: rle_font_convert [-b bpp] [-d downscale] [-o out_base] font_name ...\n");
+    fprintf(stderr, "  -b bpp        1 (default), 2 or 4 bits of alpha per run\n");
+    fprintf(stderr, "  -d downscale  box filter the glyphs down by this factor (use with -b 2 or 4)\n");
+    fprintf(stderr, "  -o out_base   write out_base.c and out_base.h (default rle_fonts_out)\n");
+    fprintf(stderr, "  font_name     one of the fonts in src/ like Arial_96 or Arial_32_Bold\n");
+#ifdef GFX_FONT
+    fprintf(stderr, "                or " GFX_FONT_NAME " for the compiled in GFX font\n");
+#endif
+    exit(1);
+}
+
+// Round a division towards negative infinity
+static int floor_div(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Shrink the glyphs by downscale with a box filter, the result uses
+// downscale * downscale * alpha_max levels.
+static void downscale_font(FontInfo &info) {
+    if (downscale <= 1)
+        return;
+    int src_max = info.alpha_max;
+    for (auto &g : info.glyphs) {
+        if (!g.present)
+            continue;
+        // Keep the grid lined up with the cursor so glyph edges stay consistent
+        int x1 = floor_div(g.xoffset, downscale);
+        int y1 = floor_div(g.yoffset, downscale);
+        int x2 = floor_div(g.xoffset + g.width + downscale - 1, downscale);
+        int y2 = floor_div(g.yoffset + g.height + downscale - 1, downscale);
+        std::vector<uint8_t> alpha((x2 - x1) * (y2 - y1), 0);
+        std::vector<int> sum(alpha.size(), 0);
+        for (int y = 0; y < g.height; y++) {
+            for (int x = 0; x < g.width; x++) {
+                int dx = floor_div(g.xoffset + x, downscale) - x1;
+                int dy = floor_div(g.yoffset + y, downscale) - y1;
+                sum[dy * (x2 - x1) + dx] += g.alpha[y * g.width + x];
+            }
+        }
+        int levels = downscale * downscale * src_max;
+        for (size_t i = 0; i < alpha.size(); i++)
+            alpha[i] = (sum[i] * 255 + levels / 2) / levels;
+        g.alpha = alpha;
+        g.xoffset = x1;
+        g.yoffset = y1;
+        g.width = x2 - x1;
+        g.height = y2 - y1;
+        g.delta = (g.delta + downscale / 2) / downscale;
+    }
+    info.alpha_max = 255;
+    info.line_space = (info.line_space + downscale / 2) / downscale;
+    info.cap_height = (info.cap_height + downscale / 2) / downscale;
+}
+
+// Quantize to the output bpp and trim empty rows and columns.
+static void quantize_glyph(FontGlyph &g, int src_max) {
+    int out_max = (1 << out_bpp) - 1;
+    for (auto &a : g.alpha)
+        a = (a * out_max + src_max / 2) / src_max;
+
+    int x1 = g.width, x2 = 0, y1 = g.height, y2 = 0;
+    for (int y = 0; y < g.height; y++) {
+        for (int x = 0; x < g.width; x++) {
+            if (g.alpha[y * g.width + x]) {
+                if (x < x1) x1 = x;
+                if (x >= x2) x2 = x + 1;
+                if (y < y1) y1 = y;
+                if (y >= y2) y2 = y + 1;
+            }
+        }
+    }
+    if (x2 <= x1) {
+        g.alpha.clear();
+        g.width = g.height = 0;
+        return;
+    }
+    std::vector<uint8_t> alpha((x2 - x1) * (y2 - y1));
+    for (int y = y1; y < y2; y++)
+        for (int x = x1; x < x2; x++)
+            alpha[(y - y1) * (x2 - x1) + (x - x1)] = g.alpha[y * g.width + x];
+    g.alpha = alpha;
+    g.xoffset += x1;
+    g.yoffset += y1;
+    g.width = x2 - x1;
+    g.height = y2 - y1;
+}
+
+static bool check_range(const char *font_name, unsigned c, const char *what, int value, int min, int max) {
+    if ((value < min) || (value > max)) {
+        fprintf(stderr, "%s: char %u %s %d does not fit in %d to %d\n", font_name, c, what, value, min, max);
+        return false;
+    }
+    return true;
+}
+
+struct RLEFontOut {
+    std::string name;
+    std::vector<uint8_t> data;
+    std::vector<RLE_glyph_t> glyphs;
+    FontInfo info;
+    uint32_t source_size;
+};
+
+static bool encode_font(const char *font_name, FontInfo &info, RLEFontOut &out) {
+    downscale_font(info);
+    out.data.clear();
+    out.glyphs.clear();
+    for (unsigned c = info.first; c <= info.last; c++) {
+        FontGlyph &g = info.glyphs[c - info.first];
+        RLE_glyph_t rg = {};
+        if (g.present) {
+            quantize_glyph(g, info.alpha_max);
+            if (!check_range(font_name, c, "width", g.width, 0, 254) ||
+                !check_range(font_name, c, "height", g.height, 0, 255) ||
+                !check_range(font_name, c, "xoffset", g.xoffset, -128, 127) ||
+                !check_range(font_name, c, "yoffset", g.yoffset, -128, 127) ||
+                !check_range(font_name, c, "delta", g.delta, 0, 255))
+                return false;
+            rg.data_offset = out.data.size();
+            rg.width = g.width;
+            rg.height = g.height;
+            rg.xoffset = g.xoffset;
+            rg.yoffset = g.yoffset;
+            rg.delta = g.delta;
+
+            std::vector<uint8_t> prev_row;
+            for (int y = 0; y < g.height; y++) {
+                std::vector<uint8_t> row;
+                int count = 0;
+                int x = 0;
+                while (x < g.width) {
+                    int skip = 0;
+                    while ((x < g.width) && !g.alpha[y * g.width + x]) {
+                        skip++;
+                        x++;
+                    }
+                    if (x == g.width)
+                        break;
+                    uint8_t a = g.alpha[y * g.width + x];
+                    int len = 0;
+                    while ((x < g.width) && (g.alpha[y * g.width + x] == a)) {
+                        len++;
+                        x++;
+                    }
+                    if (out_bpp == 1) {
+                        row.push_back(skip);
+                        row.push_back(len);
+                        count++;
+                        continue;
+                    }
+                    // Alpha goes in the top bits of the length byte, longer
+                    // runs are split into ones that fit
+                    int len_max = (1 << (8 - out_bpp)) - 1;
+                    while (len) {
+                        int part = (len < len_max) ? len : len_max;
+                        row.push_back(skip);
+                        row.push_back((a << (8 - out_bpp)) | part);
+                        count++;
+                        skip = 0;
+                        len -= part;
+                    }
+                }
+                if (!check_range(font_name, c, "runs in a row", count, 0, RLE_FONT_ROW_REPEAT - 1))
+                    return false;
+                row.insert(row.begin(), (uint8_t)count);
+                if (y && (row == prev_row)) {
+                    out.data.push_back(RLE_FONT_ROW_REPEAT);
+                } else {
+                    out.data.insert(out.data.end(), row.begin(), row.end());
+                    prev_row = row;
+                }
+            }
+        }
+        out.glyphs.push_back(rg);
+    }
+    out.info = info;
+    return true;
+}
+
+static void write_bytes(FILE *f, const std::vector<uint8_t> &data) {
+    for (size_t i = 0; i < data.size(); i++) {
+        fprintf(f, "0x%02X,", data[i]);
+        if ((i % 10) == 9 || (i + 1) == data.size())
+            fprintf(f, "\n");
+    }
+}
+
+static bool write_output(const char *out_base, const std::vector<RLEFontOut> &fonts) {
+    std::string base(out_base);
+    std::string file_name = base.substr(base.find_last_of('/') + 1);
+    std::string guard = "_" + file_name + "_";
+
+    FILE *fh = fopen((base + ".h").c_str(), "w");
+    if (!fh) {
+        perror((base + ".h").c_str());
+        return false;
+    }
+    fprintf(fh, "#ifndef %s\n#define %s\n\n#include \"RLE_fonts.h\"\n\n", guard.c_str(), guard.c_str());
+    fprintf(fh, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    for (auto &font : fonts)
+        fprintf(fh, "extern const RLE_font_t %s;\n", font.name.c_str());
+    fprintf(fh, "\n#ifdef __cplusplus\n} // extern \"C\"\n#endif\n\n#endif\n");
+    fclose(fh);
+
+    FILE *fc = fopen((base + ".c").c_str(), "w");
+    if (!fc) {
+        perror((base + ".c").c_str());
+        return false;
+    }
+    fprintf(fc, "#include \"%s.h\"\n\n", file_name.c_str());
+    for (auto &font : fonts) {
+        fprintf(fc, "static const unsigned char %s_data[] = {\n", font.name.c_str());
+        write_bytes(fc, font.data);
+        fprintf(fc, "};\n/* font data size: %u bytes */\n\n", (unsigned)font.data.size());
+
+        fprintf(fc, "static const RLE_glyph_t %s_glyphs[] = {\n", font.name.c_str());
+        for (size_t i = 0; i < font.glyphs.size(); i++) {
+            const RLE_glyph_t &g = font.glyphs[i];
+            unsigned c = font.info.first + i;
+            fprintf(fc, "\t{ %u, %u, %u, %d, %d, %u }, // ", (unsigned)g.data_offset, g.width, g.height,
+                    g.xoffset, g.yoffset, g.delta);
+            if ((c >= 32) && (c < 127) && (c != '\\'))
+                fprintf(fc, "'%c'\n", c);
+            else
+                fprintf(fc, "0x%02X\n", c);
+        }
+        fprintf(fc, "};\n\n");
+
+        fprintf(fc, "const RLE_font_t %s = {\n", font.name.c_str());
+        fprintf(fc, "\t%s_glyphs,\n\t%s_data,\n", font.name.c_str(), font.name.c_str());
+        fprintf(fc, "\t%u,\n\t%u,\n\t%d,\n\t%d,\n\t%d\n};\n\n", font.info.first, font.info.last, out_bpp,
+                font.info.line_space, font.info.cap_height);
+    }
+    fclose(fc);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *out_base = "rle_fonts_out";
+    std::vector<RLEFontOut> fonts;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && (i + 1 < argc)) {
+            out_bpp = atoi(argv[++i]);
+            if ((out_bpp != 1) && (out_bpp != 2) && (out_bpp != 4))
+                usage();
+        } else if (!strcmp(argv[i], "-d") && (i + 1 < argc)) {
+            downscale = atoi(argv[++i]);
+            if (downscale < 1)
+                usage();
+        } else if (!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            out_base = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            RLEFontOut out;
+            FontInfo info;
+            const char *font_name = argv[i];
+#ifdef GFX_FONT
+            if (!strcmp(font_name, GFX_FONT_NAME)) {
+                read_gfx_font(&GFX_FONT, info);
+                out.source_size = 0;
+                for (unsigned c = info.first; c <= info.last; c++) {
+                    const GFXglyph *glyph = &GFX_FONT.glyph[c - info.first];
+                    uint32_t end = glyph->bitmapOffset + (glyph->width * glyph->height + 7) / 8;
+                    if (end > out.source_size)
+                        out.source_size = end;
+                }
+                out.source_size += (info.last - info.first + 1) * sizeof(GFXglyph);
+            } else
+#endif
+            {
+                const ILI9341_t3_font_t *font = find_shipped_font(font_name);
+                if (!font) {
+                    fprintf(stderr, "unknown font %s\n", font_name);
+                    usage();
+                }
+                read_ili_font(font, info);
+                out.source_size = ili_font_size(font);
+            }
+            out.name = std::string(font_name) + "_rle";
+            if (!encode_font(font_name, info, out))
+                return 1;
+            fonts.push_back(out);
+        }
+    }
+    if (fonts.empty())
+        usage();
+    if (!write_output(out_base, fonts))
+        return 1;
+
+    for (auto &font : fonts) {
+        uint32_t size = font.data.size() + font.glyphs.size() * sizeof(RLE_glyph_t);
+        fprintf(stderr, "%s: %u bytes (source font %u bytes)\n", font.name.c_str(), (unsigned)size,
+                (unsigned)font.source_size);
+        if (size > font.source_size)
+            fprintf(stderr, "  warning: %s is bigger than the font it came from\n", font.name.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,321 @@
+// Converts BMP images into the run length encoded format described in
+// src/RLE_images.h.  See README.md for usage.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../../src/RLE_images.h"
+
+static bool use_palette = false;
+static bool has_key = false;
+static uint32_t key_color = 0;
+static int min_fill = 3;
+
+static void usage() {
+    fprintf(stderr, "usage: rle_image_convert [-p] [-k rrggbb] [-f min_fill] [-o out_base] image.bmp ...\n");
+    fprintf(stderr, "  -p            palette image, one byte a pixel (256 colors at most)\n");
+    fprintf(stderr, "  -k rrggbb     pixels of this color are transparent\n");
+    fprintf(stderr, "  -f min_fill   shortest run of one color stored as a fill (default 3)\n");
+    fprintf(stderr, "  -o out_base   write out_base.c and out_base.h (default rle_images_out)\n");
+    fprintf(stderr, "  image.bmp     24 or 32 bit BMP, 32 bit ones are transparent below alpha 128\n");
+    exit(1);
+}
+
+typedef struct {
+    std::string name;
+    int width, height;
+    std::vector<int32_t> pixels; // 565 color, -1 for transparent
+    std::vector<uint16_t> palette;
+    std::vector<uint8_t> data;
+} Image;
+
+static uint32_t get16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t get32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static bool read_bmp(const char *file_name, Image &image) {
+    FILE *f = fopen(file_name, "rb");
+    if (!f) {
+        fprintf(stderr, "can't open %s\n", file_name);
+        return false;
+    }
+    std::vector<uint8_t> file;
+    uint8_t buf[4096];
+    size_t cb;
+    while ((cb = fread(buf, 1, sizeof(buf), f)) > 0)
+        file.insert(file.end(), buf, buf + cb);
+    fclose(f);
+
+    if ((file.size() < 54) || (file[0] != 'B') || (file[1] != 'M')) {
+        fprintf(stderr, "%s is not a BMP\n", file_name);
+        return false;
+    }
+    uint32_t offset = get32(&file[10]);
+    int width = (int32_t)get32(&file[18]);
+    int height = (int32_t)get32(&file[22]);
+    int bpp = get16(&file[28]);
+    uint32_t compression = get32(&file[30]);
+    bool top_down = height < 0;
+    if (top_down)
+        height = -height;
+    if (((bpp != 24) && (bpp != 32)) || ((compression != 0) && (compression != 3)) || (width < 1) ||
+        (width > 0xffff) || (height < 1) || (height > 0xffff)) {
+        fprintf(stderr, "%s: only uncompressed 24 and 32 bit BMPs\n", file_name);
+        return false;
+    }
+    size_t stride = ((width * bpp + 31) / 32) * 4;
+    if ((offset + stride * height) > file.size()) {
+        fprintf(stderr, "%s is too short\n", file_name);
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(width * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t *p = &file[offset + stride * (top_down ? y : (height - 1 - y))];
+        for (int x = 0; x < width; x++, p += bpp / 8) {
+            uint32_t rgb = (p[2] << 16) | (p[1] << 8) | p[0];
+            bool transparent = ((bpp == 32) && (p[3] < 128)) || (has_key && (rgb == key_color));
+            image.pixels[y * width + x] = transparent ? -1 : (((p[2] & 0xf8) << 8) | ((p[1] & 0xfc) << 3) | (p[0] >> 3));
+        }
+    }
+
+    // Name for the C variable, the file name without its path or extension
+    std::string name = file_name;
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+    size_t dot = name.find('.');
+    if (dot != std::string::npos)
+        name = name.substr(0, dot);
+    for (auto &c : name)
+        if (!isalnum((unsigned char)c))
+            c = '_';
+    if (isdigit((unsigned char)name[0]))
+        name = "_" + name;
+    image.name = name + "_rle";
+    return true;
+}
+
+static bool build_palette(Image &image) {
+    for (int32_t c : image.pixels) {
+        if ((c < 0) || (std::find(image.palette.begin(), image.palette.end(), c) != image.palette.end()))
+            continue;
+        if (image.palette.size() == 256) {
+            fprintf(stderr, "%s has more than 256 colors, leave out -p\n", image.name.c_str());
+            return false;
+        }
+        image.palette.push_back(c);
+    }
+    return true;
+}
+
+static void put_run(std::vector<uint8_t> &out, uint8_t type, int len) {
+    if (len < 64) {
+        out.push_back(type | len);
+    } else {
+        out.push_back(type);
+        out.push_back(len & 0xff);
+        out.push_back(len >> 8);
+    }
+}
+
+static void put_color(std::vector<uint8_t> &out, const Image &image, int32_t c) {
+    if (use_palette) {
+        out.push_back(std::find(image.palette.begin(), image.palette.end(), c) - image.palette.begin());
+    } else {
+        out.push_back(c & 0xff);
+        out.push_back(c >> 8);
+    }
+}
+
+static std::vector<uint8_t> encode_row(const Image &image, const int32_t *row) {
+    std::vector<uint8_t> out;
+    int w = image.width;
+    // the end of the row is transparent anyway
+    while ((w > 0) && (row[w - 1] < 0))
+        w--;
+    int x = 0;
+    while (x < w) {
+        int len = 1;
+        if (row[x] < 0) {
+            while (((x + len) < w) && (row[x + len] < 0))
+                len++;
+            put_run(out, RLE_IMAGE_SKIP, len);
+            x += len;
+            continue;
+        }
+        while (((x + len) < w) && (row[x + len] == row[x]))
+            len++;
+        if (len >= min_fill) {
+            put_run(out, RLE_IMAGE_FILL, len);
+            put_color(out, image, row[x]);
+            x += len;
+            continue;
+        }
+        // copy until transparency or a run long enough to fill
+        len = 0;
+        while (((x + len) < w) && (row[x + len] >= 0)) {
+            int same = 1;
+            while (((x + len + same) < w) && (same < min_fill) && (row[x + len + same] == row[x + len]))
+                same++;
+            if (same >= min_fill)
+                break;
+            len++;
+        }
+        put_run(out, RLE_IMAGE_COPY, len);
+        for (int i = 0; i < len; i++)
+            put_color(out, image, row[x + i]);
+        x += len;
+    }
+    out.push_back(RLE_IMAGE_END_ROW);
+    return out;
+}
+
+static void encode(Image &image) {
+    std::vector<uint8_t> previous;
+    for (int y = 0; y < image.height; y++) {
+        std::vector<uint8_t> row = encode_row(image, &image.pixels[y * image.width]);
+        if ((y > 0) && (row == previous)) {
+            image.data.push_back(RLE_IMAGE_ROW_REPEAT);
+            continue;
+        }
+        image.data.insert(image.data.end(), row.begin(), row.end());
+        previous = row;
+    }
+}
+
+// Decode it again the way drawRLEImage walks it and compare
+static bool check(const Image &image) {
+    const uint8_t *p = image.data.data();
+    const uint8_t *row_start = p;
+    for (int y = 0; y < image.height; y++) {
+        if (*p == RLE_IMAGE_ROW_REPEAT) {
+            p++;
+        } else {
+            row_start = p;
+            while (*p != RLE_IMAGE_END_ROW) {
+                int len = *p & 0x3f;
+                uint8_t type = *p++ & 0xc0;
+                if (!len) {
+                    len = p[0] | (p[1] << 8);
+                    p += 2;
+                }
+                p += (type == RLE_IMAGE_FILL) ? (use_palette ? 1 : 2) : 0;
+                p += (type == RLE_IMAGE_COPY) ? len * (use_palette ? 1 : 2) : 0;
+            }
+            p++;
+        }
+        const uint8_t *q = row_start;
+        int x = 0;
+        while (*q != RLE_IMAGE_END_ROW) {
+            int len = *q & 0x3f;
+            uint8_t type = *q++ & 0xc0;
+            if (!len) {
+                len = q[0] | (q[1] << 8);
+                q += 2;
+            }
+            for (int i = 0; i < len; i++, x++) {
+                int32_t c = -1;
+                const uint8_t *cp = q + ((type == RLE_IMAGE_COPY) ? i * (use_palette ? 1 : 2) : 0);
+                if (type != RLE_IMAGE_SKIP)
+                    c = use_palette ? image.palette[*cp] : (cp[0] | (cp[1] << 8));
+                if (image.pixels[y * image.width + x] != c)
+                    return false;
+            }
+            q += (type == RLE_IMAGE_FILL) ? (use_palette ? 1 : 2) : 0;
+            q += (type == RLE_IMAGE_COPY) ? len * (use_palette ? 1 : 2) : 0;
+        }
+        for (; x < image.width; x++)
+            if (image.pixels[y * image.width + x] >= 0)
+                return false;
+    }
+    return p == (image.data.data() + image.data.size());
+}
+
+static void write_files(const std::vector<Image> &images, const std::string &out_base) {
+    std::string header_name = out_base;
+    size_t slash = header_name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        header_name = header_name.substr(slash + 1);
+
+    FILE *h = fopen((out_base + ".h").c_str(), "w");
+    FILE *c = fopen((out_base + ".c").c_str(), "w");
+    if (!h || !c) {
+        fprintf(stderr, "can't write %s.c / .h\n", out_base.c_str());
+        exit(1);
+    }
+    std::string guard = "_" + header_name + "_H_";
+    for (auto &ch : guard)
+        ch = isalnum((unsigned char)ch) ? toupper(ch) : '_';
+    fprintf(h, "// Generated by rle_image_convert\n#ifndef %s\n#define %s\n\n#include \"RLE_images.h\"\n\n",
+            guard.c_str(), guard.c_str());
+    fprintf(h, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(c, "// Generated by rle_image_convert\n#include \"%s.h\"\n\n", header_name.c_str());
+    for (auto &image : images) {
+        fprintf(h, "extern const RLE_image_t %s; // %d x %d\n", image.name.c_str(), image.width, image.height);
+        fprintf(c, "static const uint8_t %s_data[] = {", image.name.c_str());
+        for (size_t i = 0; i < image.data.size(); i++)
+            fprintf(c, "%s0x%02X,", (i % 16) ? " " : "\n    ", image.data[i]);
+        fprintf(c, "\n};\n\n");
+        if (use_palette) {
+            fprintf(c, "static const uint16_t %s_palette[] = {", image.name.c_str());
+            for (size_t i = 0; i < image.palette.size(); i++)
+                fprintf(c, "%s0x%04X,", (i % 8) ? " " : "\n    ", image.palette[i]);
+            fprintf(c, "\n};\n\n");
+        }
+        fprintf(c, "const RLE_image_t %s = {%s_data, %s%s, %d, %d};\n\n", image.name.c_str(), image.name.c_str(),
+                use_palette ? image.name.c_str() : "0", use_palette ? "_palette" : "", image.width, image.height);
+    }
+    fprintf(h, "\n#ifdef __cplusplus\n}\n#endif\n\n#endif\n");
+    fclose(h);
+    fclose(c);
+}
+
+int main(int argc, char **argv) {
+    std::string out_base = "rle_images_out";
+    std::vector<Image> images;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-p")) {
+            use_palette = true;
+        } else if (!strcmp(argv[i], "-k") && ((i + 1) < argc)) {
+            has_key = true;
+            key_color = strtoul(argv[++i], nullptr, 16);
+        } else if (!strcmp(argv[i], "-f") && ((i + 1) < argc)) {
+            min_fill = atoi(argv[++i]);
+            if (min_fill < 1)
+                usage();
+        } else if (!strcmp(argv[i], "-o") && ((i + 1) < argc)) {
+            out_base = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            Image image;
+            if (!read_bmp(argv[i], image))
+                return 1;
+            images.push_back(image);
+        }
+    }
+    if (images.empty())
+        usage();
+
+    for (auto &image : images) {
+        if (use_palette && !build_palette(image))
+            return 1;
+        encode(image);
+        if (!check(image)) {
+            fprintf(stderr, "%s: encoding check failed\n", image.name.c_str());
+            return 1;
+        }
+        size_t raw = image.width * image.height * (use_palette ? 1 : 2) + image.palette.size() * 2;
+        printf("%s: %d x %d, %zu bytes (%zu uncompressed)\n", image.name.c_str(), image.width, image.height,
+               image.data.size() + image.palette.size() * 2, raw);
+    }
+    write_files(images, out_base);
+    return 0;
+}
@@ -0,0 +1,352 @@
+// Checks the row color conversion kernels in src/Teensy_Parallel_Convert.cpp
+// against plain one pixel at a time versions, for every row length up to 64
+// at every alignment of both rows, and that nothing past the end of a row is
+// written.  Prints what failed and returns non zero if anything did.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/Teensy_Parallel_Convert.h"
+
+typedef Teensy_Parallel_Convert TPC;
+
+#define MAX_COUNT 64
+#define GUARD 0xA5
+
+static int failures = 0;
+
+static void report(const char *what, bool ok) {
+    printf("%-28s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok)
+        failures++;
+}
+
+//-----------------------------------------------------------------------------
+// Scalar references, one pixel at a time
+//-----------------------------------------------------------------------------
+static void ref565To888(uint16_t c, uint8_t *p) {
+    p[0] = (c >> 8) & 0xf8;
+    p[1] = (c >> 3) & 0xfc;
+    p[2] = (c << 3) & 0xf8;
+}
+static uint16_t ref888To565(const uint8_t *p) {
+    return ((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3);
+}
+static uint32_t ref565ToXRGB(uint16_t c) {
+    uint8_t p[3];
+    ref565To888(c, p);
+    return (p[0] << 16) | (p[1] << 8) | p[2];
+}
+static uint16_t refXRGBTo565(uint32_t c) {
+    uint8_t p[3] = {(uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c};
+    return ref888To565(p);
+}
+static void refXRGBTo888(uint32_t c, uint8_t *p, uint8_t mask) {
+    p[0] = (c >> 16) & mask;
+    p[1] = (c >> 8) & mask;
+    p[2] = c & mask;
+}
+static uint32_t ref888ToXRGB(const uint8_t *p) {
+    return (p[0] << 16) | (p[1] << 8) | p[2];
+}
+
+//-----------------------------------------------------------------------------
+// Test rows, each one is filled with random bytes, and the output ones with
+// GUARD so writes past the end show up
+//-----------------------------------------------------------------------------
+static uint8_t src_buf[MAX_COUNT * 4 + 16] __attribute__((aligned(4)));
+static uint8_t dst_buf[MAX_COUNT * 4 + 16] __attribute__((aligned(4)));
+static uint8_t want_buf[MAX_COUNT * 4 + 16];
+
+static void randomize(uint8_t *p, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        p[i] = rand();
+}
+
+static bool guardsOk(const uint8_t *p, int from, int to) {
+    for (int i = from; i < to; i++)
+        if (p[i] != GUARD)
+            return false;
+    return true;
+}
+
+// Run one kernel over every count and alignment.  The 16 and 32 bit rows are
+// only offset by whole pixels, the packed ones by every byte.
+typedef void (*run_t)(const uint8_t *src, uint8_t *dst, int16_t count);
+typedef void (*ref_t)(const uint8_t *src, uint8_t *want, int16_t i);
+
+static bool checkKernel(run_t run, ref_t ref, int src_bpp, int dst_bpp) {
+    int src_step = (src_bpp == 3) ? 1 : src_bpp;
+    int dst_step = (dst_bpp == 3) ? 1 : dst_bpp;
+    for (int count = 0; count <= MAX_COUNT; count++) {
+        for (int so = 0; so < 4 * src_step; so += src_step) {
+            for (int dof = 0; dof < 4 * dst_step; dof += dst_step) {
+                randomize(src_buf, sizeof(src_buf));
+                memset(dst_buf, GUARD, sizeof(dst_buf));
+                memset(want_buf, GUARD, sizeof(want_buf));
+                run(src_buf + so, dst_buf + dof, count);
+                for (int i = 0; i < count; i++)
+                    ref(src_buf + so, want_buf + dof, i);
+                if (memcmp(dst_buf, want_buf, sizeof(dst_buf)) ||
+                    !guardsOk(dst_buf, dof + count * dst_bpp, sizeof(dst_buf))) {
+                    printf("  count %d src offset %d dst offset %d\n", count, so, dof);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// unaligned friendly access for the references
+static uint16_t get16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v;
+}
+static uint32_t get32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+static void put16(uint8_t *p, uint16_t v) { memcpy(p, &v, 2); }
+static void put32(uint8_t *p, uint32_t v) { memcpy(p, &v, 4); }
+
+static void run565To888(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRow565To888((const uint16_t *)s, d, n); }
+static void ref565To888Row(const uint8_t *s, uint8_t *w, int16_t i) { ref565To888(get16(s + 2 * i), w + 3 * i); }
+
+static void run888To565(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRow888To565(s, (uint16_t *)d, n); }
+static void ref888To565Row(const uint8_t *s, uint8_t *w, int16_t i) { put16(w + 2 * i, ref888To565(s + 3 * i)); }
+
+static void run565ToXRGB(const uint8_t *s, uint8_t *d, int16_t n) {
+    TPC::convertRow565ToXRGB((const uint16_t *)s, (uint32_t *)d, n);
+}
+static void ref565ToXRGBRow(const uint8_t *s, uint8_t *w, int16_t i) { put32(w + 4 * i, ref565ToXRGB(get16(s + 2 * i))); }
+
+static void runXRGBTo565(const uint8_t *s, uint8_t *d, int16_t n) {
+    TPC::convertRowXRGBTo565((const uint32_t *)s, (uint16_t *)d, n);
+}
+static void refXRGBTo565Row(const uint8_t *s, uint8_t *w, int16_t i) { put16(w + 2 * i, refXRGBTo565(get32(s + 4 * i))); }
+
+static void runXRGBTo888(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRowXRGBTo888((const uint32_t *)s, d, n); }
+static void refXRGBTo888Row(const uint8_t *s, uint8_t *w, int16_t i) { refXRGBTo888(get32(s + 4 * i), w + 3 * i, 0xff); }
+
+static void runXRGBTo666(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRowXRGBTo666((const uint32_t *)s, d, n); }
+static void refXRGBTo666Row(const uint8_t *s, uint8_t *w, int16_t i) { refXRGBTo888(get32(s + 4 * i), w + 3 * i, 0xfc); }
+
+static void run888ToXRGB(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRow888ToXRGB(s, (uint32_t *)d, n); }
+static void ref888ToXRGBRow(const uint8_t *s, uint8_t *w, int16_t i) { put32(w + 4 * i, ref888ToXRGB(s + 3 * i)); }
+
+static void run888To666(const uint8_t *s, uint8_t *d, int16_t n) { TPC::convertRow888To666(s, d, n); }
+static void ref888To666Row(const uint8_t *s, uint8_t *w, int16_t i) {
+    for (int c = 0; c < 3; c++)
+        w[3 * i + c] = s[3 * i + c] & 0xfc;
+}
+
+static void runFill888(const uint8_t *s, uint8_t *d, int16_t n) { TPC::fillRow888(d, n, s); }
+static void refFill888Row(const uint8_t *s, uint8_t *w, int16_t i) { memcpy(w + 3 * i, s, 3); }
+
+//-----------------------------------------------------------------------------
+// convertRow, every pair of formats against the kernels above
+//-----------------------------------------------------------------------------
+static void refConvert(uint8_t *d, uint8_t dst_fmt, const uint8_t *s, uint8_t src_fmt, int n) {
+    for (int i = 0; i < n; i++) {
+        // everything goes through 888 bytes
+        uint8_t p[3];
+        switch (src_fmt) {
+        case TPC::FMT_565:
+            ref565To888(get16(s + 2 * i), p);
+            break;
+        case TPC::FMT_666:
+        case TPC::FMT_888:
+            memcpy(p, s + 3 * i, 3);
+            break;
+        default:
+            refXRGBTo888(get32(s + 4 * i), p, 0xff);
+            break;
+        }
+        switch (dst_fmt) {
+        case TPC::FMT_565:
+            put16(d + 2 * i, ref888To565(p));
+            break;
+        case TPC::FMT_666:
+            for (int c = 0; c < 3; c++)
+                d[3 * i + c] = (src_fmt == TPC::FMT_666) ? p[c] : (p[c] & 0xfc);
+            break;
+        case TPC::FMT_888:
+            memcpy(d + 3 * i, p, 3);
+            break;
+        default:
+            put32(d + 4 * i, (src_fmt == TPC::FMT_XRGB) ? get32(s + 4 * i) : ref888ToXRGB(p));
+            break;
+        }
+    }
+}
+
+static bool checkConvertRow() {
+    for (uint8_t sf = 0; sf < TPC::FMT_COUNT; sf++) {
+        for (uint8_t df = 0; df < TPC::FMT_COUNT; df++) {
+            for (int count = 0; count <= MAX_COUNT; count++) {
+                randomize(src_buf, sizeof(src_buf));
+                memset(dst_buf, GUARD, sizeof(dst_buf));
+                memset(want_buf, GUARD, sizeof(want_buf));
+                if (!TPC::convertRow(dst_buf, df, src_buf, sf, count))
+                    return false;
+                refConvert(want_buf, df, src_buf, sf, count);
+                if (memcmp(dst_buf, want_buf, sizeof(dst_buf))) {
+                    printf("  %d to %d count %d\n", sf, df, count);
+                    return false;
+                }
+            }
+        }
+    }
+    return !TPC::convertRow(dst_buf, TPC::FMT_COUNT, src_buf, TPC::FMT_565, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Dithering and YCbCr
+//-----------------------------------------------------------------------------
+
+// The usual 4x4 Bayer matrix, the kernel scales it to what each channel drops
+static const uint8_t bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+
+static bool checkBayer() {
+    uint32_t src[MAX_COUNT];
+    uint16_t dst[MAX_COUNT];
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            randomize((uint8_t *)src, sizeof(src));
+            TPC::convertRowXRGBTo565Bayer(src, dst, MAX_COUNT, x, y);
+            for (int i = 0; i < MAX_COUNT; i++) {
+                int t = bayer[y & 3][(x + i) & 3];
+                int r = (src[i] >> 16) & 0xff, g = (src[i] >> 8) & 0xff, b = src[i] & 0xff;
+                r = r + t / 2 > 255 ? 255 : r + t / 2;
+                g = g + t / 4 > 255 ? 255 : g + t / 4;
+                b = b + t / 2 > 255 ? 255 : b + t / 2;
+                if (dst[i] != (((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))) {
+                    printf("  x %d y %d pixel %d\n", x, y, i);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Floyd-Steinberg quantizes to the full scale levels, 31 is 255 not 248
+static uint32_t refFullScaleXRGB(uint16_t c) {
+    uint8_t r = c >> 11, g = (c >> 5) & 0x3f, b = c & 0x1f;
+    return (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+// Floyd-Steinberg has no simple per pixel reference, so check what it is for:
+// a flat area averages out to the color it started as, colors 565 can show
+// exactly come out unchanged, and saturated pixels don't leave error behind
+// that turns up in later rows.
+static bool checkFloydSteinberg() {
+    const int rows = 64;
+    uint32_t src[MAX_COUNT];
+    uint16_t dst[MAX_COUNT];
+    int16_t err[3 * (MAX_COUNT + 2)];
+    for (int trial = 0; trial < 50; trial++) {
+        uint32_t color = (rand() & 0xffffff);
+        bool exact = trial & 1;
+        if (exact)
+            color = refFullScaleXRGB(refXRGBTo565(color));
+        if (trial == 2)
+            color = 0xffffff;
+        for (int i = 0; i < MAX_COUNT; i++)
+            src[i] = color;
+        memset(err, 0, sizeof(err));
+        double sum[3] = {0, 0, 0};
+        for (int y = 0; y < rows; y++) {
+            TPC::convertRowXRGBTo565FS(src, dst, MAX_COUNT, err);
+            for (int i = 0; i < MAX_COUNT; i++) {
+                if (exact && (dst[i] != refXRGBTo565(color)))
+                    return false;
+                uint32_t x = refFullScaleXRGB(dst[i]);
+                sum[0] += (x >> 16) & 0xff;
+                sum[1] += (x >> 8) & 0xff;
+                sum[2] += x & 0xff;
+            }
+        }
+        for (int c = 0; c < 3; c++) {
+            int want = (color >> (16 - 8 * c)) & 0xff;
+            if (fabs(sum[c] / (rows * MAX_COUNT) - want) > 2.0) {
+                printf("  color %06x channel %d average %.2f\n", (unsigned)color, c, sum[c] / (rows * MAX_COUNT));
+                return false;
+            }
+        }
+    }
+
+    // rows of white and then gray, every gray pixel has to be one of the two
+    // levels either side of 0x80
+    memset(err, 0, sizeof(err));
+    for (int y = 0; y < 160; y++) {
+        for (int i = 0; i < MAX_COUNT; i++)
+            src[i] = (y < 150) ? 0xffffff : 0x808080;
+        TPC::convertRowXRGBTo565FS(src, dst, MAX_COUNT, err);
+        for (int i = 0; (y >= 150) && (i < MAX_COUNT); i++) {
+            uint8_t r = dst[i] >> 11, g = (dst[i] >> 5) & 0x3f, b = dst[i] & 0x1f;
+            if ((r < 15) || (r > 16) || (g < 31) || (g > 32) || (b < 15) || (b > 16)) {
+                printf("  gray after white row %d pixel %d is %04x\n", y, i, dst[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int clampRound(double v) {
+    int i = (int)floor(v + 0.5);
+    return (i < 0) ? 0 : ((i > 255) ? 255 : i);
+}
+
+// JFIF full range YCbCr, in floating point.  The kernel is 16.16 fixed point
+// so it can be 1 off.
+static bool checkYCbCr() {
+    uint8_t y[MAX_COUNT], cb[MAX_COUNT], cr[MAX_COUNT];
+    uint32_t dst[MAX_COUNT];
+    for (int trial = 0; trial < 2000; trial++) {
+        uint8_t shift = trial % 3;
+        randomize(y, sizeof(y));
+        randomize(cb, sizeof(cb));
+        randomize(cr, sizeof(cr));
+        TPC::convertRowYCbCrToXRGB(y, cb, cr, dst, MAX_COUNT, shift);
+        for (int i = 0; i < MAX_COUNT; i++) {
+            double u = cb[i >> shift] - 128.0, v = cr[i >> shift] - 128.0;
+            int want[3] = {clampRound(y[i] + 1.402 * v), clampRound(y[i] - 0.344136 * u - 0.714136 * v),
+                           clampRound(y[i] + 1.772 * u)};
+            for (int c = 0; c < 3; c++) {
+                if (abs((int)((dst[i] >> (16 - 8 * c)) & 0xff) - want[c]) > 1) {
+                    printf("  y %d cb %d cr %d channel %d\n", y[i], cb[i >> shift], cr[i >> shift], c);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    srand(1);
+    report("convertRow565To888", checkKernel(run565To888, ref565To888Row, 2, 3));
+    report("convertRow888To565", checkKernel(run888To565, ref888To565Row, 3, 2));
+    report("convertRow565ToXRGB", checkKernel(run565ToXRGB, ref565ToXRGBRow, 2, 4));
+    report("convertRowXRGBTo565", checkKernel(runXRGBTo565, refXRGBTo565Row, 4, 2));
+    report("convertRowXRGBTo888", checkKernel(runXRGBTo888, refXRGBTo888Row, 4, 3));
+    report("convertRowXRGBTo666", checkKernel(runXRGBTo666, refXRGBTo666Row, 4, 3));
+    report("convertRow888ToXRGB", checkKernel(run888ToXRGB, ref888ToXRGBRow, 3, 4));
+    report("convertRow888To666", checkKernel(run888To666, ref888To666Row, 3, 3));
+    report("fillRow888", checkKernel(runFill888, refFill888Row, 3, 3));
+    report("convertRow", checkConvertRow());
+    report("convertRowXRGBTo565Bayer", checkBayer());
+    report("convertRowXRGBTo565FS", checkFloydSteinberg());
+    report("convertRowYCbCrToXRGB", checkYCbCr());
+    if (failures)
+        printf("%d FAILED\n", failures);
+    else
+        printf("all passed\n");
+    return failures ? 1 : 0;
+}
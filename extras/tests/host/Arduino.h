@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#define min(a,b) ({ auto _a=(a); auto _b=(b); _a<_b?_a:_b; })
+#define max(a,b) ({ auto _a=(a); auto _b=(b); _a>_b?_a:_b; })
+inline char* ltoa(long v,char*b,int){sprintf(b,"%ld",v);return b;}
+typedef bool boolean;
+class Print { public: virtual size_t write(uint8_t)=0; virtual size_t write(const uint8_t*b,size_t s){size_t n=0;while(s--)n+=write(*b++);return n;} size_t print(const char*s){return write((const uint8_t*)s,strlen(s));} virtual ~Print(){} };
+class String { public: String(const char*s=""):s_(s){} unsigned length() const {return strlen(s_);} void toCharArray(char*b,unsigned n) const {strncpy(b,s_,n);} const char* c_str() const {return s_;} const char*s_; };
+class Stream : public Print { public: size_t write(uint8_t){return 1;} size_t readBytes(char*,size_t n){return n;} };
+struct SerialC : public Print { size_t write(uint8_t c){return 1;} operator bool(){return true;} int printf(const char*,...){return 0;} void println(...){} void print(...){} };
+extern SerialC Serial;
+inline void delay(int){}
+inline uint32_t millis(){return 0;}
+inline void yield(){}
+#define __disable_irq()
+#define __enable_irq()
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t*)(a))
+#define DMAMEM
+#define FLASHMEM
+#define FASTRUN
+
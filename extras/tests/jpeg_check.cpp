@@ -0,0 +1,326 @@
+// Checks drawJPEG (src/Teensy_Parallel_JPEG.cpp) against libjpeg.  Test
+// images are encoded with libjpeg at different sizes, chroma subsampling,
+// qualities and restart intervals, then drawn into a 32 bit frame buffer and
+// compared with libjpeg's own decode of the same file:
+//   - scale 1 has to match libjpeg's integer IDCT decode exactly
+//   - scales 2, 4 and 8 average the full size blocks down, so they are
+//     compared with a box average of libjpeg's full size decode.  libjpeg's
+//     own scaled IDCT handles 2x1 and 1x2 chroma differently enough that it
+//     isn't a useful reference.  Rounding differs, so they only have to be close
+//   - nothing is drawn outside the image, getJPEGSize agrees, a truncated
+//     file fails, and a clipped draw matches the same part of an unclipped one
+//   - files with broken Huffman tables fail without writing past the tables
+// Prints the results and returns non zero if anything failed.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define boolean jpeg_boolean // libjpeg has its own
+#include <jpeglib.h>
+#undef boolean
+
+#include "Teensy_Parallel_Image.h"
+
+SerialC Serial;
+
+#define SCREEN_W 480
+#define SCREEN_H 320
+
+// Just enough of a display driver to draw into a frame buffer
+class CaptureGFX : public Teensy_Parallel_GFX {
+  public:
+    CaptureGFX() : Teensy_Parallel_GFX(SCREEN_W, SCREEN_H) {
+        _originx = 0;
+        _originy = 0;
+        setClipRect();
+        textcolor = 0xffff;
+        textbgcolor = 0;
+        textsize_x = textsize_y = 1;
+        wrap = true;
+        font = nullptr;
+        cursor_x = cursor_y = 0;
+        scrollEnable = false;
+        isWritingScrollArea = false;
+    }
+    void setAddr(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {}
+    void beginWrite16BitColors() {}
+    void write16BitColor(uint16_t color) {}
+    void endWrite16BitColors() {}
+    void writeRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) {}
+    void setRotation(uint8_t r) {}
+};
+
+static CaptureGFX tft;
+static uint32_t frame_buffer[SCREEN_W * SCREEN_H];
+#define BACKGROUND 0x55555555
+
+// Reads from memory a random amount at a time, so the decoder's buffering
+// gets exercised
+struct mem_reader_t {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+};
+
+static int32_t readMem(void *context, uint8_t *buf, int32_t count) {
+    mem_reader_t *m = (mem_reader_t *)context;
+    size_t n = m->size - m->pos;
+    if ((size_t)count < n)
+        n = count;
+    size_t chunk = 1 + rand() % 100;
+    if (chunk < n)
+        n = chunk;
+    memcpy(buf, m->data + m->pos, n);
+    m->pos += n;
+    return (int32_t)n;
+}
+
+static uint8_t *encode(const uint8_t *pixels, int w, int h, int comps, int h_samp, int v_samp, int quality,
+                       int restart, unsigned long &size) {
+    jpeg_compress_struct c;
+    jpeg_error_mgr err;
+    c.err = jpeg_std_error(&err);
+    jpeg_create_compress(&c);
+    unsigned char *out = nullptr;
+    size = 0;
+    jpeg_mem_dest(&c, &out, &size);
+    c.image_width = w;
+    c.image_height = h;
+    c.input_components = comps;
+    c.in_color_space = (comps == 3) ? JCS_RGB : JCS_GRAYSCALE;
+    jpeg_set_defaults(&c);
+    jpeg_set_quality(&c, quality, TRUE);
+    c.restart_interval = restart;
+    if (comps == 3) {
+        c.comp_info[0].h_samp_factor = h_samp;
+        c.comp_info[0].v_samp_factor = v_samp;
+    }
+    jpeg_start_compress(&c, TRUE);
+    while (c.next_scanline < (unsigned)h) {
+        JSAMPROW row = (JSAMPROW)&pixels[c.next_scanline * w * comps];
+        jpeg_write_scanlines(&c, &row, 1);
+    }
+    jpeg_finish_compress(&c);
+    jpeg_destroy_compress(&c);
+    return out;
+}
+
+// Full size RGB decode
+static uint8_t *decode(const uint8_t *jpg, unsigned long size, int &w, int &h) {
+    jpeg_decompress_struct d;
+    jpeg_error_mgr err;
+    d.err = jpeg_std_error(&err);
+    jpeg_create_decompress(&d);
+    jpeg_mem_src(&d, (unsigned char *)jpg, size);
+    jpeg_read_header(&d, TRUE);
+    d.out_color_space = JCS_RGB;
+    d.dct_method = JDCT_ISLOW;
+    d.do_fancy_upsampling = FALSE; // drawJPEG repeats chroma samples
+    jpeg_start_decompress(&d);
+    w = d.output_width;
+    h = d.output_height;
+    uint8_t *rgb = (uint8_t *)malloc(w * h * 3);
+    while (d.output_scanline < d.output_height) {
+        JSAMPROW row = &rgb[d.output_scanline * w * 3];
+        jpeg_read_scanlines(&d, &row, 1);
+    }
+    jpeg_finish_decompress(&d);
+    jpeg_destroy_decompress(&d);
+    return rgb;
+}
+
+// Averages scale x scale areas of an RGB image, partial ones at the right and
+// bottom edges included
+static uint8_t *shrink(const uint8_t *rgb, int w, int h, int scale, int &sw, int &sh) {
+    sw = (w + scale - 1) / scale;
+    sh = (h + scale - 1) / scale;
+    uint8_t *out = (uint8_t *)malloc(sw * sh * 3);
+    for (int y = 0; y < sh; y++) {
+        for (int x = 0; x < sw; x++) {
+            for (int c = 0; c < 3; c++) {
+                int sum = 0, n = 0;
+                for (int yy = y * scale; (yy < h) && (yy < (y + 1) * scale); yy++) {
+                    for (int xx = x * scale; (xx < w) && (xx < (x + 1) * scale); xx++) {
+                        sum += rgb[(yy * w + xx) * 3 + c];
+                        n++;
+                    }
+                }
+                out[(y * sw + x) * 3 + c] = (sum + n / 2) / n;
+            }
+        }
+    }
+    return out;
+}
+
+static bool draw(const uint8_t *jpg, unsigned long size, int16_t x, int16_t y, uint8_t scale) {
+    mem_reader_t m = {jpg, size, 0};
+    return Teensy_Parallel_Image::drawJPEG(tft, x, y, readMem, &m, scale);
+}
+
+static void clearScreen() {
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++)
+        frame_buffer[i] = BACKGROUND;
+}
+
+static int failures = 0;
+
+int main() {
+    srand(5);
+    tft.setFrameBuffer((uint16_t *)frame_buffer, 32);
+    tft.useFrameBuffer(true);
+
+    struct {
+        int w, h, comps, h_samp, v_samp, quality, restart;
+    } cases[] = {{117, 83, 3, 1, 1, 90, 0}, {117, 83, 3, 2, 1, 75, 0}, {117, 83, 3, 2, 2, 75, 0},
+                 {200, 150, 3, 2, 2, 95, 3}, {61, 45, 1, 1, 1, 80, 0}, {64, 64, 3, 2, 2, 50, 1},
+                 {300, 200, 3, 1, 2, 85, 7}, {8, 8, 3, 2, 2, 100, 0}};
+    const int draw_x = 10, draw_y = 20;
+
+    for (auto &cs : cases) {
+        // gradients, a checker board and a noisy corner
+        uint8_t *img = (uint8_t *)malloc(cs.w * cs.h * cs.comps);
+        for (int y = 0; y < cs.h; y++) {
+            for (int x = 0; x < cs.w; x++) {
+                for (int c = 0; c < cs.comps; c++) {
+                    int v = (c == 0) ? x * 255 / cs.w : ((c == 1) ? y * 255 / cs.h : ((x / 7 + y / 5) & 1) * 200 + 20);
+                    if ((x > cs.w / 2) && (y > cs.h / 2))
+                        v = rand() & 255;
+                    img[(y * cs.w + x) * cs.comps + c] = v;
+                }
+            }
+        }
+        unsigned long size;
+        uint8_t *jpg = encode(img, cs.w, cs.h, cs.comps, cs.h_samp, cs.v_samp, cs.quality, cs.restart, size);
+        int fw, fh;
+        uint8_t *full = decode(jpg, size, fw, fh);
+
+        for (uint8_t scale = 1; scale <= 8; scale *= 2) {
+            clearScreen();
+            bool ok = draw(jpg, size, draw_x, draw_y, scale);
+            int rw, rh;
+            uint8_t *ref = shrink(full, fw, fh, scale, rw, rh);
+            int max_diff = 0;
+            double sum_diff = 0;
+            for (int y = 0; y < rh; y++) {
+                for (int x = 0; x < rw; x++) {
+                    uint32_t p = frame_buffer[(draw_y + y) * SCREEN_W + draw_x + x];
+                    for (int c = 0; c < 3; c++) {
+                        int d = abs((int)((p >> (16 - 8 * c)) & 0xff) - ref[(y * rw + x) * 3 + c]);
+                        if (d > max_diff)
+                            max_diff = d;
+                        sum_diff += d;
+                    }
+                }
+            }
+            int outside = 0;
+            for (int y = 0; y < SCREEN_H; y++)
+                for (int x = 0; x < SCREEN_W; x++)
+                    if (((x < draw_x) || (x >= draw_x + rw) || (y < draw_y) || (y >= draw_y + rh)) &&
+                        (frame_buffer[y * SCREEN_W + x] != BACKGROUND))
+                        outside++;
+            double mean = sum_diff / (rw * rh * 3);
+            bool pass = ok && !outside && ((scale == 1) ? (max_diff == 0) : (mean < 2.0));
+            printf("%3dx%-3d %s %dx%d q%-3d restart %d scale %d: max diff %3d mean %.3f outside %d %s\n", cs.w, cs.h,
+                   (cs.comps == 3) ? "color" : "gray ", cs.h_samp, cs.v_samp, cs.quality, cs.restart, scale, max_diff,
+                   mean, outside, pass ? "ok" : "FAILED");
+            if (!pass)
+                failures++;
+            free(ref);
+        }
+
+        mem_reader_t m = {jpg, size, 0};
+        int16_t w, h;
+        if (!Teensy_Parallel_Image::getJPEGSize(readMem, &m, w, h) || (w != cs.w) || (h != cs.h)) {
+            printf("  getJPEGSize gave %d x %d FAILED\n", w, h);
+            failures++;
+        }
+        if (draw(jpg, size * 2 / 3, 0, 0, 1)) {
+            printf("  truncated file decoded FAILED\n");
+            failures++;
+        }
+        free(full);
+        free(jpg);
+        free(img);
+    }
+
+    // Clipped by the origin and a clip rect, compared with the same area of an
+    // unclipped draw
+    {
+        uint8_t *img = (uint8_t *)malloc(100 * 80 * 3);
+        for (int i = 0; i < 100 * 80 * 3; i++)
+            img[i] = rand();
+        unsigned long size;
+        uint8_t *jpg = encode(img, 100, 80, 3, 2, 2, 90, 0, size);
+        static uint32_t full[SCREEN_W * SCREEN_H];
+        clearScreen();
+        draw(jpg, size, 100, 100, 1);
+        memcpy(full, frame_buffer, sizeof(full));
+        clearScreen();
+        tft.setOrigin(30, 20);
+        tft.setClipRect(90, 95, 50, 40); // 120, 115 on the display
+        draw(jpg, size, 70, 80, 1);
+        tft.setClipRect();
+        tft.setOrigin(0, 0);
+        int bad = 0;
+        for (int y = 0; y < SCREEN_H; y++) {
+            for (int x = 0; x < SCREEN_W; x++) {
+                bool inside = (x >= 120) && (x < 170) && (y >= 115) && (y < 155);
+                if (frame_buffer[y * SCREEN_W + x] != (inside ? full[y * SCREEN_W + x] : BACKGROUND))
+                    bad++;
+            }
+        }
+        printf("clipped draw: %d pixels wrong %s\n", bad, bad ? "FAILED" : "ok");
+        if (bad)
+            failures++;
+        free(jpg);
+        free(img);
+    }
+
+    // Broken Huffman tables have to be turned down, not overrun the decoder's
+    // tables: more length 1 codes than fit, and a file that ends inside a DHT
+    {
+        uint8_t img[32 * 32 * 3];
+        for (int i = 0; i < 32 * 32 * 3; i++)
+            img[i] = rand();
+        unsigned long size;
+        uint8_t *jpg = encode(img, 32, 32, 3, 2, 2, 90, 0, size);
+        unsigned long dht = 2;
+        while ((dht + 1 < size) && !((jpg[dht] == 0xff) && (jpg[dht + 1] == 0xc4)))
+            dht++;
+
+        // a DHT with 200 codes of length 1 in front of the real ones
+        uint8_t *bad = (uint8_t *)malloc(size + 2 + 2 + 17 + 200);
+        uint8_t *p = bad;
+        *p++ = 0xff;
+        *p++ = 0xd8;
+        *p++ = 0xff;
+        *p++ = 0xc4;
+        *p++ = 0;
+        *p++ = 2 + 17 + 200;
+        *p++ = 0x00; // DC table 0
+        *p++ = 200;
+        for (int i = 1; i < 16; i++)
+            *p++ = 0;
+        for (int i = 0; i < 200; i++)
+            *p++ = i % 12;
+        memcpy(p, jpg + 2, size - 2);
+        p += size - 2;
+        clearScreen();
+        bool ok = draw(bad, p - bad, 0, 0, 1);
+        printf("over subscribed DHT: %s\n", ok ? "decoded FAILED" : "ok");
+        if (ok)
+            failures++;
+
+        ok = (dht + 10 < size) && !draw(jpg, dht + 10, 0, 0, 1);
+        printf("file ending in a DHT: %s\n", ok ? "ok" : "decoded FAILED");
+        if (!ok)
+            failures++;
+        free(bad);
+        free(jpg);
+    }
+
+    if (failures)
+        printf("%d FAILED\n", failures);
+    else
+        printf("all passed\n");
+    return failures ? 1 : 0;
+}
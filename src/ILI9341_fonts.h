@@ -23,4 +23,10 @@ typedef struct {
     unsigned char line_space;
     unsigned char cap_height;
 } ILI9341_t3_font_t;
+
+// Set in version (1 becomes 0x81, the anti-aliased 23 becomes 0x97) by fonts
+// rebuilt with extras/font_tools/font_subset.  In those, unicode is a remap
+// table for index1_first..index1_last holding the index slot + 1, 0 for
+// characters left out, and there is no second index range.
+#define ILI9341_FONT_VERSION_REMAPPED 0x80
 #endif
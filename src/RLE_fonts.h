@@ -0,0 +1,43 @@
+// Run length encoded font definition.
+//
+// Large font sizes are mostly solid horizontal runs, so instead of a bit per
+// pixel each glyph row is stored as a list of runs which are drawn directly
+// as spans. Fonts are created from existing ILI9341_t3 or Adafruit GFX fonts
+// with the host side converter in extras/font_tools.
+//
+// Glyph data layout, one entry per row starting at the top of the glyph:
+//   count         - number of runs in this row, or RLE_FONT_ROW_REPEAT when
+//                   the row is identical to the previous row (no runs follow)
+//   count times:
+//     skip        - transparent pixels before this run
+//     length      - number of pixels in this run.  When bpp > 1 the top bpp
+//                   bits of this byte are the run's alpha, 0 to (1 << bpp) - 1,
+//                   and the length is the rest (so at most 63 or 15 pixels,
+//                   longer runs are split).
+#ifndef _RLE_FONTS_H_
+#define _RLE_FONTS_H_
+
+#include <stdint.h>
+
+#define RLE_FONT_ROW_REPEAT 0xFF
+
+typedef struct {
+    uint32_t data_offset; // offset of the first row in the font data
+    uint8_t width;        // bitmap size in pixels
+    uint8_t height;
+    int8_t xoffset;       // from cursor x to left edge of the bitmap
+    int8_t yoffset;       // from cursor y (top of line) to top of the bitmap
+    uint8_t delta;        // distance to advance the cursor
+} RLE_glyph_t;
+
+typedef struct {
+    const RLE_glyph_t *glyphs;
+    const unsigned char *data;
+    uint16_t first; // first and last character in glyphs
+    uint16_t last;
+    uint8_t bpp;    // 1 for solid runs, 2 or 4 for runs with alpha
+    uint8_t line_space;
+    uint8_t cap_height;
+} RLE_font_t;
+
+#endif
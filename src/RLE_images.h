@@ -0,0 +1,38 @@
+// Run length encoded image definition.
+//
+// Icons and sprites are mostly transparent areas and solid runs, so each row
+// is stored as runs: transparent runs are skipped, solid runs are drawn as
+// one fill and only the rest is stored pixel by pixel.  Images are created
+// with the host side encoder in extras/image_tools.
+//
+// Image data layout, one entry per row starting at the top of the image:
+//   RLE_IMAGE_ROW_REPEAT   the row is identical to the previous row, or
+//   runs followed by RLE_IMAGE_END_ROW (the rest of the row is transparent)
+//
+// Each run starts with a byte, the top two bits are the type and the low six
+// the length, 1 to 63.  A length of 0 means the length is in the next two
+// bytes, little endian.
+//   RLE_IMAGE_SKIP   length transparent pixels
+//   RLE_IMAGE_FILL   length pixels of one color, the color follows
+//   RLE_IMAGE_COPY   length pixels, their colors follow
+// Colors are a palette index byte for palette images, or a little endian 565
+// color for images without a palette.
+#ifndef _RLE_IMAGES_H_
+#define _RLE_IMAGES_H_
+
+#include <stdint.h>
+
+#define RLE_IMAGE_SKIP 0x00
+#define RLE_IMAGE_FILL 0x40
+#define RLE_IMAGE_COPY 0x80
+#define RLE_IMAGE_END_ROW 0xC0
+#define RLE_IMAGE_ROW_REPEAT 0xC1
+
+typedef struct {
+    const uint8_t *data;
+    const uint16_t *palette; // 565 colors, nullptr when the colors are 565
+    uint16_t width;
+    uint16_t height;
+} RLE_image_t;
+
+#endif
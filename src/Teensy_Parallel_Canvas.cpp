@@ -0,0 +1,108 @@
+
+#include "Teensy_Parallel_Canvas.h"
+
+Teensy_Parallel_Canvas::Teensy_Parallel_Canvas(void *buffer, int16_t w, int16_t h, uint16_t stride, uint8_t bit_depth)
+    : Teensy_Parallel_GFX(w, h) {
+    _stride = stride ? stride : w;
+    _canvas_bit_depth = bit_depth;
+
+    setFrameBuffer((uint16_t *)buffer, bit_depth);
+    _tpfb->setStride(_stride);
+    _use_fbtft = 1; // always drawing into the buffer
+
+    // Same defaults the displays start with.
+    _originx = 0;
+    _originy = 0;
+    setClipRect();
+    cursor_x = 0;
+    cursor_y = 0;
+    rotation = 0;
+    textsize = textsize_x = textsize_y = 1;
+    textdatum = 0;
+    padX = 0;
+    wrap = true;
+    font = nullptr;
+    setTextColor(0xFFFF, 0xFFFF);
+    scrollbgcolor = 0;
+    scrollEnable = false;
+    isWritingScrollArea = false;
+    _addr_x0 = _addr_x1 = _addr_y1 = _addr_x = _addr_y = 0;
+}
+
+Teensy_Parallel_Canvas::Teensy_Parallel_Canvas(Teensy_Parallel_Canvas &parent, int16_t x, int16_t y, int16_t w, int16_t h)
+    : Teensy_Parallel_Canvas(subCanvasBuffer(parent, x, y), w, h, parent._stride, parent._canvas_bit_depth) {
+    setFrameBufferPalette(parent._fb_palette); // same indices, same colors
+    if ((parent._tpfb->dataWidth() == 4) && (x & 1)) {
+        // would start half way into a byte
+        _width = _height = 0;
+        setClipRect();
+    }
+}
+
+// Where x, y of parent is, worked out in bits so two pixels a byte works too
+uint8_t *Teensy_Parallel_Canvas::subCanvasBuffer(Teensy_Parallel_Canvas &parent, int16_t x, int16_t y) {
+    uint32_t bits = (parent._tpfb->dataWidth() == 4) ? 4 : parent._tpfb->countBytesPerPixel() * 8;
+    uint32_t row_bytes = ((uint32_t)parent._stride * bits + 7) / 8;
+    return (uint8_t *)parent._pfbtft + (uint32_t)y * row_bytes + (uint32_t)x * bits / 8;
+}
+
+void Teensy_Parallel_Canvas::drawTo(Teensy_Parallel_GFX &tft, int16_t x, int16_t y) {
+    if ((_width < 1) || (_height < 1))
+        return;
+    if (_canvas_bit_depth == 16) {
+        tft.writeSubImageRect(x, y, _width, _height, 0, 0, _stride, _height, _pfbtft);
+        return;
+    }
+    // Other depths get converted back to 565 a row at a time.
+    uint16_t line_colors[_width];
+    for (int16_t row = 0; row < _height; row++) {
+        _tpfb->readRect(0, row, _width, 1, line_colors);
+        tft.writeRect(x, y + row, _width, 1, line_colors);
+    }
+}
+
+void Teensy_Parallel_Canvas::drawToKeyed(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, uint16_t key_color) {
+    if ((_width < 1) || (_height < 1))
+        return;
+    if (_canvas_bit_depth == 16) {
+        tft.writeSubImageRectKeyed(x, y, _width, _height, 0, 0, _stride, _height, _pfbtft, key_color);
+        return;
+    }
+    uint16_t line_colors[_width];
+    for (int16_t row = 0; row < _height; row++) {
+        _tpfb->readRect(0, row, _width, 1, line_colors);
+        tft.writeRectKeyed(x, y + row, _width, 1, line_colors, key_color);
+    }
+}
+
+//=============================================================================
+// Device functions.  The normal drawing functions go straight to the frame
+// buffer code, these are only here for the few paths that talk to the device.
+//=============================================================================
+void Teensy_Parallel_Canvas::setAddr(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    _addr_x0 = _addr_x = x0;
+    _addr_y = y0;
+    _addr_x1 = x1;
+    _addr_y1 = y1;
+}
+
+void Teensy_Parallel_Canvas::write16BitColor(uint16_t color) {
+    if ((_addr_x < _width) && (_addr_y < _height) && (_addr_y <= _addr_y1))
+        _tpfb->drawPixel(_addr_x, _addr_y, color);
+    if (++_addr_x > _addr_x1) {
+        _addr_x = _addr_x0;
+        _addr_y++;
+    }
+}
+
+void Teensy_Parallel_Canvas::writeRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) {
+    _tpfb->writeRect(x, y, w, h, w, pcolors);
+}
+
+void Teensy_Parallel_Canvas::fillRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    _tpfb->fillRect(x, y, w, h, color);
+}
+
+void Teensy_Parallel_Canvas::readRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) {
+    _tpfb->readRect(x, y, w, h, pcolors);
+}
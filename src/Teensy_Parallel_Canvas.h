@@ -0,0 +1,57 @@
+#ifndef _TEENSY_PARALLEL_CANVAS_H_
+#define _TEENSY_PARALLEL_CANVAS_H_
+
+#include "Teensy_Parallel_GFX.h"
+
+//=============================================================================
+// Offscreen canvas.
+// Draws into a buffer you provide using the same frame buffer code the
+// displays use, so all of the graphic primitives and text work on it.  Useful
+// for rendering something expensive once and then blitting it to the display
+// with drawTo() or drawToKeyed() as often as needed.
+//=============================================================================
+class Teensy_Parallel_Canvas : public Teensy_Parallel_GFX {
+  public:
+    // buffer holds stride * h pixels (stride defaults to w) of bit_depth 16, 18, 24
+    // or 32 bits (18 and 24 bit buffers take 3 bytes per pixel, like the displays
+    // do, 32 is 24 bit color as XRGB8888).
+    Teensy_Parallel_Canvas(void *buffer, int16_t w, int16_t h, uint16_t stride = 0, uint8_t bit_depth = 16);
+    // Canvas over the w x h area at x, y of parent, sharing its memory (nothing is
+    // copied).  The area must be inside the parent.  4 bit pixels share bytes,
+    // so in a 4 bit parent x has to be even, otherwise the canvas is empty
+    // (0 x 0) and nothing draws into it.
+    Teensy_Parallel_Canvas(Teensy_Parallel_Canvas &parent, int16_t x, int16_t y, int16_t w, int16_t h);
+
+    uint16_t *getBuffer() { return _pfbtft; }
+    uint16_t getStride() { return _stride; }
+    uint8_t getBitDepth() { return _canvas_bit_depth; }
+
+    // Copy the canvas to tft with its top left corner at x, y
+    void drawTo(Teensy_Parallel_GFX &tft, int16_t x, int16_t y);
+    // Same, but pixels that are key_color are not copied
+    void drawToKeyed(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, uint16_t key_color);
+
+    // The device functions, everything goes to the buffer.
+    virtual void setAddr(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    virtual void beginWrite16BitColors() {}
+    virtual void write16BitColor(uint16_t color);
+    virtual void endWrite16BitColors() {}
+    virtual void updateScreenFlexIO() {} // the buffer is the screen
+    virtual void writeRect18BPPPackedFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+                                            uint16_t stride) {}
+    virtual void writeRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors);
+    virtual void fillRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void readRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors);
+    virtual void setRotation(uint8_t r) {} // canvases are not rotated
+
+  protected:
+    static uint8_t *subCanvasBuffer(Teensy_Parallel_Canvas &parent, int16_t x, int16_t y);
+
+    uint16_t _stride;
+    uint8_t _canvas_bit_depth;
+    // current setAddr window for write16BitColor
+    int16_t _addr_x0, _addr_x1, _addr_y1;
+    int16_t _addr_x, _addr_y;
+};
+
+#endif
@@ -0,0 +1,370 @@
+#include "Teensy_Parallel_Convert.h"
+#include <string.h>
+
+// The packed formats are done 4 pixels at a time, which is 3 words once the
+// packed side is on a word boundary (little endian, R is the low byte).
+
+// 4 packed pixels from their 12 bytes
+static inline void storePacked4(uint32_t *pw, const uint8_t *c) {
+    pw[0] = c[0] | (c[1] << 8) | (c[2] << 16) | ((uint32_t)c[3] << 24);
+    pw[1] = c[4] | (c[5] << 8) | (c[6] << 16) | ((uint32_t)c[7] << 24);
+    pw[2] = c[8] | (c[9] << 8) | (c[10] << 16) | ((uint32_t)c[11] << 24);
+}
+
+static inline void put565(uint8_t *p, uint16_t color) {
+    p[0] = (color >> 8) & 0xf8;
+    p[1] = (color >> 3) & 0xfc;
+    p[2] = color << 3;
+}
+
+static inline uint16_t get565(const uint8_t *p) {
+    return ((p[0] & 0xf8) << 8) | ((p[1] & 0xfc) << 3) | (p[2] >> 3);
+}
+
+static inline void putXRGB(uint8_t *p, uint32_t color, uint8_t mask) {
+    p[0] = (color >> 16) & mask;
+    p[1] = (color >> 8) & mask;
+    p[2] = color & mask;
+}
+
+void Teensy_Parallel_Convert::convertRow565To888(const uint16_t *src, uint8_t *dst, int16_t count) {
+    while (count && ((uintptr_t)dst & 3)) {
+        put565(dst, *src++);
+        dst += 3;
+        count--;
+    }
+    uint32_t *pw = (uint32_t *)dst;
+    for (; count >= 4; count -= 4) {
+        uint8_t c[12];
+        put565(c, src[0]);
+        put565(c + 3, src[1]);
+        put565(c + 6, src[2]);
+        put565(c + 9, src[3]);
+        storePacked4(pw, c);
+        pw += 3;
+        src += 4;
+    }
+    dst = (uint8_t *)pw;
+    while (count--) {
+        put565(dst, *src++);
+        dst += 3;
+    }
+}
+
+void Teensy_Parallel_Convert::convertRow888To565(const uint8_t *src, uint16_t *dst, int16_t count) {
+    while (count && ((uintptr_t)src & 3)) {
+        *dst++ = get565(src);
+        src += 3;
+        count--;
+    }
+    // w0 = R0 G0 B0 R1, w1 = G1 B1 R2 G2, w2 = B2 R3 G3 B3
+    const uint32_t *pw = (const uint32_t *)src;
+    for (; count >= 4; count -= 4) {
+        uint32_t w0 = pw[0];
+        uint32_t w1 = pw[1];
+        uint32_t w2 = pw[2];
+        pw += 3;
+        dst[0] = ((w0 & 0xf8) << 8) | ((w0 >> 5) & 0x7e0) | ((w0 >> 19) & 0x1f);
+        dst[1] = ((w0 >> 16) & 0xf800) | ((w1 << 3) & 0x7e0) | ((w1 >> 11) & 0x1f);
+        dst[2] = ((w1 >> 8) & 0xf800) | ((w1 >> 21) & 0x7e0) | ((w2 >> 3) & 0x1f);
+        dst[3] = (w2 & 0xf800) | ((w2 >> 13) & 0x7e0) | (w2 >> 27);
+        dst += 4;
+    }
+    src = (const uint8_t *)pw;
+    while (count--) {
+        *dst++ = get565(src);
+        src += 3;
+    }
+}
+
+void Teensy_Parallel_Convert::convertRow565ToXRGB(const uint16_t *src, uint32_t *dst, int16_t count) {
+    for (; count >= 4; count -= 4) {
+        uint32_t c0 = src[0], c1 = src[1], c2 = src[2], c3 = src[3];
+        dst[0] = ((c0 & 0xf800) << 8) | ((c0 & 0x7e0) << 5) | ((c0 & 0x1f) << 3);
+        dst[1] = ((c1 & 0xf800) << 8) | ((c1 & 0x7e0) << 5) | ((c1 & 0x1f) << 3);
+        dst[2] = ((c2 & 0xf800) << 8) | ((c2 & 0x7e0) << 5) | ((c2 & 0x1f) << 3);
+        dst[3] = ((c3 & 0xf800) << 8) | ((c3 & 0x7e0) << 5) | ((c3 & 0x1f) << 3);
+        src += 4;
+        dst += 4;
+    }
+    while (count--) {
+        uint32_t c = *src++;
+        *dst++ = ((c & 0xf800) << 8) | ((c & 0x7e0) << 5) | ((c & 0x1f) << 3);
+    }
+}
+
+void Teensy_Parallel_Convert::convertRowXRGBTo565(const uint32_t *src, uint16_t *dst, int16_t count) {
+    for (; count >= 4; count -= 4) {
+        uint32_t c0 = src[0], c1 = src[1], c2 = src[2], c3 = src[3];
+        dst[0] = ((c0 >> 8) & 0xf800) | ((c0 >> 5) & 0x7e0) | ((c0 >> 3) & 0x1f);
+        dst[1] = ((c1 >> 8) & 0xf800) | ((c1 >> 5) & 0x7e0) | ((c1 >> 3) & 0x1f);
+        dst[2] = ((c2 >> 8) & 0xf800) | ((c2 >> 5) & 0x7e0) | ((c2 >> 3) & 0x1f);
+        dst[3] = ((c3 >> 8) & 0xf800) | ((c3 >> 5) & 0x7e0) | ((c3 >> 3) & 0x1f);
+        src += 4;
+        dst += 4;
+    }
+    while (count--) {
+        uint32_t c = *src++;
+        *dst++ = ((c >> 8) & 0xf800) | ((c >> 5) & 0x7e0) | ((c >> 3) & 0x1f);
+    }
+}
+
+// 888 and 666 only differ in the low bits of each channel being kept
+static inline void convertRowXRGBToPacked(const uint32_t *src, uint8_t *dst, int16_t count, uint8_t mask) {
+    while (count && ((uintptr_t)dst & 3)) {
+        putXRGB(dst, *src++, mask);
+        dst += 3;
+        count--;
+    }
+    uint32_t *pw = (uint32_t *)dst;
+    for (; count >= 4; count -= 4) {
+        uint8_t c[12];
+        putXRGB(c, src[0], mask);
+        putXRGB(c + 3, src[1], mask);
+        putXRGB(c + 6, src[2], mask);
+        putXRGB(c + 9, src[3], mask);
+        storePacked4(pw, c);
+        pw += 3;
+        src += 4;
+    }
+    dst = (uint8_t *)pw;
+    while (count--) {
+        putXRGB(dst, *src++, mask);
+        dst += 3;
+    }
+}
+
+void Teensy_Parallel_Convert::convertRowXRGBTo888(const uint32_t *src, uint8_t *dst, int16_t count) {
+    convertRowXRGBToPacked(src, dst, count, 0xff);
+}
+
+void Teensy_Parallel_Convert::convertRowXRGBTo666(const uint32_t *src, uint8_t *dst, int16_t count) {
+    convertRowXRGBToPacked(src, dst, count, 0xfc);
+}
+
+void Teensy_Parallel_Convert::fillRow888(uint8_t *dst, int16_t count, const uint8_t color[3]) {
+    while (count && ((uintptr_t)dst & 3)) {
+        dst[0] = color[0];
+        dst[1] = color[1];
+        dst[2] = color[2];
+        dst += 3;
+        count--;
+    }
+    // pattern starts with R on every pixel boundary
+    uint32_t word0 = color[0] | (color[1] << 8) | (color[2] << 16) | ((uint32_t)color[0] << 24);
+    uint32_t word1 = color[1] | (color[2] << 8) | (color[0] << 16) | ((uint32_t)color[1] << 24);
+    uint32_t word2 = color[2] | (color[0] << 8) | (color[1] << 16) | ((uint32_t)color[2] << 24);
+    uint32_t *pw = (uint32_t *)dst;
+    for (; count >= 4; count -= 4) {
+        *pw++ = word0;
+        *pw++ = word1;
+        *pw++ = word2;
+    }
+    dst = (uint8_t *)pw;
+    while (count--) {
+        dst[0] = color[0];
+        dst[1] = color[1];
+        dst[2] = color[2];
+        dst += 3;
+    }
+}
+
+// 666 is 888 with the low 2 bits of each channel clear, a word at a time
+void Teensy_Parallel_Convert::convertRow888To666(const uint8_t *src, uint8_t *dst, int16_t count) {
+    uint32_t bytes = (uint32_t)count * 3;
+    if (!(((uintptr_t)src | (uintptr_t)dst) & 3)) {
+        const uint32_t *ps = (const uint32_t *)src;
+        uint32_t *pd = (uint32_t *)dst;
+        for (; bytes >= 4; bytes -= 4)
+            *pd++ = *ps++ & 0xfcfcfcfc;
+        src = (const uint8_t *)ps;
+        dst = (uint8_t *)pd;
+    }
+    while (bytes--)
+        *dst++ = *src++ & 0xfc;
+}
+
+void Teensy_Parallel_Convert::convertRow888ToXRGB(const uint8_t *src, uint32_t *dst, int16_t count) {
+    while (count && ((uintptr_t)src & 3)) {
+        *dst++ = (src[0] << 16) | (src[1] << 8) | src[2];
+        src += 3;
+        count--;
+    }
+    // w0 = R0 G0 B0 R1, w1 = G1 B1 R2 G2, w2 = B2 R3 G3 B3
+    const uint32_t *pw = (const uint32_t *)src;
+    for (; count >= 4; count -= 4) {
+        uint32_t w0 = pw[0];
+        uint32_t w1 = pw[1];
+        uint32_t w2 = pw[2];
+        pw += 3;
+        dst[0] = ((w0 & 0xff) << 16) | (w0 & 0xff00) | ((w0 >> 16) & 0xff);
+        dst[1] = ((w0 >> 8) & 0xff0000) | ((w1 & 0xff) << 8) | ((w1 >> 8) & 0xff);
+        dst[2] = (w1 & 0xff0000) | ((w1 >> 16) & 0xff00) | (w2 & 0xff);
+        dst[3] = ((w2 << 8) & 0xff0000) | ((w2 >> 8) & 0xff00) | (w2 >> 24);
+        dst += 4;
+    }
+    src = (const uint8_t *)pw;
+    while (count--) {
+        *dst++ = (src[0] << 16) | (src[1] << 8) | src[2];
+        src += 3;
+    }
+}
+
+uint8_t Teensy_Parallel_Convert::bytesPerPixel(uint8_t fmt) {
+    switch (fmt) {
+    case FMT_565:
+        return 2;
+    case FMT_666:
+    case FMT_888:
+        return 3;
+    case FMT_XRGB:
+        return 4;
+    }
+    return 0;
+}
+
+bool Teensy_Parallel_Convert::convertRow(void *dst, uint8_t dst_fmt, const void *src, uint8_t src_fmt, int16_t count) {
+    if ((dst_fmt >= FMT_COUNT) || (src_fmt >= FMT_COUNT))
+        return false;
+    if (count <= 0)
+        return true;
+    // 666 is valid 888, so it reads the same
+    if ((src_fmt == FMT_666) && (dst_fmt != FMT_666))
+        src_fmt = FMT_888;
+    if (src_fmt == dst_fmt) {
+        memcpy(dst, src, (uint32_t)count * bytesPerPixel(dst_fmt));
+        return true;
+    }
+    switch (src_fmt) {
+    case FMT_565:
+        if (dst_fmt == FMT_XRGB)
+            convertRow565ToXRGB((const uint16_t *)src, (uint32_t *)dst, count);
+        else
+            convertRow565To888((const uint16_t *)src, (uint8_t *)dst, count); // same bits for 666
+        break;
+    case FMT_888:
+        if (dst_fmt == FMT_565)
+            convertRow888To565((const uint8_t *)src, (uint16_t *)dst, count);
+        else if (dst_fmt == FMT_666)
+            convertRow888To666((const uint8_t *)src, (uint8_t *)dst, count);
+        else
+            convertRow888ToXRGB((const uint8_t *)src, (uint32_t *)dst, count);
+        break;
+    case FMT_XRGB:
+        if (dst_fmt == FMT_565)
+            convertRowXRGBTo565((const uint32_t *)src, (uint16_t *)dst, count);
+        else if (dst_fmt == FMT_666)
+            convertRowXRGBTo666((const uint32_t *)src, (uint8_t *)dst, count);
+        else
+            convertRowXRGBTo888((const uint32_t *)src, (uint8_t *)dst, count);
+        break;
+    }
+    return true;
+}
+
+//=============================================================================
+// Dithering XRGB down to 565
+//=============================================================================
+
+// 4x4 Bayer thresholds, pre-scaled to what each channel loses: 0-7 for the
+// 5 bit red and blue (red << 16 | blue) and 0-3 for the 6 bit green.
+static const uint32_t bayer_rb[4][4] = {
+    {0x000000, 0x040004, 0x010001, 0x050005},
+    {0x060006, 0x020002, 0x070007, 0x030003},
+    {0x010001, 0x050005, 0x000000, 0x040004},
+    {0x070007, 0x030003, 0x060006, 0x020002}};
+static const uint8_t bayer_g[4][4] = {
+    {0, 2, 0, 2},
+    {3, 1, 3, 1},
+    {0, 2, 0, 2},
+    {3, 1, 3, 1}};
+
+void Teensy_Parallel_Convert::convertRowXRGBTo565Bayer(const uint32_t *src, uint16_t *dst, int16_t count, int16_t x,
+                                                       int16_t y) {
+    const uint32_t *t_rb = bayer_rb[y & 3];
+    const uint8_t *t_g = bayer_g[y & 3];
+    for (int16_t i = 0; i < count; i++) {
+        uint32_t c = src[i];
+        uint8_t col = (x + i) & 3;
+        // red and blue get their threshold in one add, 8 bits of room each so
+        // a carry shows up in bit 8 of the channel
+        uint32_t rb = (c & 0xff00ff) + t_rb[col];
+        if (rb & 0x1000000)
+            rb |= 0xff0000;
+        if (rb & 0x100)
+            rb |= 0xff;
+        uint32_t g = ((c >> 8) & 0xff) + t_g[col];
+        if (g > 0xff)
+            g = 0xff;
+        dst[i] = ((rb >> 8) & 0xf800) | ((g << 3) & 0x7e0) | ((rb >> 3) & 0x1f);
+    }
+}
+
+// Quantize v (0-255 plus the error carried in) to bits, returns the 565 field
+// value and leaves the error in v.  The levels are the full scale ones (31 is
+// 255, not 248) or every saturated pixel would push error on forever, and the
+// error is kept to half a step for the same reason when v is out of range.
+static inline uint16_t quantizeFS(int &v, uint8_t bits) {
+    int shift = 8 - bits;
+    int qmax = (1 << bits) - 1;
+    int q = (v * qmax + 127) / 255;
+    if (q < 0)
+        q = 0;
+    else if (q > qmax)
+        q = qmax;
+    v -= (q << shift) | (q >> (bits - shift));
+    int half = 1 << (shift - 1);
+    if (v > half)
+        v = half;
+    else if (v < -half)
+        v = -half;
+    return q;
+}
+
+void Teensy_Parallel_Convert::convertRowXRGBTo565FS(const uint32_t *src, uint16_t *dst, int16_t count, int16_t *err) {
+    // err[3 * (i + 1)] is the error carried down into pixel i, it is used and
+    // then replaced with what goes down to the next row
+    int right[3] = {0, 0, 0}; // 7/16 going to the next pixel
+    int down_right[3] = {0, 0, 0}; // 1/16 going to the pixel down right
+    int16_t *e = err + 3;
+    static const uint8_t bits[3] = {5, 6, 5};
+    for (int16_t i = 0; i < count; i++, e += 3) {
+        uint32_t c = src[i];
+        int v[3] = {(int)((c >> 16) & 0xff), (int)((c >> 8) & 0xff), (int)(c & 0xff)};
+        uint16_t q[3];
+        for (int ch = 0; ch < 3; ch++) {
+            v[ch] += right[ch] + e[ch];
+            q[ch] = quantizeFS(v[ch], bits[ch]);
+            int q_err = v[ch];
+            right[ch] = (q_err * 7) / 16;
+            e[ch - 3] += (q_err * 3) / 16;
+            e[ch] = (q_err * 5) / 16 + down_right[ch];
+            down_right[ch] = q_err / 16;
+        }
+        dst[i] = (q[0] << 11) | (q[1] << 5) | q[2];
+    }
+}
+
+void Teensy_Parallel_Convert::convertRowXRGBTo565Dither(const uint32_t *src, uint16_t *dst, int16_t count,
+                                                        uint8_t dither, int16_t x, int16_t y, int16_t *err) {
+    if (dither == DITHER_BAYER)
+        convertRowXRGBTo565Bayer(src, dst, count, x, y);
+    else if ((dither == DITHER_FLOYD_STEINBERG) && err)
+        convertRowXRGBTo565FS(src, dst, count, err);
+    else
+        convertRowXRGBTo565(src, dst, count);
+}
+
+static inline uint32_t clamp255(int32_t v) { return (v < 0) ? 0 : ((v > 255) ? 255 : v); }
+
+void Teensy_Parallel_Convert::convertRowYCbCrToXRGB(const uint8_t *y, const uint8_t *cb, const uint8_t *cr,
+                                                    uint32_t *dst, int16_t count, uint8_t chroma_shift) {
+    // 16.16 fixed point: 1.402, 0.344136, 0.714136 and 1.772
+    for (int16_t i = 0; i < count; i++) {
+        int32_t luma = (y[i] << 16) + 0x8000;
+        int32_t u = cb[i >> chroma_shift] - 128;
+        int32_t v = cr[i >> chroma_shift] - 128;
+        dst[i] = (clamp255((luma + 91881 * v) >> 16) << 16) | (clamp255((luma - 22554 * u - 46802 * v) >> 16) << 8) |
+                 clamp255((luma + 116130 * u) >> 16);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef _TEENSY_PARALLEL_CONVERT_H_
+#define _TEENSY_PARALLEL_CONVERT_H_
+
+#include <stdint.h>
+
+//=============================================================================
+// Row color conversion.
+// The frame buffers and the paths that send them convert pixels a row at a
+// time through here rather than one pixel at a time.  The formats are:
+//   FMT_565   uint16 565, what the displays are sent
+//   FMT_666   3 bytes a pixel R G B, 6 bits of each at the top of its byte (FB18)
+//   FMT_888   3 bytes a pixel R G B (FB24)
+//   FMT_XRGB  uint32 0x00RRGGBB, the top byte is ignored (FB32, the 24BPP calls)
+// 565 goes to the wider formats without filling in the low bits, so converting
+// back gives the same 565 color.  The kernels do 4 pixels a loop, and on the
+// packed side 4 pixels are 3 words once it is on a word boundary, so rows can
+// start anywhere.
+//=============================================================================
+class Teensy_Parallel_Convert {
+  public:
+    enum { FMT_565 = 0, FMT_666, FMT_888, FMT_XRGB, FMT_COUNT };
+    // How XRGB is taken down to 565, see setDither
+    enum { DITHER_NONE = 0, DITHER_BAYER, DITHER_FLOYD_STEINBERG };
+
+    static uint8_t bytesPerPixel(uint8_t fmt);
+    // Convert count pixels from src to dst, the same format is just a copy.
+    // Returns false for an unknown format.
+    static bool convertRow(void *dst, uint8_t dst_fmt, const void *src, uint8_t src_fmt, int16_t count);
+
+    // The kernels convertRow uses, for code that knows its formats.  The 888
+    // ones also read 666 and the 565 to 888 one also writes 666.
+    static void convertRow565To888(const uint16_t *src, uint8_t *dst, int16_t count);
+    static void convertRow888To565(const uint8_t *src, uint16_t *dst, int16_t count);
+    static void convertRow565ToXRGB(const uint16_t *src, uint32_t *dst, int16_t count);
+    static void convertRowXRGBTo565(const uint32_t *src, uint16_t *dst, int16_t count);
+    static void convertRowXRGBTo888(const uint32_t *src, uint8_t *dst, int16_t count);
+    static void convertRowXRGBTo666(const uint32_t *src, uint8_t *dst, int16_t count);
+    static void convertRow888ToXRGB(const uint8_t *src, uint32_t *dst, int16_t count);
+    static void convertRow888To666(const uint8_t *src, uint8_t *dst, int16_t count);
+
+    // XRGB to 565 with dithering.  x, y is where the first pixel goes, for the
+    // 4x4 Bayer pattern.  Floyd-Steinberg needs err, 3 * (count + 2) int16
+    // zeroed before the first row, which carries the error from one row to the
+    // next so the rows have to be done in order.  DITHER_NONE is the same as
+    // convertRowXRGBTo565.
+    static void convertRowXRGBTo565Dither(const uint32_t *src, uint16_t *dst, int16_t count, uint8_t dither,
+                                          int16_t x, int16_t y, int16_t *err);
+    static void convertRowXRGBTo565Bayer(const uint32_t *src, uint16_t *dst, int16_t count, int16_t x, int16_t y);
+    static void convertRowXRGBTo565FS(const uint32_t *src, uint16_t *dst, int16_t count, int16_t *err);
+
+    // JFIF YCbCr (full range) to XRGB, for the JPEG decoder.  cb and cr are
+    // 1 / (1 << chroma_shift) the width of y, each one used for that many pixels.
+    static void convertRowYCbCrToXRGB(const uint8_t *y, const uint8_t *cb, const uint8_t *cr, uint32_t *dst,
+                                      int16_t count, uint8_t chroma_shift);
+
+    // Fill count packed (666 or 888) pixels with one color
+    static void fillRow888(uint8_t *dst, int16_t count, const uint8_t color[3]);
+};
+
+#endif
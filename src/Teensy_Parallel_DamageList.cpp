@@ -0,0 +1,43 @@
+#include "Teensy_Parallel_DamageList.h"
+
+void Teensy_Parallel_DamageList::add(int16_t x, int16_t y, int16_t w, int16_t h) {
+    rect_t r = {max(x, (int16_t)0), max(y, (int16_t)0),
+                min((int16_t)(x + w), _tft.width()), min((int16_t)(y + h), _tft.height())};
+    if ((r.x1 >= r.x2) || (r.y1 >= r.y2))
+        return;
+
+    // Merge with any area it touches, which may in turn touch others
+    uint8_t i = 0;
+    while (i < _count) {
+        rect_t &d = _rects[i];
+        if ((r.x1 <= d.x2) && (d.x1 <= r.x2) && (r.y1 <= d.y2) && (d.y1 <= r.y2)) {
+            r.x1 = min(r.x1, d.x1);
+            r.y1 = min(r.y1, d.y1);
+            r.x2 = max(r.x2, d.x2);
+            r.y2 = max(r.y2, d.y2);
+            _rects[i] = _rects[--_count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    if (_count < _max_rects) {
+        _rects[_count++] = r;
+        return;
+    }
+    // Full, grow the one that grows the least
+    uint8_t best = 0;
+    int32_t best_growth = 0x7fffffff;
+    for (i = 0; i < _count; i++) {
+        rect_t &d = _rects[i];
+        int32_t area = (int32_t)(max(r.x2, d.x2) - min(r.x1, d.x1)) * (max(r.y2, d.y2) - min(r.y1, d.y1));
+        int32_t growth = area - (int32_t)(d.x2 - d.x1) * (d.y2 - d.y1);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    rect_t d = _rects[best];
+    _rects[best] = _rects[--_count];
+    add(min(r.x1, d.x1), min(r.y1, d.y1), max(r.x2, d.x2) - min(r.x1, d.x1), max(r.y2, d.y2) - min(r.y1, d.y1));
+}
@@ -0,0 +1,34 @@
+#ifndef _TEENSY_PARALLEL_DAMAGELIST_H_
+#define _TEENSY_PARALLEL_DAMAGELIST_H_
+
+#include "Teensy_Parallel_GFX.h"
+
+//=============================================================================
+// Damaged areas of the display, used by the scene, layers and sprites.
+// Areas are kept inside the display and an area merges with any it touches
+// (which may in turn touch others), so nothing is redrawn twice.  When the
+// list is full the area that grows the least takes the new one.  The rects
+// are storage you provide, max_rects of them.
+//=============================================================================
+class Teensy_Parallel_DamageList {
+  public:
+    typedef struct {
+        int16_t x1, y1, x2, y2; // x2, y2 are one past the end
+    } rect_t;
+
+    Teensy_Parallel_DamageList(Teensy_Parallel_GFX &tft, rect_t *rects, uint8_t max_rects)
+        : _tft(tft), _rects(rects), _max_rects(max_rects) {}
+
+    void add(int16_t x, int16_t y, int16_t w, int16_t h);
+    void clear() { _count = 0; }
+    uint8_t count() { return _count; }
+    const rect_t &operator[](uint8_t i) { return _rects[i]; }
+
+  protected:
+    Teensy_Parallel_GFX &_tft;
+    rect_t *_rects;
+    uint8_t _max_rects;
+    uint8_t _count = 0;
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "Teensy_Parallel_DisplayList.h"
+#include <string.h>
+
+// Commands are stored as the op byte followed by its int16 args and then its
+// pointers, all unaligned (memcpy'd) to keep the list small.
+const uint8_t Teensy_Parallel_DisplayList::op_args[DL_OP_COUNT][2] = {
+    {0, 0}, // DL_END
+    {1, 0}, // DL_FILL_SCREEN color
+    {3, 0}, // DL_DRAW_PIXEL x, y, color
+    {4, 0}, // DL_DRAW_FAST_HLINE x, y, w, color
+    {4, 0}, // DL_DRAW_FAST_VLINE x, y, h, color
+    {5, 0}, // DL_FILL_RECT x, y, w, h, color
+    {5, 0}, // DL_DRAW_LINE x0, y0, x1, y1, color
+    {5, 0}, // DL_DRAW_RECT x, y, w, h, color
+    {6, 0}, // DL_DRAW_ROUND_RECT x, y, w, h, r, color
+    {6, 0}, // DL_FILL_ROUND_RECT x, y, w, h, r, color
+    {4, 0}, // DL_DRAW_CIRCLE x, y, r, color
+    {4, 0}, // DL_FILL_CIRCLE x, y, r, color
+    {7, 0}, // DL_DRAW_TRIANGLE x0, y0, x1, y1, x2, y2, color
+    {7, 0}, // DL_FILL_TRIANGLE x0, y0, x1, y1, x2, y2, color
+    {6, 0}, // DL_FILL_RECT_HGRADIENT x, y, w, h, color1, color2
+    {6, 0}, // DL_FILL_RECT_VGRADIENT x, y, w, h, color1, color2
+    {6, 2}, // DL_FILL_RECT_LINEAR_GRADIENT x, y, w, h, count, vertical : colors, stops
+    {9, 0}, // DL_FILL_RECT_RADIAL_GRADIENT x, y, w, h, cx, cy, radius, color1, color2
+    {8, 2}, // DL_FILL_RECT_RADIAL_GRADIENT_STOPS x, y, w, h, cx, cy, radius, count : colors, stops
+    {4, 1}, // DL_WRITE_RECT x, y, w, h : pcolors
+    {8, 1}, // DL_WRITE_SUBIMAGE_RECT x, y, w, h, offset x, y, image w, h : pcolors
+    {9, 1}, // DL_WRITE_SUBIMAGE_RECT_KEYED same + key color : pcolors
+    {11, 1}, // DL_WRITE_SUBIMAGE_RECT_BLEND same + alpha, keyed, key color : pcolors
+    {4, 2}, // DL_WRITE_RECT_8BPP x, y, w, h : pixels, palette
+    {7, 2}, // DL_WRITE_RECT_8BPP_BLEND x, y, w, h, alpha, keyed, key index : pixels, palette
+    {5, 2}, // DL_WRITE_RECT_NBPP x, y, w, h, bits : pixels, palette
+    {4, 0}, // DL_DRAW_PIXEL_24BPP x, y, color (2)
+    {5, 0}, // DL_DRAW_FAST_HLINE_24BPP x, y, w, color (2)
+    {5, 0}, // DL_DRAW_FAST_VLINE_24BPP x, y, h, color (2)
+    {6, 0}, // DL_FILL_RECT_24BPP x, y, w, h, color (2)
+    {4, 1}, // DL_WRITE_RECT_24BPP x, y, w, h : pixels
+    {5, 1}, // DL_DRAW_BITMAP x, y, w, h, color : bitmap
+    {2, 1}, // DL_DRAW_RLE_IMAGE x, y : image
+    {9, 1}, // DL_DRAW_IMAGE_SCALED x, y, w, h, image w, h, filter, keyed, key color : pcolors
+    {11, 1}, // DL_DRAW_IMAGE_ROTATED x, y, image w, h, pivot x, y, angle (2), filter, keyed, key color : pcolors
+    {7, 0}, // DL_DRAW_CHAR x, y, c, color, bg, size x, y
+    {3, 0}, // DL_SET_CURSOR x, y, autoCenter
+    {1, 0}, // DL_SET_TEXT_COLOR color
+    {2, 0}, // DL_SET_TEXT_COLOR_BG color, bg
+    {2, 0}, // DL_SET_TEXT_SIZE x, y
+    {1, 0}, // DL_SET_TEXT_WRAP wrap
+    {1, 0}, // DL_SET_TEXT_DATUM datum
+    {0, 1}, // DL_SET_FONT_ILI : font
+    {0, 1}, // DL_SET_FONT_GFX : font (nullptr for the built in one)
+    {0, 1}, // DL_SET_FONT_RLE : font
+    {1, 0}, // DL_TEXT len, followed by the text
+    {8, 3}, // DL_TEXT_STATE cursor x, y, color, bg, size x, y, wrap, datum : ili, gfx, rle font
+};
+
+Teensy_Parallel_DisplayList::Teensy_Parallel_DisplayList(void *buffer, uint32_t size) {
+    _buffer = (uint8_t *)buffer;
+    _size = size;
+}
+
+void Teensy_Parallel_DisplayList::clear() {
+    _used = 0;
+    _count = 0;
+    _overflow = false;
+}
+
+bool Teensy_Parallel_DisplayList::recordPtr(uint8_t op, const void *p0, const void *p1, const void *p2,
+                                            int16_t a0, int16_t a1, int16_t a2, int16_t a3, int16_t a4,
+                                            int16_t a5, int16_t a6, int16_t a7, int16_t a8, int16_t a9,
+                                            int16_t a10) {
+    if (_overflow || (op == DL_END) || (op >= DL_OP_COUNT))
+        return false;
+    const int16_t args[TPGFX_DL_MAX_ARGS] = {a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10};
+    const void *ptrs[TPGFX_DL_MAX_PTRS] = {p0, p1, p2};
+    uint8_t nargs = op_args[op][0];
+    uint8_t nptrs = op_args[op][1];
+    uint32_t cb = 1 + nargs * sizeof(int16_t) + nptrs * sizeof(void *);
+    if ((_used + cb) > _size) {
+        _overflow = true; // don't record anything more, it would be out of order
+        return false;
+    }
+    uint8_t *p = _buffer + _used;
+    *p++ = op;
+    memcpy(p, args, nargs * sizeof(int16_t));
+    p += nargs * sizeof(int16_t);
+    memcpy(p, ptrs, nptrs * sizeof(void *));
+    _used += cb;
+    _count++;
+    return true;
+}
+
+bool Teensy_Parallel_DisplayList::recordText(const uint8_t *text, uint16_t len) {
+    if (_overflow)
+        return false;
+    if ((_used + 1 + sizeof(int16_t) + len) > _size) {
+        _overflow = true;
+        return false;
+    }
+    uint8_t *p = _buffer + _used;
+    *p++ = DL_TEXT;
+    memcpy(p, &len, sizeof(len));
+    memcpy(p + sizeof(len), text, len);
+    _used += 1 + sizeof(len) + len;
+    _count++;
+    return true;
+}
+
+uint32_t Teensy_Parallel_DisplayList::read(uint32_t offset, uint8_t &op, int16_t *args, const void **ptrs,
+                                           const uint8_t **text) {
+    if (offset >= _used) {
+        op = DL_END;
+        return 0;
+    }
+    const uint8_t *p = _buffer + offset;
+    op = *p++;
+    uint8_t nargs = op_args[op][0];
+    uint8_t nptrs = op_args[op][1];
+    memcpy(args, p, nargs * sizeof(int16_t));
+    p += nargs * sizeof(int16_t);
+    memcpy(ptrs, p, nptrs * sizeof(void *));
+    p += nptrs * sizeof(void *);
+    if (op == DL_TEXT) {
+        *text = p;
+        p += (uint16_t)args[0];
+    }
+    return p - _buffer;
+}
@@ -0,0 +1,113 @@
+#ifndef _TEENSY_PARALLEL_DISPLAYLIST_H_
+#define _TEENSY_PARALLEL_DISPLAYLIST_H_
+
+#include <stdint.h>
+
+// Most int16 arguments any command takes
+#define TPGFX_DL_MAX_ARGS 11
+// Most pointer arguments any command takes
+#define TPGFX_DL_MAX_PTRS 3
+
+//=============================================================================
+// Display list.
+// A compact record of drawing calls kept in a buffer you provide.  Start
+// recording with tft.beginDisplayList(dl), make the normal drawing calls
+// (nothing is drawn while recording), then tft.endDisplayList().  The list
+// can then be drawn with drawDisplayList() as often as needed, to the display,
+// a canvas or any other Teensy_Parallel_GFX, optionally limited to a rectangle
+// so a screen can be rendered a band at a time.
+//
+// Images, bitmaps, fonts and palettes are recorded by pointer, so they need to
+// stay around for as long as the list is used.  Text is recorded as the
+// string plus the text state (cursor, colors, font...) it was drawn with.
+//=============================================================================
+class Teensy_Parallel_DisplayList {
+  public:
+    enum {
+        DL_END = 0,
+        DL_FILL_SCREEN,
+        DL_DRAW_PIXEL,
+        DL_DRAW_FAST_HLINE,
+        DL_DRAW_FAST_VLINE,
+        DL_FILL_RECT,
+        DL_DRAW_LINE,
+        DL_DRAW_RECT,
+        DL_DRAW_ROUND_RECT,
+        DL_FILL_ROUND_RECT,
+        DL_DRAW_CIRCLE,
+        DL_FILL_CIRCLE,
+        DL_DRAW_TRIANGLE,
+        DL_FILL_TRIANGLE,
+        DL_FILL_RECT_HGRADIENT,
+        DL_FILL_RECT_VGRADIENT,
+        DL_FILL_RECT_LINEAR_GRADIENT,
+        DL_FILL_RECT_RADIAL_GRADIENT,
+        DL_FILL_RECT_RADIAL_GRADIENT_STOPS,
+        DL_WRITE_RECT,
+        DL_WRITE_SUBIMAGE_RECT,
+        DL_WRITE_SUBIMAGE_RECT_KEYED,
+        DL_WRITE_SUBIMAGE_RECT_BLEND,
+        DL_WRITE_RECT_8BPP,
+        DL_WRITE_RECT_8BPP_BLEND,
+        DL_WRITE_RECT_NBPP,
+        DL_DRAW_PIXEL_24BPP,
+        DL_DRAW_FAST_HLINE_24BPP,
+        DL_DRAW_FAST_VLINE_24BPP,
+        DL_FILL_RECT_24BPP,
+        DL_WRITE_RECT_24BPP,
+        DL_DRAW_BITMAP,
+        DL_DRAW_RLE_IMAGE,
+        DL_DRAW_IMAGE_SCALED,
+        DL_DRAW_IMAGE_ROTATED,
+        DL_DRAW_CHAR,
+        DL_SET_CURSOR,
+        DL_SET_TEXT_COLOR,
+        DL_SET_TEXT_COLOR_BG,
+        DL_SET_TEXT_SIZE,
+        DL_SET_TEXT_WRAP,
+        DL_SET_TEXT_DATUM,
+        DL_SET_FONT_ILI,
+        DL_SET_FONT_GFX,
+        DL_SET_FONT_RLE,
+        DL_TEXT,       // one int arg, the length, then that many bytes of text
+        DL_TEXT_STATE, // full text state, recorded when recording starts
+        DL_OP_COUNT
+    };
+
+    Teensy_Parallel_DisplayList(void *buffer, uint32_t size);
+
+    // Throw away everything recorded
+    void clear();
+    uint32_t used() { return _used; }
+    uint32_t size() { return _size; }
+    uint16_t count() { return _count; }
+    // true if a command did not fit, the list is missing everything from it on
+    bool overflow() { return _overflow; }
+
+    // Add a command, the number of args and ptrs used comes from the op.
+    bool record(uint8_t op, int16_t a0 = 0, int16_t a1 = 0, int16_t a2 = 0, int16_t a3 = 0, int16_t a4 = 0,
+                int16_t a5 = 0, int16_t a6 = 0, int16_t a7 = 0, int16_t a8 = 0, int16_t a9 = 0, int16_t a10 = 0) {
+        return recordPtr(op, nullptr, nullptr, nullptr, a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10);
+    }
+    bool recordPtr(uint8_t op, const void *p0, const void *p1, const void *p2, int16_t a0 = 0, int16_t a1 = 0,
+                   int16_t a2 = 0, int16_t a3 = 0, int16_t a4 = 0, int16_t a5 = 0, int16_t a6 = 0,
+                   int16_t a7 = 0, int16_t a8 = 0, int16_t a9 = 0, int16_t a10 = 0);
+    bool recordText(const uint8_t *text, uint16_t len);
+
+    // Walk the list: start with offset 0, returns the offset of the next command
+    // or 0 at the end.  args and ptrs must hold TPGFX_DL_MAX_ARGS / _PTRS entries,
+    // text is set for DL_TEXT.
+    uint32_t read(uint32_t offset, uint8_t &op, int16_t *args, const void **ptrs, const uint8_t **text);
+
+    // how many int16 and pointer args each op takes
+    static const uint8_t op_args[DL_OP_COUNT][2];
+
+  private:
+    uint8_t *_buffer;
+    uint32_t _size;
+    uint32_t _used = 0;
+    uint16_t _count = 0;
+    bool _overflow = false;
+};
+
+#endif
@@ -8,16 +8,16 @@
 
 void Teensy_Parallel_FB16::drawPixel(int16_t x, int16_t y, uint16_t color) {
     updateChangedRange(x, y); // update the range of the screen that has been changed;
-    _pfbtft[y * (int)_width + x] = color;
+    _pfbtft[y * (int)_stride + x] = color;
 }
 
 void Teensy_Parallel_FB16::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
     updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
 
-    uint16_t *pfb = &_pfbtft[y * (int)_width + x];
+    uint16_t *pfb = &_pfbtft[y * (int)_stride + x];
     while (h--) {
         *pfb = color;
-        pfb += _width;
+        pfb += _stride;
         y++;
     }
 }
@@ -25,7 +25,7 @@ void Teensy_Parallel_FB16::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16
 void Teensy_Parallel_FB16::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
     updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
 
-    uint16_t *pfb = &_pfbtft[y * (int)_width + x];
+    uint16_t *pfb = &_pfbtft[y * (int)_stride + x];
     while (w--) {
         *pfb++ = color;
     }
@@ -37,7 +37,7 @@ void Teensy_Parallel_FB16::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
     //Serial.printf("fillRect(%d, %d, %d, %d - %d %x)\n", x, y, w, h, color); Serial.flush();
     //Serial.printf("\t%u %u %p\n", _width, _height, _pfbtft); Serial.flush();
 
-    uint16_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     for (int16_t iy = 0; iy < h; iy++) {
         if ((y+iy) >= _height) break;
         uint16_t *pfb = pfbRow;
@@ -45,14 +45,14 @@ void Teensy_Parallel_FB16::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
             if ((x+ix) >= _width) break;
             *pfb++ = color;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
     }
 }
 
 void Teensy_Parallel_FB16::writeRect(int16_t x, int16_t y, int16_t w, int16_t h,  int16_t w_image, const uint16_t *pcolors) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
 
-    uint16_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     const uint16_t *pcolors_row = pcolors;
     for (int16_t iy = 0; iy < h; iy++) {
         if ((y+iy) >= _height) break;
@@ -62,11 +62,86 @@ void Teensy_Parallel_FB16::writeRect(int16_t x, int16_t y, int16_t w, int16_t h,
             if ((x+ix) >= _width) break;
             *pfb++ = *pcolors++;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
 
+void Teensy_Parallel_FB16::writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                   const uint16_t *pcolors, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // caller already clipped to bounds.
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    const uint16_t *pcolors_row = pcolors;
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint16_t *pfb = pfbRow;
+        pcolors = pcolors_row;
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint16_t color = *pcolors++;
+            if (color != key_color)
+                *pfb = color;
+            pfb++;
+        }
+        pfbRow += _stride; // setup for next row
+        pcolors_row += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB16::writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // Same trick as alphaBlendRGB565, G moved to the top half so all three
+    // channels blend with one multiply.
+    uint32_t alpha32 = (alpha + 4) >> 3; // 0-32
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    const uint16_t *pcolors_row = pcolors;
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint16_t *pfb = pfbRow;
+        pcolors = pcolors_row;
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint16_t color = *pcolors++;
+            if (!keyed || (color != key_color)) {
+                uint32_t fg = (color | (color << 16)) & 0b00000111111000001111100000011111;
+                uint32_t bg = (*pfb | (*pfb << 16)) & 0b00000111111000001111100000011111;
+                uint32_t result = ((((fg - bg) * alpha32) >> 5) + bg) & 0b00000111111000001111100000011111;
+                *pfb = (uint16_t)((result >> 16) | result);
+            }
+            pfb++;
+        }
+        pfbRow += _stride; // setup for next row
+        pcolors_row += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB16::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                              const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                              bool keyed, uint8_t key_index) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    uint32_t alpha32 = (alpha + 4) >> 3; // 0-32
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    const uint8_t *pixels_row = pixels;
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint16_t *pfb = pfbRow;
+        pixels = pixels_row;
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint8_t index = *pixels++;
+            if (!keyed || (index != key_index)) {
+                uint32_t color = palette[index];
+                uint32_t fg = (color | (color << 16)) & 0b00000111111000001111100000011111;
+                uint32_t bg = (*pfb | (*pfb << 16)) & 0b00000111111000001111100000011111;
+                uint32_t result = ((((fg - bg) * alpha32) >> 5) + bg) & 0b00000111111000001111100000011111;
+                *pfb = (uint16_t)((result >> 16) | result);
+            }
+            pfb++;
+        }
+        pfbRow += _stride; // setup for next row
+        pixels_row += w_image; // setup for next row.
+    }
+}
+
 void Teensy_Parallel_FB16::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, 
                                          int16_t w_image, const uint8_t *pcolors, const uint16_t *palette) {
 
@@ -74,7 +149,7 @@ void Teensy_Parallel_FB16::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_
 
     // caller already clipped to bounds.
     // also assumes that the pixels is pointing to the first output one. 
-    uint16_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     const uint8_t *pcolors_row = pcolors;
     //Serial.printf("writeRect8BPP(%d, %d, %d, %d - %d %p %p)\n", x, y, w, h, w_image, pcolors, palette); Serial.flush();
     //Serial.printf("\t%u %u %p %p\n", _width, _height, _pfbtft, pfbRow); Serial.flush();
@@ -85,7 +160,7 @@ void Teensy_Parallel_FB16::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_
         for (int16_t ix = 0; ix < w; ix++) {
             *pfb++ = palette[*pcolors++];
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
@@ -96,7 +171,7 @@ void Teensy_Parallel_FB16::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                        const uint16_t *palette) {
 
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint16_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    uint16_t *pfbPixel_row = &_pfbtft[y * _stride + x];
     uint8_t pixel_bit_mask = (1 << bits_per_pixel) - 1; // get mask to use below
     const uint8_t *pixels_row_start = pixels; // remember our starting position offset into row
     for (; h > 0; h--) {
@@ -113,7 +188,7 @@ void Teensy_Parallel_FB16::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                 pixel_shift -= bits_per_pixel;
             }
         }
-        pfbPixel_row += _width;
+        pfbPixel_row += _stride;
         pixels_row_start += count_of_bytes_per_row;
     }
 }
@@ -122,13 +197,13 @@ void Teensy_Parallel_FB16::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
 void Teensy_Parallel_FB16::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
                                    uint16_t *pcolors) {
     // Warning this one is not checking that things will fit...
-    uint16_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    uint16_t *pfbPixel_row = &_pfbtft[y * _stride + x];
     for (; h > 0; h--) {
         uint16_t *pfbPixel = pfbPixel_row;
         for (int i = 0; i < w; i++) {
             *pcolors++ = *pfbPixel++;
         }
-        pfbPixel_row += _width;
+        pfbPixel_row += _stride;
     }
 }
 
@@ -136,44 +211,36 @@ void Teensy_Parallel_FB16::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
 //=============================================================================
 // 32 bit (RGB8888) version of the Frame buffer functions
 //=============================================================================
-inline uint16_t color888To565(uint32_t color) {
-    return Teensy_Parallel_GFX::color565(color >>16, color >> 8, color);
-}
-
 void Teensy_Parallel_FB16::drawPixel24(int16_t x, int16_t y, uint32_t color) {
-    drawPixel(x, y, color888To565(color));
+    drawPixel(x, y, Teensy_Parallel_GFX::color888To565(color));
 }
 
 void Teensy_Parallel_FB16::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color) {
-    drawFastVLine(x, y, h, color888To565(color));
+    drawFastVLine(x, y, h, Teensy_Parallel_GFX::color888To565(color));
 
 }
 
 void Teensy_Parallel_FB16::drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color) {
-    drawFastHLine(x, y, w, color888To565(color));
+    drawFastHLine(x, y, w, Teensy_Parallel_GFX::color888To565(color));
 
 }
 
 void Teensy_Parallel_FB16::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
-    fillRect(x, y, w, h, color888To565(color));
+    fillRect(x, y, w, h, Teensy_Parallel_GFX::color888To565(color));
 
 }
 
 void Teensy_Parallel_FB16::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint16_t *pfbRow = &_pfbtft[y * (int)_width + x];
-    const uint32_t *pcolors_row = pcolors;
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint8_t dither = _ptpgfx->getDither();
+    int16_t err[(dither == Teensy_Parallel_Convert::DITHER_FLOYD_STEINBERG) ? 3 * (w + 2) : 1];
+    memset(err, 0, sizeof(err));
+    uint16_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        uint16_t *pfb = pfbRow;
-        pcolors = pcolors_row;
-        for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            uint32_t color = *pcolors++;
-            *pfb++ = color888To565(color);
-        }
-        pfbRow += _width; // setup for next row
-        pcolors_row += w_image; // setup for next row.
+        Teensy_Parallel_Convert::convertRowXRGBTo565Dither(pcolors, pfbRow, w, dither, x, y + iy, err);
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
     }
 }
-
@@ -3,88 +3,150 @@
 
 
 //=============================================================================
-// 16 bit version of the Frame buffer functions
+// 18 bit version of the Frame buffer functions
+// Pixels are packed 3 bytes each, R G B with the 6 bits of each channel in
+// the top of its byte, the same as panels in 18 bit mode take them over an 8
+// bit bus, so the buffer can be sent as is.
 //=============================================================================
 
-inline uint32_t color565To666(uint16_t color) {
-    //        G and B                        R
-    return ((color & 0x07FF) << 1) | ((color & 0xF800) << 2);
+static inline void put565(uint8_t *pfb, uint16_t color) {
+    pfb[0] = (color >> 8) & 0xf8;
+    pfb[1] = (color >> 3) & 0xfc;
+    pfb[2] = color << 3;
 }
 
-inline uint16_t color666To565(uint32_t color) {
-    //        G and B                        R
-    return ((color & 0x0FFF) >> 1) | ((color & 0x3E000) >> 2);
+static inline void put888(uint8_t *pfb, uint32_t color) {
+    pfb[0] = (color >> 16) & 0xfc;
+    pfb[1] = (color >> 8) & 0xfc;
+    pfb[2] = color & 0xfc;
 }
 
-inline uint32_t color888To666(uint32_t color) {
-    //             B (8->6)                G (8->6)
-    return ((color & 0xfc) >> 2) | ((color & 0xfc00) >> 4) | ((color & 0xfc0000) >> 6);
+// Blend one 565 color over the pixel, each 6 bit channel on its own
+static inline void blend565(uint8_t *pfb, uint16_t color, int a) {
+    uint8_t fg[3];
+    put565(fg, color);
+    for (int i = 0; i < 3; i++) {
+        int c_bg = pfb[i] >> 2;
+        pfb[i] = (c_bg + ((((fg[i] >> 2) - c_bg) * a) >> 8)) << 2;
+    }
 }
 
-
 void Teensy_Parallel_FB18::drawPixel(int16_t x, int16_t y, uint16_t color) {
     updateChangedRange(x, y); // update the range of the screen that has been changed;
-    // could probably will assign directly later but as an experiment.
-    _pfbtft[y * (int)_width + x] = color565To666(color);
+    put565(pixelAddress(x, y), color);
 }
 
 void Teensy_Parallel_FB18::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-    uint32_t color666 = color565To666(color);
-    uint32_t *pfb = &_pfbtft[y * (int)_width + x];
+    updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
+    uint8_t *pfb = pixelAddress(x, y);
     while (h--) {
         if (y >= _height) break;
-        *pfb = color666;
-        pfb += _width;
+        put565(pfb, color);
+        pfb += _stride * 3;
         y++;
     }
 }
 
 void Teensy_Parallel_FB18::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-    uint32_t color666 = color565To666(color);
-    uint32_t *pfb = &_pfbtft[y * (int)_width + x];
-
-    while (w--) {
-        if (x >= _width) break;
-        *pfb++ = color666;
-        x++;
-    }
+    updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
+    uint8_t color666[3];
+    put565(color666, color);
+    Teensy_Parallel_Convert::fillRow888(pixelAddress(x, y), min(w, (int16_t)(_width - x)), color666);
 }
 
 // 
 void Teensy_Parallel_FB18::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint32_t color666 = color565To666(color);
-    //Serial.printf("FillRect(%d,%d,%d,%d, %x): %u %x %x %x\n", x, y, w, h, color, sizeof(color24), color24.r, color24.g, color24.b);
-    uint32_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint8_t color666[3];
+    put565(color666, color);
+    //Serial.printf("FillRect(%d,%d,%d,%d, %x)\n", x, y, w, h, color);
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint8_t *pfbRow = pixelAddress(x, y);
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        uint32_t *pfb = pfbRow;
+        Teensy_Parallel_Convert::fillRow888(pfbRow, w, color666);
+        pfbRow += _stride * 3; // setup for next row
+    }
+}
+
+void Teensy_Parallel_FB18::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint8_t *pfbRow = pixelAddress(x, y);
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRow565To888(pcolors, pfbRow, w); // 565 fits in 666 as is
+        pfbRow += _stride * 3; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB18::writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                   const uint16_t *pcolors, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // caller already clipped to bounds.
+    uint8_t *pfbRow = pixelAddress(x, y);
+    const uint16_t *pcolors_row = pcolors;
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint8_t *pfb = pfbRow;
+        pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = color666;
+            uint16_t color = *pcolors++;
+            if (color != key_color)
+                put565(pfb, color);
+            pfb += 3;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride * 3; // setup for next row
+        pcolors_row += w_image; // setup for next row.
     }
 }
 
-void Teensy_Parallel_FB18::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors) {
+void Teensy_Parallel_FB18::writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
 
-    uint32_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    // Each 6 bit channel is blended on its own, in the buffer's precision
+    int a = alpha + (alpha >> 7); // 0-256
+    uint8_t *pfbRow = pixelAddress(x, y);
     const uint16_t *pcolors_row = pcolors;
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        uint32_t *pfb = pfbRow;
+        uint8_t *pfb = pfbRow;
         pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
             uint16_t color = *pcolors++;
-            *pfb++ = color565To666(color);
+            if (!keyed || (color != key_color))
+                blend565(pfb, color, a);
+            pfb += 3;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride * 3; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
 
+void Teensy_Parallel_FB18::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                              const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                              bool keyed, uint8_t key_index) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    int a = alpha + (alpha >> 7); // 0-256
+    uint8_t *pfbRow = pixelAddress(x, y);
+    const uint8_t *pixels_row = pixels;
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint8_t *pfb = pfbRow;
+        pixels = pixels_row;
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint8_t index = *pixels++;
+            if (!keyed || (index != key_index))
+                blend565(pfb, palette[index], a);
+            pfb += 3;
+        }
+        pfbRow += _stride * 3; // setup for next row
+        pixels_row += w_image; // setup for next row.
+    }
+}
+
 void Teensy_Parallel_FB18::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, 
                                          int16_t w_image, const uint8_t *pcolors, const uint16_t *palette) {
 
@@ -92,19 +154,18 @@ void Teensy_Parallel_FB18::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_
 
     // caller already clipped to bounds.
     // also assumes that the pixels is pointing to the first output one. 
-    uint32_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint8_t *pfbRow = pixelAddress(x, y);
     const uint8_t *pcolors_row = pcolors;
     //Serial.printf("writeRect8BPP(%d, %d, %d, %d - %d %p %p)\n", x, y, w, h, w_image, pcolors, palette); Serial.flush();
-    //Serial.printf("\t%u %u %p %p\n", _width, _height, _pfbtft, pfbRow); Serial.flush();
     
     for (int16_t iy = 0; iy < h; iy++) {
-        uint32_t *pfb = pfbRow;
+        uint8_t *pfb = pfbRow;
         pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            uint16_t color = palette[*pcolors++];
-            *pfb++ = color565To666(color);
+            put565(pfb, palette[*pcolors++]);
+            pfb += 3;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride * 3; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
@@ -115,17 +176,17 @@ void Teensy_Parallel_FB18::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                        const uint16_t *palette) {
 
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint32_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    uint8_t *pfbPixel_row = pixelAddress(x, y);
     uint8_t pixel_bit_mask = (1 << bits_per_pixel) - 1; // get mask to use below
     const uint8_t *pixels_row_start = pixels; // remember our starting position offset into row
     for (; h > 0; h--) {
-        uint32_t *pfbPixel = pfbPixel_row;
+        uint8_t *pfbPixel = pfbPixel_row;
         pixels = pixels_row_start;            // setup for this row
         uint8_t pixel_shift = row_shift_init; // Setup mask
 
         for (int i = 0; i < w; i++) {
-            uint16_t color = palette[((*pixels) >> pixel_shift) & pixel_bit_mask];
-            *pfbPixel++ = color565To666(color);
+            put565(pfbPixel, palette[((*pixels) >> pixel_shift) & pixel_bit_mask]);
+            pfbPixel += 3;
             if (!pixel_shift) {
                 pixel_shift = 8 - bits_per_pixel; // setup next mask
                 pixels++;
@@ -133,7 +194,7 @@ void Teensy_Parallel_FB18::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                 pixel_shift -= bits_per_pixel;
             }
         }
-        pfbPixel_row += _width;
+        pfbPixel_row += _stride * 3;
         pixels_row_start += count_of_bytes_per_row;
     }
 }
@@ -141,14 +202,11 @@ void Teensy_Parallel_FB18::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
 void Teensy_Parallel_FB18::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
                                    uint16_t *pcolors) {
     // Warning this one is not checking that things will fit...
-    uint32_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    const uint8_t *pfbPixel_row = pixelAddress(x, y);
     for (; h > 0; h--) {
-        uint32_t *pfbPixel = pfbPixel_row;
-        for (int i = 0; i < w; i++) {
-            *pcolors++ = color666To565(*pfbPixel);
-            pfbPixel++;
-        }
-        pfbPixel_row += _width;
+        Teensy_Parallel_Convert::convertRow888To565(pfbPixel_row, pcolors, w);
+        pcolors += w;
+        pfbPixel_row += _stride * 3;
     }
 }
 
@@ -159,19 +217,17 @@ void Teensy_Parallel_FB18::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
 
 void Teensy_Parallel_FB18::drawPixel24(int16_t x, int16_t y, uint32_t color) {
     updateChangedRange(x, y); // update the range of the screen that has been changed;
-    // could probably will assign directly later but as an experiment.
-    _pfbtft[y * (int)_width + x] = color888To666(color);
+    put888(pixelAddress(x, y), color);
 }
 
 void Teensy_Parallel_FB18::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color) {
     updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
 
-    uint32_t color18 = color888To666(color);
-    uint32_t *pfb = &_pfbtft[y * (int)_width + x];
+    uint8_t *pfb = pixelAddress(x, y);
     while (h--) {
         if (y >= _height) break;
-        *pfb = color18;
-        pfb += _width;
+        put888(pfb, color);
+        pfb += _stride * 3;
         y++;
     }
 
@@ -180,47 +236,32 @@ void Teensy_Parallel_FB18::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint
 void Teensy_Parallel_FB18::drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color) {
     updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
 
-    uint32_t color18 = color888To666(color);
-    uint32_t *pfb = &_pfbtft[y * (int)_width + x];
-
-    while (w--) {
-        if (x >= _width) break;
-        *pfb = color18;
-        x++;
-    }
-
+    uint8_t color666[3];
+    put888(color666, color);
+    Teensy_Parallel_Convert::fillRow888(pixelAddress(x, y), min(w, (int16_t)(_width - x)), color666);
 }
 
 void Teensy_Parallel_FB18::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint32_t color18 = color888To666(color);
-    Serial.printf("FillRect24(%d,%d,%d,%d, %x): %x\n", x, y, w, h, color, color18);
-    uint32_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    uint8_t color666[3];
+    put888(color666, color);
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint8_t *pfbRow = pixelAddress(x, y);
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        uint32_t *pfb = pfbRow;
-        for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = color18;
-        }
-        pfbRow += _width; // setup for next row
+        Teensy_Parallel_Convert::fillRow888(pfbRow, w, color666);
+        pfbRow += _stride * 3; // setup for next row
     }
 }
 
 void Teensy_Parallel_FB18::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    uint32_t *pfbRow = &_pfbtft[y * (int)_width + x];
-    const uint32_t *pcolors_row = pcolors;
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint8_t *pfbRow = pixelAddress(x, y);
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        uint32_t *pfb = pfbRow;
-        pcolors = pcolors_row;
-        for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = color888To666(*pcolors++);
-        }
-        pfbRow += _width; // setup for next row
-        pcolors_row += w_image; // setup for next row.
+        Teensy_Parallel_Convert::convertRowXRGBTo666(pcolors, pfbRow, w);
+        pfbRow += _stride * 3; // setup for next row
+        pcolors += w_image; // setup for next row.
     }
 }
-
@@ -6,15 +6,6 @@
 // 16 bit version of the Frame buffer functions
 //=============================================================================
 
-inline uint32_t color565To888(uint16_t color) {
-    uint8_t r, g, b;
-    Teensy_Parallel_GFX::color565toRGB(color, r, g, b);
-    if (r) r |= 0x7;
-    if (g) g |= 0x3;
-    if (b) b |= 0x7;
-    return 0xff000000 | (r << 16) | (g << 8) | b;
-}
-
 inline Teensy_Parallel_FB24::RGB24_t RGB888ToRGB24(uint32_t color) {
     Teensy_Parallel_FB24::RGB24_t color24;
     color24.r = color >> 16;
@@ -34,79 +25,138 @@ inline Teensy_Parallel_FB24::RGB24_t RGB565ToRGB24(uint16_t color) {
 void Teensy_Parallel_FB24::drawPixel(int16_t x, int16_t y, uint16_t color) {
     updateChangedRange(x, y); // update the range of the screen that has been changed;
     // could probably will assign directly later but as an experiment.
-    _pfbtft[y * (int)_width + x] = RGB565ToRGB24(color);
+    _pfbtft[y * (int)_stride + x] = RGB565ToRGB24(color);
 }
 
 void Teensy_Parallel_FB24::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
     RGB24_t color24 = RGB565ToRGB24(color);
-    RGB24_t *pfb = &_pfbtft[y * (int)_width + x];
+    RGB24_t *pfb = &_pfbtft[y * (int)_stride + x];
     while (h--) {
         if (y >= _height) break;
         *pfb = color24;
-        pfb += _width;
+        pfb += _stride;
         y++;
     }
 }
 
 void Teensy_Parallel_FB24::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
     RGB24_t color24 = RGB565ToRGB24(color);
-    RGB24_t *pfb = &_pfbtft[y * (int)_width + x];
-
-    while (w--) {
-        if (x >= _width) break;
-        *pfb++ = color24;
-        x++;
-    }
+    Teensy_Parallel_Convert::fillRow888((uint8_t *)&_pfbtft[y * (int)_stride + x], min(w, (int16_t)(_width - x)), &color24.r);
 }
 
-// 
+//
 void Teensy_Parallel_FB24::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
     RGB24_t color24 = RGB565ToRGB24(color);
     //Serial.printf("FillRect(%d,%d,%d,%d, %x): %u %x %x %x\n", x, y, w, h, color, sizeof(color24), color24.r, color24.g, color24.b);
-    RGB24_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::fillRow888((uint8_t *)pfbRow, w, &color24.r);
+        pfbRow += _stride; // setup for next row
+    }
+}
+
+void Teensy_Parallel_FB24::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRow565To888(pcolors, (uint8_t *)pfbRow, w);
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB24::writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                   const uint16_t *pcolors, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // caller already clipped to bounds.
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    const uint16_t *pcolors_row = pcolors;
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
         RGB24_t *pfb = pfbRow;
+        pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = color24;
+            uint16_t color = *pcolors++;
+            if (color != key_color)
+                Teensy_Parallel_GFX::color565toRGB(color, pfb->r, pfb->g, pfb->b);
+            pfb++;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
+        pcolors_row += w_image; // setup for next row.
     }
 }
 
-void Teensy_Parallel_FB24::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors) {
+void Teensy_Parallel_FB24::writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
 
-    RGB24_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    // Each 8 bit channel is blended on its own, in the buffer's precision
+    int a = alpha + (alpha >> 7); // 0-256
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     const uint16_t *pcolors_row = pcolors;
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
         RGB24_t *pfb = pfbRow;
         pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
             uint16_t color = *pcolors++;
-            Teensy_Parallel_GFX::color565toRGB(color, pfb->r, pfb->g, pfb->b);
+            if (!keyed || (color != key_color)) {
+                uint8_t r, g, b;
+                Teensy_Parallel_GFX::color565toRGB(color, r, g, b);
+                pfb->r += ((r - pfb->r) * a) >> 8;
+                pfb->g += ((g - pfb->g) * a) >> 8;
+                pfb->b += ((b - pfb->b) * a) >> 8;
+            }
             pfb++;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
 
-void Teensy_Parallel_FB24::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, 
+void Teensy_Parallel_FB24::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                              const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                              bool keyed, uint8_t key_index) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    int a = alpha + (alpha >> 7); // 0-256
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    const uint8_t *pixels_row = pixels;
+    for (int16_t iy = 0; iy < h; iy++) {
+        RGB24_t *pfb = pfbRow;
+        pixels = pixels_row;
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint8_t index = *pixels++;
+            if (!keyed || (index != key_index)) {
+                uint8_t r, g, b;
+                Teensy_Parallel_GFX::color565toRGB(palette[index], r, g, b);
+                pfb->r += ((r - pfb->r) * a) >> 8;
+                pfb->g += ((g - pfb->g) * a) >> 8;
+                pfb->b += ((b - pfb->b) * a) >> 8;
+            }
+            pfb++;
+        }
+        pfbRow += _stride; // setup for next row
+        pixels_row += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB24::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h,
                                          int16_t w_image, const uint8_t *pcolors, const uint16_t *palette) {
 
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
 
     // caller already clipped to bounds.
-    // also assumes that the pixels is pointing to the first output one. 
-    RGB24_t *pfbRow = &_pfbtft[y * (int)_width + x];
+    // also assumes that the pixels is pointing to the first output one.
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     const uint8_t *pcolors_row = pcolors;
     //Serial.printf("writeRect8BPP(%d, %d, %d, %d - %d %p %p)\n", x, y, w, h, w_image, pcolors, palette); Serial.flush();
-    //Serial.printf("\t%u %u %p %p\n", _width, _height, _pfbtft, pfbRow); Serial.flush();
-    
+
     for (int16_t iy = 0; iy < h; iy++) {
         RGB24_t *pfb = pfbRow;
         pcolors = pcolors_row;
@@ -115,7 +165,7 @@ void Teensy_Parallel_FB24::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_
             Teensy_Parallel_GFX::color565toRGB(color, pfb->r, pfb->g, pfb->b);
             pfb++;
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
         pcolors_row += w_image; // setup for next row.
     }
 }
@@ -126,7 +176,7 @@ void Teensy_Parallel_FB24::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                        const uint16_t *palette) {
 
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    RGB24_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    RGB24_t *pfbPixel_row = &_pfbtft[y * _stride + x];
     uint8_t pixel_bit_mask = (1 << bits_per_pixel) - 1; // get mask to use below
     const uint8_t *pixels_row_start = pixels; // remember our starting position offset into row
     for (; h > 0; h--) {
@@ -145,7 +195,7 @@ void Teensy_Parallel_FB24::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
                 pixel_shift -= bits_per_pixel;
             }
         }
-        pfbPixel_row += _width;
+        pfbPixel_row += _stride;
         pixels_row_start += count_of_bytes_per_row;
     }
 }
@@ -153,14 +203,11 @@ void Teensy_Parallel_FB24::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_
 void Teensy_Parallel_FB24::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
                                    uint16_t *pcolors) {
     // Warning this one is not checking that things will fit...
-    RGB24_t *pfbPixel_row = &_pfbtft[y * _width + x];
+    RGB24_t *pfbPixel_row = &_pfbtft[y * _stride + x];
     for (; h > 0; h--) {
-        RGB24_t *pfbPixel = pfbPixel_row;
-        for (int i = 0; i < w; i++) {
-            *pcolors++ = Teensy_Parallel_GFX::color565(pfbPixel->r, pfbPixel->g, pfbPixel->b);
-            pfbPixel++;
-        }
-        pfbPixel_row += _width;
+        Teensy_Parallel_Convert::convertRow888To565((const uint8_t *)pfbPixel_row, pcolors, w);
+        pcolors += w;
+        pfbPixel_row += _stride;
     }
 }
 
@@ -172,7 +219,7 @@ void Teensy_Parallel_FB24::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
 void Teensy_Parallel_FB24::drawPixel24(int16_t x, int16_t y, uint32_t color) {
     updateChangedRange(x, y); // update the range of the screen that has been changed;
     // could probably will assign directly later but as an experiment.
-    RGB24_t *pfb = &_pfbtft[y * (int)_width + x];
+    RGB24_t *pfb = &_pfbtft[y * (int)_stride + x];
     *pfb = RGB888ToRGB24(color);
 }
 
@@ -180,11 +227,11 @@ void Teensy_Parallel_FB24::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint
     updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
 
     RGB24_t color24 = RGB888ToRGB24(color);
-    RGB24_t *pfb = &_pfbtft[y * (int)_width + x];
+    RGB24_t *pfb = &_pfbtft[y * (int)_stride + x];
     while (h--) {
         if (y >= _height) break;
         *pfb = color24;
-        pfb += _width;
+        pfb += _stride;
         y++;
     }
 
@@ -194,46 +241,242 @@ void Teensy_Parallel_FB24::drawFastHLine24(int16_t x, int16_t y, int16_t w, uint
     updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
 
     RGB24_t color24 = RGB888ToRGB24(color);
-    RGB24_t *pfb = &_pfbtft[y * (int)_width + x];
+    Teensy_Parallel_Convert::fillRow888((uint8_t *)&_pfbtft[y * (int)_stride + x], min(w, (int16_t)(_width - x)), &color24.r);
+}
 
-    while (w--) {
-        if (x >= _width) break;
-        *pfb++ = color24;
-        x++;
+void Teensy_Parallel_FB24::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    RGB24_t color24 = RGB888ToRGB24(color);
+    //Serial.printf("FillRect24(%d,%d,%d,%d, %x): %u %x %x %x\n", x, y, w, h, color, sizeof(color24), color24.r, color24.g, color24.b);
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::fillRow888((uint8_t *)pfbRow, w, &color24.r);
+        pfbRow += _stride; // setup for next row
     }
+}
 
+void Teensy_Parallel_FB24::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    RGB24_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRowXRGBTo888(pcolors, (uint8_t *)pfbRow, w);
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
 }
 
-void Teensy_Parallel_FB24::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+
+//=============================================================================
+// XRGB8888 frame buffer, one aligned uint32 per pixel
+//=============================================================================
+
+static inline uint32_t color565ToXRGB(uint16_t color) {
+    return ((color & 0xf800) << 8) | ((color & 0x7e0) << 5) | ((color & 0x1f) << 3);
+}
+
+// Blend a 565 color over a pixel, red and blue are done together in one
+// multiply and green in another.  a is 0-256.
+static inline uint32_t blendXRGB(uint32_t bg, uint16_t color, uint32_t a) {
+    uint32_t fg = color565ToXRGB(color);
+    uint32_t rb = ((fg & 0xff00ff) * a + (bg & 0xff00ff) * (256 - a)) >> 8;
+    uint32_t g = ((fg & 0xff00) * a + (bg & 0xff00) * (256 - a)) >> 8;
+    return (rb & 0xff00ff) | (g & 0xff00);
+}
+
+static inline void fillRowXRGB(uint32_t *pfb, int16_t w, uint32_t color) {
+    for (; w >= 4; w -= 4) {
+        pfb[0] = color;
+        pfb[1] = color;
+        pfb[2] = color;
+        pfb[3] = color;
+        pfb += 4;
+    }
+    while (w-- > 0)
+        *pfb++ = color;
+}
+
+void Teensy_Parallel_FB32::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    updateChangedRange(x, y); // update the range of the screen that has been changed;
+    _pfbtft[y * (int)_stride + x] = color565ToXRGB(color);
+}
+
+void Teensy_Parallel_FB32::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    drawFastVLine24(x, y, h, color565ToXRGB(color));
+}
+
+void Teensy_Parallel_FB32::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    drawFastHLine24(x, y, w, color565ToXRGB(color));
+}
+
+void Teensy_Parallel_FB32::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillRect24(x, y, w, h, color565ToXRGB(color));
+}
+
+void Teensy_Parallel_FB32::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    RGB24_t color24 = RGB888ToRGB24(color);
-    Serial.printf("FillRect24(%d,%d,%d,%d, %x): %u %x %x %x\n", x, y, w, h, color, sizeof(color24), color24.r, color24.g, color24.b);
-    RGB24_t *pfbRow = &_pfbtft[y * (int)_width + x];
+
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRow565ToXRGB(pcolors, pfbRow, w);
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB32::writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // caller already clipped to bounds.
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        RGB24_t *pfb = pfbRow;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = color24;
+            uint16_t color = pcolors[ix];
+            if (color != key_color)
+                pfbRow[ix] = color565ToXRGB(color);
         }
-        pfbRow += _width; // setup for next row
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
     }
 }
 
-void Teensy_Parallel_FB24::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) {
+void Teensy_Parallel_FB32::writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color) {
     updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
-    RGB24_t *pfbRow = &_pfbtft[y * (int)_width + x];
-    const uint32_t *pcolors_row = pcolors;
+
+    uint32_t a = alpha + (alpha >> 7); // 0-256
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
     for (int16_t iy = 0; iy < h; iy++) {
-        if ((y+iy) >= _height) break;
-        RGB24_t *pfb = pfbRow;
-        pcolors = pcolors_row;
         for (int16_t ix = 0; ix < w; ix++) {
-            if ((x+ix) >= _width) break;
-            *pfb++ = RGB888ToRGB24(*pcolors++);
+            uint16_t color = pcolors[ix];
+            if (!keyed || (color != key_color))
+                pfbRow[ix] = blendXRGB(pfbRow[ix], color, a);
         }
-        pfbRow += _width; // setup for next row
-        pcolors_row += w_image; // setup for next row.
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB32::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                              const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                              bool keyed, uint8_t key_index) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    uint32_t a = alpha + (alpha >> 7); // 0-256
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint8_t index = pixels[ix];
+            if (!keyed || (index != key_index))
+                pfbRow[ix] = blendXRGB(pfbRow[ix], palette[index], a);
+        }
+        pfbRow += _stride; // setup for next row
+        pixels += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB32::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h,
+                                         int16_t w_image, const uint8_t *pixels, const uint16_t *palette) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+
+    // caller already clipped to bounds.
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        for (int16_t ix = 0; ix < w; ix++)
+            pfbRow[ix] = color565ToXRGB(palette[pixels[ix]]);
+        pfbRow += _stride; // setup for next row
+        pixels += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FB32::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t h,
+                       uint8_t bits_per_pixel, uint16_t count_of_bytes_per_row, uint8_t row_shift_init,
+                       const uint8_t *pixels,
+                       const uint16_t *palette) {
+
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint32_t *pfbPixel_row = &_pfbtft[y * _stride + x];
+    uint8_t pixel_bit_mask = (1 << bits_per_pixel) - 1; // get mask to use below
+    const uint8_t *pixels_row_start = pixels; // remember our starting position offset into row
+    for (; h > 0; h--) {
+        uint32_t *pfbPixel = pfbPixel_row;
+        pixels = pixels_row_start;            // setup for this row
+        uint8_t pixel_shift = row_shift_init; // Setup mask
+
+        for (int i = 0; i < w; i++) {
+            *pfbPixel++ = color565ToXRGB(palette[((*pixels) >> pixel_shift) & pixel_bit_mask]);
+            if (!pixel_shift) {
+                pixel_shift = 8 - bits_per_pixel; // setup next mask
+                pixels++;
+            } else {
+                pixel_shift -= bits_per_pixel;
+            }
+        }
+        pfbPixel_row += _stride;
+        pixels_row_start += count_of_bytes_per_row;
+    }
+}
+
+void Teensy_Parallel_FB32::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                    uint16_t *pcolors) {
+    // Warning this one is not checking that things will fit...
+    const uint32_t *pfbPixel_row = &_pfbtft[y * _stride + x];
+    for (; h > 0; h--) {
+        Teensy_Parallel_Convert::convertRowXRGBTo565(pfbPixel_row, pcolors, w);
+        pcolors += w;
+        pfbPixel_row += _stride;
+    }
+}
+
+void Teensy_Parallel_FB32::drawPixel24(int16_t x, int16_t y, uint32_t color) {
+    updateChangedRange(x, y); // update the range of the screen that has been changed;
+    _pfbtft[y * (int)_stride + x] = color;
+}
+
+void Teensy_Parallel_FB32::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color) {
+    updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
+
+    uint32_t *pfb = &_pfbtft[y * (int)_stride + x];
+    h = min(h, (int16_t)(_height - y));
+    while (h-- > 0) {
+        *pfb = color;
+        pfb += _stride;
     }
 }
 
+void Teensy_Parallel_FB32::drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color) {
+    updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
+    fillRowXRGB(&_pfbtft[y * (int)_stride + x], min(w, (int16_t)(_width - x)), color);
+}
+
+void Teensy_Parallel_FB32::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        fillRowXRGB(pfbRow, w, color);
+        pfbRow += _stride; // setup for next row
+    }
+}
+
+// Already in the buffer's format, just a copy a row at a time
+void Teensy_Parallel_FB32::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    w = min(w, (int16_t)(_width - x));
+    h = min(h, (int16_t)(_height - y));
+    if (w <= 0)
+        return;
+    uint32_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        memcpy(pfbRow, pcolors, w * sizeof(uint32_t));
+        pfbRow += _stride; // setup for next row
+        pcolors += w_image; // setup for next row.
+    }
+}
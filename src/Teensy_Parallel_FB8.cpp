@@ -0,0 +1,302 @@
+
+#include "Teensy_Parallel_GFX.h"
+
+//=============================================================================
+// Palette (8 and 4 bit) versions of the Frame buffer functions.  The common
+// code works a row of palette indices at a time, the 8 and 4 bit versions
+// just store and fetch those rows.
+//=============================================================================
+
+// The 16 VGA colors
+static const uint16_t default_palette16[16] = {
+    0x0000, 0x0015, 0x0540, 0x0555, 0xA800, 0xA815, 0xAAA0, 0xAD55,
+    0x52AA, 0x52BF, 0x57EA, 0x57FF, 0xFAAA, 0xFABF, 0xFFEA, 0xFFFF};
+// RGB332, filled in the first time it is used
+static uint16_t default_palette256[256];
+static bool default_palette256_init = false;
+
+static inline uint16_t blend565(uint32_t fg, uint32_t bg, uint32_t alpha32) {
+    fg = (fg | (fg << 16)) & 0b00000111111000001111100000011111;
+    bg = (bg | (bg << 16)) & 0b00000111111000001111100000011111;
+    uint32_t result = ((((fg - bg) * alpha32) >> 5) + bg) & 0b00000111111000001111100000011111;
+    return (uint16_t)((result >> 16) | result);
+}
+
+void Teensy_Parallel_FBPalette::setPalette(const uint16_t *palette) {
+    if (!palette) {
+        if (_palette_size == 16) {
+            palette = default_palette16;
+        } else {
+            if (!default_palette256_init) {
+                for (int i = 0; i < 256; i++)
+                    default_palette256[i] = Teensy_Parallel_GFX::color565((i & 0xe0) * 255 / 0xe0,
+                                                                          ((i << 3) & 0xe0) * 255 / 0xe0,
+                                                                          (i & 0x3) * 85);
+                default_palette256_init = true;
+            }
+            palette = default_palette256;
+        }
+    }
+    _palette = palette;
+    _last_valid = false;
+}
+
+// Closest palette entry, by the sum of the squared channel differences with
+// red and blue scaled up to 6 bits like green.
+uint8_t Teensy_Parallel_FBPalette::colorIndex(uint16_t color) {
+    if (_last_valid && (color == _last_color))
+        return _last_index;
+    int r = (color >> 10) & 0x3e;
+    int g = (color >> 5) & 0x3f;
+    int b = (color << 1) & 0x3e;
+    uint32_t best_distance = 0xffffffff;
+    uint8_t best = 0;
+    for (uint16_t i = 0; i < _palette_size; i++) {
+        uint16_t pcolor = _palette[i];
+        if (pcolor == color) {
+            best = i;
+            break;
+        }
+        int dr = r - ((pcolor >> 10) & 0x3e);
+        int dg = g - ((pcolor >> 5) & 0x3f);
+        int db = b - ((pcolor << 1) & 0x3e);
+        uint32_t distance = dr * dr + dg * dg + db * db;
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    _last_color = color;
+    _last_index = best;
+    _last_valid = true;
+    return best;
+}
+
+void Teensy_Parallel_FBPalette::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    updateChangedRange(x, y); // update the range of the screen that has been changed;
+    fillIndex(x, y, 1, 1, colorIndex(color));
+}
+
+void Teensy_Parallel_FBPalette::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    updateChangedRange(x, y, 1, h); // update the range of the screen that has been changed;
+    fillIndex(x, y, 1, h, colorIndex(color));
+}
+
+void Teensy_Parallel_FBPalette::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    updateChangedRange(x, y, w, 1); // update the range of the screen that has been changed;
+    fillIndex(x, y, w, 1, colorIndex(color));
+}
+
+void Teensy_Parallel_FBPalette::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    fillIndex(x, y, w, h, colorIndex(color));
+}
+
+void Teensy_Parallel_FBPalette::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                          const uint16_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        for (int16_t ix = 0; ix < w; ix++)
+            indices[ix] = colorIndex(pcolors[ix]);
+        writeIndexRow(x, y + iy, w, indices);
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FBPalette::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) {
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        readIndexRow(x, y + iy, w, indices);
+        for (int16_t ix = 0; ix < w; ix++)
+            *pcolors++ = _palette[indices[ix]];
+    }
+}
+
+void Teensy_Parallel_FBPalette::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                              const uint8_t *pixels, const uint16_t *palette) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        if (palette == _palette) {
+            // Same palette, the pixels already are indices
+            writeIndexRow(x, y + iy, w, pixels);
+        } else {
+            for (int16_t ix = 0; ix < w; ix++)
+                indices[ix] = colorIndex(palette[pixels[ix]]);
+            writeIndexRow(x, y + iy, w, indices);
+        }
+        pixels += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FBPalette::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t h,
+                                              uint8_t bits_per_pixel, uint16_t count_of_bytes_per_row,
+                                              uint8_t row_shift_init, const uint8_t *pixels,
+                                              const uint16_t *palette) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint8_t pixel_bit_mask = (1 << bits_per_pixel) - 1; // get mask to use below
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        const uint8_t *p = pixels;
+        uint8_t pixel_shift = row_shift_init; // Setup mask
+        for (int16_t ix = 0; ix < w; ix++) {
+            uint8_t index = ((*p) >> pixel_shift) & pixel_bit_mask;
+            indices[ix] = (palette == _palette) ? index : colorIndex(palette[index]);
+            if (!pixel_shift) {
+                pixel_shift = 8 - bits_per_pixel; // setup next mask
+                p++;
+            } else {
+                pixel_shift -= bits_per_pixel;
+            }
+        }
+        writeIndexRow(x, y + iy, w, indices);
+        pixels += count_of_bytes_per_row;
+    }
+}
+
+void Teensy_Parallel_FBPalette::drawPixel24(int16_t x, int16_t y, uint32_t color) {
+    drawPixel(x, y, Teensy_Parallel_GFX::color888To565(color));
+}
+
+void Teensy_Parallel_FBPalette::drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color) {
+    drawFastVLine(x, y, h, Teensy_Parallel_GFX::color888To565(color));
+}
+
+void Teensy_Parallel_FBPalette::drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color) {
+    drawFastHLine(x, y, w, Teensy_Parallel_GFX::color888To565(color));
+}
+
+void Teensy_Parallel_FBPalette::fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    fillRect(x, y, w, h, Teensy_Parallel_GFX::color888To565(color));
+}
+
+void Teensy_Parallel_FBPalette::writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                            const uint32_t *pcolors) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        for (int16_t ix = 0; ix < w; ix++)
+            indices[ix] = colorIndex(Teensy_Parallel_GFX::color888To565(pcolors[ix]));
+        writeIndexRow(x, y + iy, w, indices);
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FBPalette::writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                               const uint16_t *pcolors, uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        readIndexRow(x, y + iy, w, indices);
+        for (int16_t ix = 0; ix < w; ix++) {
+            if (pcolors[ix] != key_color)
+                indices[ix] = colorIndex(pcolors[ix]);
+        }
+        writeIndexRow(x, y + iy, w, indices);
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+// Blending is done on the palette colors and the result mapped back, so it
+// can only be as good as the palette.
+void Teensy_Parallel_FBPalette::writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                               const uint16_t *pcolors, uint8_t alpha, bool keyed,
+                                               uint16_t key_color) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint32_t alpha32 = (alpha + 4) >> 3; // 0-32
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        readIndexRow(x, y + iy, w, indices);
+        for (int16_t ix = 0; ix < w; ix++) {
+            if (!keyed || (pcolors[ix] != key_color))
+                indices[ix] = colorIndex(blend565(pcolors[ix], _palette[indices[ix]], alpha32));
+        }
+        writeIndexRow(x, y + iy, w, indices);
+        pcolors += w_image; // setup for next row.
+    }
+}
+
+void Teensy_Parallel_FBPalette::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                                   const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                                   bool keyed, uint8_t key_index) {
+    updateChangedRange(x, y, w, h); // update the range of the screen that has been changed;
+    uint32_t alpha32 = (alpha + 4) >> 3; // 0-32
+    uint8_t indices[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        readIndexRow(x, y + iy, w, indices);
+        for (int16_t ix = 0; ix < w; ix++) {
+            if (!keyed || (pixels[ix] != key_index))
+                indices[ix] = colorIndex(blend565(palette[pixels[ix]], _palette[indices[ix]], alpha32));
+        }
+        writeIndexRow(x, y + iy, w, indices);
+        pixels += w_image; // setup for next row.
+    }
+}
+
+//=============================================================================
+// 8 bit, one byte per pixel
+//=============================================================================
+void Teensy_Parallel_FB8::fillIndex(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) {
+    uint8_t *pfbRow = &_pfbtft[y * (int)_stride + x];
+    for (int16_t iy = 0; iy < h; iy++) {
+        memset(pfbRow, index, w);
+        pfbRow += _stride; // setup for next row
+    }
+}
+
+void Teensy_Parallel_FB8::writeIndexRow(int16_t x, int16_t y, int16_t w, const uint8_t *indices) {
+    memcpy(&_pfbtft[y * (int)_stride + x], indices, w);
+}
+
+void Teensy_Parallel_FB8::readIndexRow(int16_t x, int16_t y, int16_t w, uint8_t *indices) {
+    memcpy(indices, &_pfbtft[y * (int)_stride + x], w);
+}
+
+//=============================================================================
+// 4 bit, two pixels per byte
+//=============================================================================
+void Teensy_Parallel_FB4::fillIndex(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) {
+    index &= 0xf;
+    int row_bytes = (_stride + 1) >> 1;
+    uint8_t *pfbRow = &_pfbtft[y * row_bytes + (x >> 1)];
+    for (int16_t iy = 0; iy < h; iy++) {
+        uint8_t *pfb = pfbRow;
+        int16_t ix = x;
+        int16_t count = w;
+        if (ix & 1) {
+            // odd start, low nibble of the first byte
+            *pfb = (*pfb & 0xf0) | index;
+            pfb++;
+            count--;
+        }
+        memset(pfb, index | (index << 4), count >> 1);
+        if (count & 1) {
+            pfb += count >> 1;
+            *pfb = (*pfb & 0x0f) | (index << 4);
+        }
+        pfbRow += row_bytes; // setup for next row
+    }
+}
+
+void Teensy_Parallel_FB4::writeIndexRow(int16_t x, int16_t y, int16_t w, const uint8_t *indices) {
+    uint8_t *pfb = &_pfbtft[y * ((_stride + 1) >> 1) + (x >> 1)];
+    for (int16_t i = 0; i < w; i++, x++) {
+        if (x & 1) {
+            *pfb = (*pfb & 0xf0) | (indices[i] & 0xf);
+            pfb++;
+        } else {
+            *pfb = (*pfb & 0x0f) | (indices[i] << 4);
+        }
+    }
+}
+
+void Teensy_Parallel_FB4::readIndexRow(int16_t x, int16_t y, int16_t w, uint8_t *indices) {
+    const uint8_t *pfb = &_pfbtft[y * ((_stride + 1) >> 1) + (x >> 1)];
+    for (int16_t i = 0; i < w; i++, x++) {
+        if (x & 1)
+            indices[i] = *pfb++ & 0xf;
+        else
+            indices[i] = *pfb >> 4;
+    }
+}
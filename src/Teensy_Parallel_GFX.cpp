@@ -23,6 +23,8 @@
 //----------------
 //		fillRectVGradient	- fills area with vertical gradient
 //		fillRectHGradient	- fills area with horizontal gradient
+//		fillRectLinearGradient - fills area with a multi color gradient
+//		fillRectRadialGradient - fills area with a gradient around a point
 //		fillScreenVGradient - fills screen with vertical gradient
 //  	fillScreenHGradient - fills screen with horizontal gradient
 
@@ -38,6 +40,7 @@
 //  		writeRect4BPP - 	write 4 bit per pixel paletted bitmap
 //  		writeRect2BPP - 	write 2 bit per pixel paletted bitmap
 //  		writeRect1BPP - 	write 1 bit per pixel paletted bitmap
+//  		drawRLEImage - 	draw a run length encoded image with transparency
 
 // TODO: transparent bitmap writing routines for sprites
 
@@ -83,9 +86,34 @@ POSSIBILITY OF SUCH DAMAGE.
 // #include "glcdfont.c"
 
 #include "Teensy_Parallel_GFX.h"
+#include "Teensy_Parallel_DisplayList.h"
 
 
-extern "C" const unsigned char glcdfont[];
+// Row major copy of the glcdfont, built at compile time. Each character has
+// 8 rows (top first), and each row has the 5 columns in bits 4 (left) to 0.
+static constexpr uint8_t glcdfont_columns[] = {
+#include "glcdfont.inc"
+};
+
+struct glcdfont_rows_t {
+    uint8_t rows[256][8];
+
+    constexpr glcdfont_rows_t() : rows() {
+        for (unsigned c = 0; c < 256; c++) {
+            for (unsigned row = 0; row < 8; row++) {
+                uint8_t line = 0;
+                for (unsigned col = 0; col < 5; col++) {
+                    unsigned index = c * 5 + col;
+                    if ((index < sizeof(glcdfont_columns)) && (glcdfont_columns[index] & (1 << row)))
+                        line |= 0x10 >> col;
+                }
+                rows[c][row] = line;
+            }
+        }
+    }
+};
+
+static constexpr glcdfont_rows_t glcdfont_rows;
 
 #ifndef ILI9488m_swap
 #define ILI9488m_swap(a, b) \
@@ -96,6 +124,27 @@ extern "C" const unsigned char glcdfont[];
     }
 #endif
 
+// While a display list is being recorded, the drawing calls are added to it
+// instead of being drawn.
+#define DL_RECORD(op, ...)                                                       \
+    do {                                                                         \
+        if (_display_list) {                                                     \
+            _display_list->record(Teensy_Parallel_DisplayList::op, __VA_ARGS__); \
+            return;                                                              \
+        }                                                                        \
+    } while (0)
+#define DL_RECORD_PTR(op, p0, p1, ...)                                                            \
+    do {                                                                                          \
+        if (_display_list) {                                                                      \
+            _display_list->recordPtr(Teensy_Parallel_DisplayList::op, p0, p1, nullptr, __VA_ARGS__); \
+            return;                                                                               \
+        }                                                                                         \
+    } while (0)
+
+// 32 bit values (24 bit colors, the rotation angle) are recorded as two int16
+// args, low half first
+static inline uint32_t dlArgs32(int16_t lo, int16_t hi) { return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16); }
+
 Teensy_Parallel_GFX::Teensy_Parallel_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
     _width = WIDTH;
     _height = HEIGHT;
@@ -106,29 +155,251 @@ Teensy_Parallel_GFX::Teensy_Parallel_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGH
 #endif
 }
 
+Teensy_Parallel_GFX::~Teensy_Parallel_GFX() {
+#ifdef ENABLE_FRAMEBUFFER
+    if (_band_fb != _tpfb)
+        delete _band_fb;
+    delete _tpfb;
+    free(_we_allocated_buffer);
+#endif
+}
+
 //=======================================================================
 // Add optinal support for using frame buffer to speed up complex outputs
 //=======================================================================
 void Teensy_Parallel_GFX::setFrameBuffer(uint16_t *frame_buffer, uint16_t bit_depth) {
 #ifdef ENABLE_FRAMEBUFFER
     _pfbtft = frame_buffer;
-    if (bit_depth == 24) {
+    _pfbtft_other = nullptr;
+    _fb_buffer_width = 0;
+    _fb_buffer_height = 0;
+    _fb_pan_x = 0;
+    _fb_pan_y = 0;
+    if (_tpfb) delete _tpfb; // don't leak the previous one
+    if (bit_depth == 32) {
+        _tpfb = new Teensy_Parallel_FB32(this, (uintptr_t)frame_buffer);
+    } else if (bit_depth == 24) {
         _tpfb = new Teensy_Parallel_FB24(this, (uintptr_t)frame_buffer);
     } else if (bit_depth == 18) {
         _tpfb = new Teensy_Parallel_FB18(this, (uintptr_t)frame_buffer);
+    } else if (bit_depth == 8) {
+        Teensy_Parallel_FB8 *fb8 = new Teensy_Parallel_FB8(this, (uintptr_t)frame_buffer);
+        fb8->setPalette(_fb_palette);
+        _tpfb = fb8;
+    } else if (bit_depth == 4) {
+        Teensy_Parallel_FB4 *fb4 = new Teensy_Parallel_FB4(this, (uintptr_t)frame_buffer);
+        fb4->setPalette(_fb_palette);
+        _tpfb = fb4;
     } else {
         _tpfb = new Teensy_Parallel_FB16(this, (uintptr_t)frame_buffer);
     }
+    _tpfb->setWidthHeight(_width, _height);
+    clearChangedRange();
+#endif
+}
+
+bool Teensy_Parallel_GFX::setFrameBuffer(uint16_t *frame_buffer, uint16_t buffer_width, uint16_t buffer_height,
+                                         uint16_t bit_depth) {
+#ifdef ENABLE_FRAMEBUFFER
+    // The display sized window has to fit, in the current rotation
+    if ((buffer_width < _width) || (buffer_height < _height))
+        return false;
+    setFrameBuffer(frame_buffer, bit_depth);
+    _fb_buffer_width = buffer_width;
+    _fb_buffer_height = buffer_height;
+    _tpfb->setStride(buffer_width);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Two display sized buffers, drawing starts in back_buffer.
+void Teensy_Parallel_GFX::setFrameBuffers(uint16_t *front_buffer, uint16_t *back_buffer, uint16_t bit_depth) {
+#ifdef ENABLE_FRAMEBUFFER
+    setFrameBuffer(back_buffer, bit_depth);
+    _pfbtft_other = front_buffer;
+#endif
+}
+
+void Teensy_Parallel_GFX::setFrameBufferPalette(const uint16_t *palette) {
+#ifdef ENABLE_FRAMEBUFFER
+    _fb_palette = palette;
+    if (_tpfb && (_tpfb->dataWidth() <= 8)) {
+        ((Teensy_Parallel_FBPalette *)_tpfb)->setPalette(palette);
+        // every pixel may look different now
+        _tpfb->updateChangedRange(0, 0, _width, _height);
+    }
+#endif
+}
+
+// Start sending the buffer we have been drawing into and continue drawing
+// in the other one.  Returns false if the driver could not do it async, in
+// which case the screen was updated before returning.
+bool Teensy_Parallel_GFX::swapAndUpdateAsync(bool copy_changed) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (!_use_fbtft || !_tpfb)
+        return false;
+    if (!_pfbtft_other)
+        return updateScreenAsync(false);
+
+    // The other buffer may still be going out, need it done before drawing into it.
+    endUpdateAsync();
+    waitUpdateAsyncComplete();
+
+    int16_t min_x = max(_tpfb->_changed_min_x, (int16_t)0);
+    int16_t max_x = min(_tpfb->_changed_max_x, (int16_t)(_width - 1));
+    int16_t min_y = max(_tpfb->_changed_min_y, (int16_t)0);
+    int16_t max_y = min(_tpfb->_changed_max_y, (int16_t)(_height - 1));
+
+    uint16_t *finished = _pfbtft;
+    bool async_started = updateScreenAsync(false);
+    if (!async_started)
+        updateScreen();
+
+    _pfbtft = _pfbtft_other;
+    _pfbtft_other = finished;
+    _tpfb->setBuffer((uintptr_t)_pfbtft);
+
+    if (copy_changed && (min_x <= max_x) && (min_y <= max_y) && (_tpfb->dataWidth() == 4)) {
+        // Two pixels a byte, just copy the whole rows
+        uint32_t row_bytes = (_width + 1) / 2;
+        memcpy((uint8_t *)_pfbtft + min_y * row_bytes, (uint8_t *)finished + min_y * row_bytes,
+               (max_y - min_y + 1) * row_bytes);
+    } else if (copy_changed && (min_x <= max_x) && (min_y <= max_y)) {
+        // Reading the buffer that is being sent is fine.
+        uint8_t bytes_per_pixel = _tpfb->countBytesPerPixel();
+        uint32_t row_bytes = (max_x - min_x + 1) * bytes_per_pixel;
+        for (int16_t y = min_y; y <= max_y; y++) {
+            uint32_t offset = ((uint32_t)y * _width + min_x) * bytes_per_pixel;
+            memcpy((uint8_t *)_pfbtft + offset, (uint8_t *)finished + offset, row_bytes);
+        }
+    }
+    clearChangedRange();
+    return async_started;
+#else
+    return false;
+#endif
+}
+
+// Move the display window around in a frame buffer bigger than the display.
+// Nothing is redrawn, the next updateScreen just sends the new window.
+void Teensy_Parallel_GFX::setFrameBufferPan(int16_t x, int16_t y) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (!_tpfb || !_fb_buffer_width || (_fb_buffer_width < _width) || (_fb_buffer_height < _height))
+        return;
+    x = max(0, min((int)x, _fb_buffer_width - _width));
+    y = max(0, min((int)y, _fb_buffer_height - _height));
+    if (_tpfb->dataWidth() == 4) {
+        x &= ~1; // has to start on a byte
+        _tpfb->setBuffer((uintptr_t)_pfbtft + (uint32_t)y * ((_fb_buffer_width + 1) / 2) + x / 2);
+    } else {
+        _tpfb->setBuffer((uintptr_t)_pfbtft + ((uint32_t)y * _fb_buffer_width + x) * _tpfb->countBytesPerPixel());
+    }
+    _fb_pan_x = x;
+    _fb_pan_y = y;
+    // everything on the display changes
+    _tpfb->updateChangedRange(0, 0, _width, _height);
+#endif
+}
+
+void Teensy_Parallel_GFX::setBandBuffer(uint16_t *buffer, uint16_t band_height, uint16_t *buffer2) {
+#ifdef ENABLE_FRAMEBUFFER
+    waitUpdateAsyncComplete(); // the last band may still be going out
+    _band_buffers[0] = buffer;
+    _band_buffers[1] = buffer2;
+    _band_height = buffer ? band_height : 0;
+    if (!_band_fb)
+        _band_fb = new Teensy_Parallel_FB16(this, (uintptr_t)buffer);
+#endif
+}
+
+void Teensy_Parallel_GFX::drawBands(void (*draw)(int16_t band_y, int16_t band_h, void *context), void *context) {
+    drawBandsInternal(nullptr, draw, context);
+}
+
+void Teensy_Parallel_GFX::drawBands(Teensy_Parallel_DisplayList &dl) {
+    drawBandsInternal(&dl, nullptr, nullptr);
+}
+
+void Teensy_Parallel_GFX::drawBandsInternal(Teensy_Parallel_DisplayList *dl,
+                                            void (*draw)(int16_t, int16_t, void *), void *context) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (!_band_height) {
+        // No band buffer, just draw it directly
+        if (dl)
+            drawDisplayList(*dl);
+        else
+            draw(0, _height, context);
+        return;
+    }
+    // Only the area inside the clip rectangle is drawn and sent, so the bands
+    // are that wide and can be taller when it is narrower than the screen.
+    int16_t area_x = _displayclipx1;
+    int16_t area_w = _displayclipx2 - _displayclipx1;
+    if (_invisible || (area_w <= 0))
+        return;
+    int16_t rows = min((uint32_t)_width * _band_height / area_w, (uint32_t)0x7fff);
+
+    // While drawing a band everything goes to the band buffer
+    Teensy_Parallel_FB *save_tpfb = _tpfb;
+    uint8_t save_use_fbtft = _use_fbtft;
+    uint32_t band_fence[2] = {_async_seq_queued, _async_seq_queued};
+    uint8_t index = 0;
+    _band_fb->setWidthHeight(_width, _height);
+    _band_fb->setStride(area_w);
+
+    for (int16_t band_y = _displayclipy1, area_y2 = _displayclipy2; band_y < area_y2; band_y += rows) {
+        int16_t band_h = min((int)rows, area_y2 - band_y);
+        uint16_t *buffer = _band_buffers[index];
+        waitAsyncFence(band_fence[index]);
+
+        // The buffer holds the band, so move where pixel (0, 0) would be
+        _band_fb->setBuffer((uintptr_t)buffer - ((uint32_t)band_y * area_w + area_x) * 2);
+        _tpfb = _band_fb;
+        _use_fbtft = 1;
+        _band_x1 = area_x;
+        _band_x2 = area_x + area_w;
+        _band_y1 = band_y;
+        _band_y2 = band_y + band_h;
+        updateDisplayClip();
+
+        if (dl)
+            drawDisplayList(*dl);
+        else
+            draw(band_y, band_h, context);
+
+        _tpfb = save_tpfb;
+        _use_fbtft = save_use_fbtft;
+        _band_x1 = _band_y1 = 0;
+        _band_x2 = _band_y2 = 0x7fff;
+        updateDisplayClip();
+
+        // Send it, async when there is another buffer to draw the next band into
+        if (_band_buffers[1] && queueAsyncRect(area_x, band_y, area_w, band_h, buffer)) {
+            band_fence[index] = _async_seq_queued;
+            index ^= 1;
+        } else {
+            writeRectFlexIO(area_x, band_y, area_w, band_h, buffer);
+        }
+    }
+    waitAsyncFence(_async_seq_queued);
 #endif
 }
 
 // how big should the frame buffer be?
 uint32_t Teensy_Parallel_GFX::getRequiredframeBufferSize(uint8_t bit_depth) {
 #ifdef ENABLE_FRAMEBUFFER
-    if (bit_depth == 24) {
+    if (bit_depth == 32) {
+        return 4 * _width * _height; // XRGB8888
+    } else if (bit_depth == 24) {
         return 3 * _width * _height;
     } else if (bit_depth == 18) {
-        return 4 * _width * _height;
+        return 3 * _width * _height; // packed
+    } else if (bit_depth == 8) {
+        return _width * _height;
+    } else if (bit_depth == 4) {
+        return ((_width + 1) / 2) * _height;
     } else {
         return 2 * _width * _height;
     }
@@ -151,7 +422,14 @@ uint8_t Teensy_Parallel_GFX::useFrameBuffer(
                 return 0; // failed
             _pfbtft = (uint16_t *)(((uintptr_t)_we_allocated_buffer + 32) &
                                    ~((uintptr_t)(31)));
+            if (_tpfb) delete _tpfb;
             _tpfb = new Teensy_Parallel_FB16(this, (uintptr_t)_pfbtft);
+            _tpfb->setWidthHeight(_width, _height);
+        }
+        // rotated since setFrameBuffer and the display no longer fits the buffer
+        if (_fb_buffer_width && ((_fb_buffer_width < _width) || (_fb_buffer_height < _height))) {
+            _use_fbtft = 0;
+            return 0;
         }
         _use_fbtft = 1;
         clearChangedRange(); // make sure the dirty range is updated.
@@ -169,6 +447,8 @@ void Teensy_Parallel_GFX::freeFrameBuffer(void) // explicit call to release the
 #ifdef ENABLE_FRAMEBUFFER
     if (_we_allocated_buffer) {
         free(_we_allocated_buffer);
+        delete _tpfb;
+        _tpfb = nullptr;
         _pfbtft = NULL;
         _use_fbtft = 0; // make sure the use is turned off
         _we_allocated_buffer = NULL;
@@ -187,10 +467,23 @@ void Teensy_Parallel_GFX::updateScreen(void) // call to say update the screen no
     if (!_use_fbtft)
         return; // bail
 
-    if (_standard && !_updateChangedAreasOnly) {
+    // When the frame buffer is bigger than the display, the display window is
+    // only one block of memory when the widths match (panned up or down).
+    bool fb_simple = !_fb_buffer_width || (!_fb_pan_y && (_fb_buffer_width == _width));
+    bool fb_rows_contiguous = !_fb_buffer_width || (_fb_buffer_width == _width);
+    // palette buffers always go through readRect, which converts them, 18 bit
+    // ones through writeRect18BPPPackedFlexIO and XRGB ones through
+    // writeRect24BPPFlexIO, so drivers that can show more than 565 get it all.
+    bool fb_converted = _tpfb->dataWidth() <= 8;
+    bool fb_packed18 = _tpfb->dataWidth() == 18;
+    bool fb_xrgb = _tpfb->dataWidth() == 32;
+
+    if (_standard && !_updateChangedAreasOnly && fb_simple && !fb_converted && !fb_packed18 && !fb_xrgb) {
         // Going to allow subclass to maybe do something different...
         updateScreenFlexIO();
         //writeRectFlexIO(0, 0, _width, _height, _pfbtft);
+    } else if (_standard && !_updateChangedAreasOnly && fb_rows_contiguous && (_tpfb->dataWidth() == 16)) {
+        writeRectFlexIO(0, 0, _width, _height, _pfbtft + _fb_pan_y * _width);
     } else {
         int16_t start_x = _displayclipx1;
         int16_t start_y = _displayclipy1;
@@ -209,8 +502,22 @@ void Teensy_Parallel_GFX::updateScreen(void) // call to say update the screen no
                 end_y = _tpfb->_changed_max_y;
         }
 
-        // Only do if actual area to update
-        if ((start_x <= end_x) && (start_y <= end_y)) {
+        if (fb_converted && (start_x <= end_x) && (start_y <= end_y)) {
+            // Convert a row at a time and send it as one block
+            int16_t w = end_x - start_x + 1;
+            uint16_t line_colors[w];
+            for (int16_t y = start_y; y <= end_y; y++) {
+                _tpfb->readRect(start_x, y, w, 1, line_colors);
+                writeRectFlexIO(start_x, y, w, 1, line_colors);
+            }
+        } else if (fb_packed18 && (start_x <= end_x) && (start_y <= end_y)) {
+            writeRect18BPPPackedFlexIO(start_x, start_y, end_x - start_x + 1, end_y - start_y + 1,
+                                       ((Teensy_Parallel_FB18 *)_tpfb)->pixelAddress(start_x, start_y), _tpfb->_stride);
+        } else if (fb_xrgb && (start_x <= end_x) && (start_y <= end_y)) {
+            writeRect24BPPFlexIO(start_x, start_y, end_x - start_x + 1, end_y - start_y + 1, _tpfb->_stride,
+                                 ((Teensy_Parallel_FB32 *)_tpfb)->pixelAddress(start_x, start_y));
+        } else if ((start_x <= end_x) && (start_y <= end_y)) {
+            // Only do if actual area to update
             setAddr(start_x, start_y, end_x, end_y);
             beginWrite16BitColors();
 
@@ -219,17 +526,15 @@ void Teensy_Parallel_GFX::updateScreen(void) // call to say update the screen no
 
             // BUGBUG doing as one shot.  Not sure if should or not or do like
             // main code and break up into transactions...
-            uint16_t *pfbPixel_row = &_pfbtft[start_y * _width + start_x];
-            for (uint16_t y = start_y; y <= end_y; y++) {
-                uint16_t *pfbPixel = pfbPixel_row;
-                for (uint16_t x = start_x; x < end_x; x++) {
-                    write16BitColor(*pfbPixel++);
+            // Rows are read back through the frame buffer code so this works for
+            // any stride, pan position and bit depth.
+            int16_t w = end_x - start_x + 1;
+            uint16_t line_colors[w];
+            for (int16_t y = start_y; y <= end_y; y++) {
+                _tpfb->readRect(start_x, y, w, 1, line_colors);
+                for (int16_t i = 0; i < w; i++) {
+                    write16BitColor(line_colors[i]);
                 }
-                if (y < (end_y))
-                    write16BitColor(*pfbPixel);
-                else
-                    write16BitColor(*pfbPixel);
-                pfbPixel_row += _width; // setup for the next row.
             }
             endWrite16BitColors();
         }
@@ -241,26 +546,642 @@ void Teensy_Parallel_GFX::updateScreen(void) // call to say update the screen no
 
 bool Teensy_Parallel_GFX::updateScreenAsync(bool update_cont) {
     //Serial.printf("Teensy_Parallel_GFX::updateScreenAsync(%x):%x\n", update_cont, _use_fbtft);
-    if (update_cont)
-        return false; // not supported yet.
 #ifdef ENABLE_FRAMEBUFFER
     if (_use_fbtft) {
-        return writeRectAsyncFlexIO(0, 0, _width, _height, _pfbtft);
+        // the async path needs the display window to be one block of memory,
+        // anything but 16 bit buffers is converted into the staging buffer
+        // (or for 32 bit ones sent by queueAsyncStagedRect).
+        bool fb_staged = asyncStaged();
+        if (fb_staged && update_cont)
+            return false;
+        if (_fb_buffer_width && !fb_staged && (_fb_buffer_width != _width))
+            return false;
+        if (!update_cont && (_updateChangedAreasOnly || !_standard)) {
+            // Like updateScreen, only send what changed, as full width rows
+            // so the data is still one block in the frame buffer.
+            int16_t start_y = _displayclipy1;
+            int16_t end_y = _displayclipy2 - 1;
+            if (_updateChangedAreasOnly) {
+                if (_tpfb->_changed_min_y > start_y)
+                    start_y = _tpfb->_changed_min_y;
+                if (_tpfb->_changed_max_y < end_y)
+                    end_y = _tpfb->_changed_max_y;
+            }
+            clearChangedRange();
+            if (start_y > end_y)
+                return true; // nothing to send
+            return queueAsyncRows(start_y, end_y - start_y + 1);
+        }
+        if (fb_staged)
+            return queueAsyncRows(0, _height);
+        if (asyncUpdateActive())
+            return false; // still sending the last one.
+        _async_frame_buffer = _pfbtft + _fb_pan_y * _width;
+        _async_continuous = update_cont;
+        if (queueAsyncRect(0, 0, _width, _height, _async_frame_buffer))
+            return true;
+        _async_continuous = false;
     }
 #endif
     return false; // bail
 }
 
+bool Teensy_Parallel_GFX::updateRectAsync(int16_t x, int16_t y, int16_t w, int16_t h) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (!_use_fbtft)
+        return false;
+    bool fb_staged = asyncStaged();
+    if (!fb_staged && _fb_buffer_width && (_fb_buffer_width != _width))
+        return false;
+    x += _originx;
+    y += _originy;
+    if ((x >= _displayclipx2) || (y >= _displayclipy2) || ((x + w) <= _displayclipx1) || ((y + h) <= _displayclipy1))
+        return true; // nothing visible to send
+    if (y < _displayclipy1) {
+        h -= _displayclipy1 - y;
+        y = _displayclipy1;
+    }
+    if ((y + h) > _displayclipy2)
+        h = _displayclipy2 - y;
+    if (fb_staged) {
+        // only the columns asked for need expanding
+        if (x < _displayclipx1) {
+            w -= _displayclipx1 - x;
+            x = _displayclipx1;
+        }
+        if ((x + w) > _displayclipx2)
+            w = _displayclipx2 - x;
+        return queueAsyncStagedRect(x, y, w, h);
+    }
+    return queueAsyncRows(y, h);
+#else
+    return false;
+#endif
+}
+
+void Teensy_Parallel_GFX::writeRect18BPPPackedFlexIO(int16_t x, int16_t y, int16_t w, int16_t h,
+                                                     const uint8_t *pixels, uint16_t stride) {
+    uint16_t line_colors[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRow888To565(pixels + (uint32_t)iy * stride * 3, line_colors, w);
+        writeRectFlexIO(x, y + iy, w, 1, line_colors);
+    }
+}
+
+// Rows y to y + h - 1 of the frame buffer, full width so they are contiguous.
+// Unstaged buffers are 16 bit, so the rows can be found with uint16_t math.
+bool Teensy_Parallel_GFX::queueAsyncRows(int16_t y, int16_t h) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (asyncStaged())
+        return queueAsyncStagedRect(0, y, _width, h);
+    return queueAsyncRect(0, y, _width, h, _pfbtft + (_fb_pan_y + y) * _width);
+#else
+    return false;
+#endif
+}
+
+// Palette, 18 and 24 bit frame buffers are converted to 565 in the staging
+// buffer a band of rows at a time, like writeRect8BPPAsync, so the next band
+// is converted while the last one goes out.  False without a staging buffer
+// big enough for a row.
+// XRGB ones go to writeRect24BPPFlexIO as they are, like updateScreen does,
+// so they keep their color.  Drivers have no async version of that, so it
+// waits for what is queued and sends them before returning.
+bool Teensy_Parallel_GFX::queueAsyncStagedRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (_tpfb->dataWidth() == 32) {
+        if ((w <= 0) || (h <= 0))
+            return false;
+        while (asyncUpdateActive()) {
+        }
+        writeRect24BPPFlexIO(x, y, w, h, _tpfb->_stride, ((Teensy_Parallel_FB32 *)_tpfb)->pixelAddress(x, y));
+        return true;
+    }
+    if ((w <= 0) || ((uint32_t)w > _async_staging_half))
+        return false;
+    int16_t band_rows = _async_staging_half / w;
+    while (h > 0) {
+        int16_t rows = min(h, band_rows);
+        uint8_t index;
+        uint16_t *staging = asyncStagingHalf(index);
+        _tpfb->readRect(x, y, w, rows, staging);
+        if (!queueAsyncRect(x, y, w, rows, staging)) {
+            writeRectFlexIO(x, y, w, rows, staging);
+        }
+        _async_staging_seq[index] = _async_seq_queued;
+        y += rows;
+        h -= rows;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Teensy_Parallel_GFX::queueAsyncRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) {
+    __disable_irq();
+    while (_async_queue_count == TPGFX_ASYNC_QUEUE_SIZE) {
+        // Full, if the last one is rows right next to these, grow it.  The rows
+        // have to touch, merging over a gap would send the rows in between too.
+        async_rect_t &last = _async_queue[(_async_queue_head + _async_queue_count - 1) % TPGFX_ASYNC_QUEUE_SIZE];
+        if ((last.x == 0) && (x == 0) && (last.w == _width) && (w == _width) &&
+            ((y == last.y + last.h) || (y + h == last.y)) &&
+            (last.pcolors + (y - last.y) * _width == pcolors)) {
+            int16_t y1 = min(last.y, y);
+            int16_t y2 = max(last.y + last.h, y + h);
+            last.pcolors -= (last.y - y1) * _width;
+            last.y = y1;
+            last.h = y2 - y1;
+            last.seq = ++_async_seq_queued;
+            __enable_irq();
+            return true;
+        }
+        // otherwise wait for room
+        __enable_irq();
+        asyncUpdateActive();
+        __disable_irq();
+    }
+    async_rect_t &rect = _async_queue[(_async_queue_head + _async_queue_count) % TPGFX_ASYNC_QUEUE_SIZE];
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+    rect.pcolors = pcolors;
+    rect.seq = ++_async_seq_queued;
+    _async_queue_count++;
+    bool start_now = !_async_in_flight;
+    __enable_irq();
+    if (start_now)
+        return startNextAsyncRect();
+    return true;
+}
+
+// Start the next queued rectangle, false if there is none or the driver refused.
+bool Teensy_Parallel_GFX::startNextAsyncRect() {
+    if (!_async_queue_count)
+        return false;
+    async_rect_t &rect = _async_queue[_async_queue_head];
+    _async_queue_head = (_async_queue_head + 1) % TPGFX_ASYNC_QUEUE_SIZE;
+    _async_queue_count--;
+    _async_in_flight = true;
+    _async_in_flight_seq = rect.seq;
+    if (writeRectAsyncFlexIO(rect.x, rect.y, rect.w, rect.h, rect.pcolors))
+        return true;
+    // driver can't do it, drop everything
+    _async_in_flight = false;
+    _async_queue_count = 0;
+    _async_continuous = false;
+    _async_seq_done = _async_seq_queued; // so nobody waits on a fence forever
+    return false;
+}
+
+// One async transfer is done.  Start the next queued one, or when the queue
+// is empty count the frame, tell the sketch, and in continuous mode start
+// sending the next frame.  Called from the driver's interrupt, or from
+// asyncUpdateActive once it has claimed the transfer.
+void Teensy_Parallel_GFX::asyncFrameDone() {
+    if (!_async_in_flight)
+        return;
+    _async_in_flight = false;
+    _async_seq_done = _async_in_flight_seq;
+    asyncTransferFinished();
+}
+
+void Teensy_Parallel_GFX::asyncTransferFinished() {
+    if (startNextAsyncRect())
+        return;
+    _dma_frame_count++;
+    if (_frame_complete_callback)
+        (*_frame_complete_callback)();
+    if (_async_continuous) {
+        // queue is empty, and we may be in the DMA interrupt, so fill it in directly.
+        async_rect_t &rect = _async_queue[_async_queue_head];
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = _width;
+        rect.h = _height;
+        rect.pcolors = _async_frame_buffer;
+        rect.seq = ++_async_seq_queued;
+        _async_queue_count = 1;
+        startNextAsyncRect();
+    }
+}
+
+boolean Teensy_Parallel_GFX::asyncUpdateActive() {
+    bool driver_active = writeRectAsyncActiveFlexIO();
+    if (_async_in_flight && !driver_active && !_async_driver_callbacks) {
+        // Polled drivers only.  Claim the finished transfer with interrupts
+        // off, so a driver interrupt calling asyncFrameComplete (which from
+        // then on is the only thing that advances) can't finish it as well,
+        // or have started the next one that we would finish by mistake.
+        __disable_irq();
+        bool claimed = _async_in_flight && !_async_driver_callbacks && !writeRectAsyncActiveFlexIO();
+        if (claimed) {
+            _async_in_flight = false;
+            _async_seq_done = _async_in_flight_seq;
+        }
+        __enable_irq();
+        if (claimed)
+            asyncTransferFinished();
+    }
+    return _async_in_flight || driver_active;
+}
+
+bool Teensy_Parallel_GFX::asyncFenceDone(uint32_t fence) {
+    asyncUpdateActive(); // keeps things moving for drivers without the callback
+    return (int32_t)(_async_seq_done - fence) >= 0;
+}
+
+void Teensy_Parallel_GFX::waitAsyncFence(uint32_t fence) {
+    while (!asyncFenceDone(fence)) {
+    }
+}
+
+void Teensy_Parallel_GFX::setAsyncStagingBuffer(uint16_t *buffer, uint32_t count_pixels) {
+    waitUpdateAsyncComplete();
+    _async_staging = buffer;
+    _async_staging_half = buffer ? count_pixels / 2 : 0;
+    _async_staging_next = 0;
+}
+
+// Next staging half, once the last job that used it is done.
+uint16_t *Teensy_Parallel_GFX::asyncStagingHalf(uint8_t &index) {
+    index = _async_staging_next;
+    _async_staging_next ^= 1;
+    waitAsyncFence(_async_staging_seq[index]);
+    return _async_staging + index * _async_staging_half;
+}
+
+// Queue a rectangle of pixels.  pcolors has w * h pixels like writeRect.
+uint32_t Teensy_Parallel_GFX::writeRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        writeRect(x, y, w, h, pcolors);
+        return _async_seq_queued;
+    }
+#endif
+    int16_t x_screen = x + _originx;
+    int16_t y_screen = y + _originy;
+    if ((x_screen >= _displayclipx2) || (y_screen >= _displayclipy2) ||
+        ((x_screen + w) <= _displayclipx1) || ((y_screen + h) <= _displayclipy1))
+        return _async_seq_queued;
+    if ((x_screen < _displayclipx1) || ((x_screen + w) > _displayclipx2)) {
+        // Clipped on the sides, the rows are no longer one block, so do it now.
+        waitUpdateAsyncComplete();
+        writeRect(x, y, w, h, pcolors);
+        return _async_seq_queued;
+    }
+    if (y_screen < _displayclipy1) {
+        pcolors += (_displayclipy1 - y_screen) * w;
+        h -= _displayclipy1 - y_screen;
+        y_screen = _displayclipy1;
+    }
+    if ((y_screen + h) > _displayclipy2)
+        h = _displayclipy2 - y_screen;
+    if (!queueAsyncRect(x_screen, y_screen, w, h, (uint16_t *)pcolors)) {
+        writeRect(x, y_screen - _originy, w, h, pcolors);
+    }
+    return _async_seq_queued;
+}
+
+// Palette expand into the staging buffer a band of rows at a time.
+uint32_t Teensy_Parallel_GFX::writeRect8BPPAsync(int16_t x, int16_t y, int16_t w, int16_t h,
+                                                 const uint8_t *pixels, const uint16_t *palette) {
+    int16_t x_screen = x + _originx;
+    int16_t y_screen = y + _originy;
+    if (
+#ifdef ENABLE_FRAMEBUFFER
+        _use_fbtft ||
+#endif
+        ((uint32_t)w > _async_staging_half) || (x_screen < _displayclipx1) || ((x_screen + w) > _displayclipx2)) {
+        waitUpdateAsyncComplete();
+        writeRect8BPP(x, y, w, h, pixels, palette);
+        return _async_seq_queued;
+    }
+    if ((y_screen >= _displayclipy2) || ((y_screen + h) <= _displayclipy1))
+        return _async_seq_queued;
+    if (y_screen < _displayclipy1) {
+        pixels += (_displayclipy1 - y_screen) * w;
+        h -= _displayclipy1 - y_screen;
+        y_screen = _displayclipy1;
+    }
+    if ((y_screen + h) > _displayclipy2)
+        h = _displayclipy2 - y_screen;
+
+    int16_t band_rows = _async_staging_half / w;
+    while (h > 0) {
+        int16_t rows = min(h, band_rows);
+        uint8_t index;
+        uint16_t *staging = asyncStagingHalf(index);
+        uint32_t count = (uint32_t)rows * w;
+        for (uint32_t i = 0; i < count; i++)
+            staging[i] = palette[*pixels++];
+        if (!queueAsyncRect(x_screen, y_screen, w, rows, staging)) {
+            writeRectFlexIO(x_screen, y_screen, w, rows, staging);
+        }
+        _async_staging_seq[index] = _async_seq_queued;
+        y_screen += rows;
+        h -= rows;
+    }
+    return _async_seq_queued;
+}
+
+// The staging half is filled with the color once and every band sends it.
+uint32_t Teensy_Parallel_GFX::fillRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x_screen = x + _originx;
+    int16_t y_screen = y + _originy;
+    if ((x_screen >= _displayclipx2) || (y_screen >= _displayclipy2) || (w < 1) || (h < 1))
+        return _async_seq_queued;
+    if (((x_screen + w) <= _displayclipx1) || ((y_screen + h) <= _displayclipy1))
+        return _async_seq_queued;
+    if (x_screen < _displayclipx1) {
+        w -= _displayclipx1 - x_screen;
+        x_screen = _displayclipx1;
+    }
+    if (y_screen < _displayclipy1) {
+        h -= _displayclipy1 - y_screen;
+        y_screen = _displayclipy1;
+    }
+    if ((x_screen + w) > _displayclipx2)
+        w = _displayclipx2 - x_screen;
+    if ((y_screen + h) > _displayclipy2)
+        h = _displayclipy2 - y_screen;
+
+    if (
+#ifdef ENABLE_FRAMEBUFFER
+        _use_fbtft ||
+#endif
+        ((uint32_t)w > _async_staging_half)) {
+        waitUpdateAsyncComplete();
+        fillRect(x_screen - _originx, y_screen - _originy, w, h, color);
+        return _async_seq_queued;
+    }
+
+    int16_t band_rows = min((int)h, (int)(_async_staging_half / w));
+    uint8_t index;
+    uint16_t *staging = asyncStagingHalf(index);
+    for (uint32_t i = 0; i < (uint32_t)band_rows * w; i++)
+        staging[i] = color;
+    while (h > 0) {
+        int16_t rows = min(h, band_rows);
+        if (!queueAsyncRect(x_screen, y_screen, w, rows, staging))
+            fillRectFlexIO(x_screen, y_screen, w, rows, color);
+        y_screen += rows;
+        h -= rows;
+    }
+    _async_staging_seq[index] = _async_seq_queued;
+    return _async_seq_queued;
+}
+
+// In continuous mode this waits for the current frame to finish (the next
+// one is already going), otherwise for the update to be completely done.
 void Teensy_Parallel_GFX::waitUpdateAsyncComplete() {
-    while (writeRectAsyncActiveFlexIO()) {
+    if (_async_continuous) {
+        uint32_t frame_count = _dma_frame_count;
+        while (_async_continuous && (frame_count == _dma_frame_count)) {
+            asyncUpdateActive();
+        }
+        return;
+    }
+    while (asyncUpdateActive()) {
     }
 }
 
+// Stop continuous mode, the frame being sent is allowed to finish.
 void Teensy_Parallel_GFX::endUpdateAsync() {
-    // Currently not supporting this.
+    _async_continuous = false;
+}
+
+//=============================================================================
+// Display lists
+//=============================================================================
+void Teensy_Parallel_GFX::beginDisplayList(Teensy_Parallel_DisplayList &dl, bool clear) {
+    if (clear)
+        dl.clear();
+    _display_list = &dl;
+    // Start with the text state, so the list draws the same wherever it is drawn
+    dl.recordPtr(Teensy_Parallel_DisplayList::DL_TEXT_STATE, font, gfxFont, rleFont, cursor_x, cursor_y,
+                 textcolor, textbgcolor, textsize_x, textsize_y, wrap, textdatum);
+}
+
+void Teensy_Parallel_GFX::drawDisplayList(Teensy_Parallel_DisplayList &dl) {
+    if (&dl == _display_list)
+        return; // would never end
+    int16_t a[TPGFX_DL_MAX_ARGS];
+    const void *p[TPGFX_DL_MAX_PTRS];
+    const uint8_t *text = nullptr;
+    uint8_t op;
+    uint32_t offset = 0;
+    while ((offset = dl.read(offset, op, a, p, &text)) != 0) {
+        switch (op) {
+        case Teensy_Parallel_DisplayList::DL_FILL_SCREEN:
+            fillScreen(a[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_PIXEL:
+            drawPixel(a[0], a[1], a[2]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_FAST_HLINE:
+            drawFastHLine(a[0], a[1], a[2], a[3]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_FAST_VLINE:
+            drawFastVLine(a[0], a[1], a[2], a[3]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT:
+            fillRect(a[0], a[1], a[2], a[3], a[4]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_LINE:
+            drawLine(a[0], a[1], a[2], a[3], a[4]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_RECT:
+            drawRect(a[0], a[1], a[2], a[3], a[4]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_ROUND_RECT:
+            drawRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_ROUND_RECT:
+            fillRoundRect(a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_CIRCLE:
+            drawCircle(a[0], a[1], a[2], a[3]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_CIRCLE:
+            fillCircle(a[0], a[1], a[2], a[3]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_TRIANGLE:
+            drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_TRIANGLE:
+            fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_HGRADIENT:
+            fillRectHGradient(a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_VGRADIENT:
+            fillRectVGradient(a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_LINEAR_GRADIENT:
+            fillRectLinearGradient(a[0], a[1], a[2], a[3], (const uint16_t *)p[0], (const uint8_t *)p[1], a[4], a[5]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_RADIAL_GRADIENT:
+            fillRectRadialGradient(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_RADIAL_GRADIENT_STOPS:
+            fillRectRadialGradient(a[0], a[1], a[2], a[3], a[4], a[5], a[6], (const uint16_t *)p[0], (const uint8_t *)p[1], a[7]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_RECT:
+            writeRect(a[0], a[1], a[2], a[3], (const uint16_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_SUBIMAGE_RECT:
+            writeSubImageRect(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], (const uint16_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_SUBIMAGE_RECT_KEYED:
+            writeSubImageRectKeyed(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], (const uint16_t *)p[0], a[8]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_SUBIMAGE_RECT_BLEND:
+            writeSubImageRectBlend(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], (const uint16_t *)p[0], a[8], a[9], a[10]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_RECT_8BPP:
+            writeRect8BPP(a[0], a[1], a[2], a[3], (const uint8_t *)p[0], (const uint16_t *)p[1]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_RECT_8BPP_BLEND:
+            writeRect8BPPBlend(a[0], a[1], a[2], a[3], (const uint8_t *)p[0], (const uint16_t *)p[1], a[4], a[5], a[6]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_RECT_NBPP:
+            writeRectNBPP(a[0], a[1], a[2], a[3], a[4], (const uint8_t *)p[0], (const uint16_t *)p[1]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_PIXEL_24BPP:
+            drawPixel24BPP(a[0], a[1], dlArgs32(a[2], a[3]));
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_FAST_HLINE_24BPP:
+            drawFastHLine24BPP(a[0], a[1], a[2], dlArgs32(a[3], a[4]));
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_FAST_VLINE_24BPP:
+            drawFastVLine24BPP(a[0], a[1], a[2], dlArgs32(a[3], a[4]));
+            break;
+        case Teensy_Parallel_DisplayList::DL_FILL_RECT_24BPP:
+            fillRect24BPP(a[0], a[1], a[2], a[3], dlArgs32(a[4], a[5]));
+            break;
+        case Teensy_Parallel_DisplayList::DL_WRITE_RECT_24BPP:
+            writeRect24BPP(a[0], a[1], a[2], a[3], (const uint32_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_BITMAP:
+            drawBitmap(a[0], a[1], (const uint8_t *)p[0], a[2], a[3], a[4]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_RLE_IMAGE:
+            drawRLEImage(a[0], a[1], *(const RLE_image_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_IMAGE_SCALED:
+            drawImageScaled(a[0], a[1], a[2], a[3], (const uint16_t *)p[0], a[4], a[5], a[6], a[7], a[8]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_DRAW_IMAGE_ROTATED: {
+            uint32_t angle_bits = dlArgs32(a[6], a[7]);
+            float angle;
+            memcpy(&angle, &angle_bits, sizeof(angle));
+            drawImageRotated(a[0], a[1], (const uint16_t *)p[0], a[2], a[3], a[4], a[5], angle, a[8], a[9], a[10]);
+            break;
+        }
+        case Teensy_Parallel_DisplayList::DL_DRAW_CHAR:
+            drawChar(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_CURSOR:
+            setCursor(a[0], a[1], a[2]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_TEXT_COLOR:
+            setTextColor(a[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_TEXT_COLOR_BG:
+            setTextColor(a[0], a[1]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_TEXT_SIZE:
+            setTextSize(a[0], a[1]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_TEXT_WRAP:
+            setTextWrap(a[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_TEXT_DATUM:
+            setTextDatum(a[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_FONT_ILI:
+            setFont(*(const ILI9341_t3_font_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_FONT_GFX:
+            setFont((const GFXfont *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_SET_FONT_RLE:
+            setFont(*(const RLE_font_t *)p[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_TEXT:
+            write(text, (uint16_t)a[0]);
+            break;
+        case Teensy_Parallel_DisplayList::DL_TEXT_STATE: {
+            if (_display_list)
+                _display_list->recordPtr(op, p[0], p[1], p[2], a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+            text_state_t state = {(const ILI9341_t3_font_t *)p[0], (const GFXfont *)p[1], (const RLE_font_t *)p[2],
+                                  a[0], a[1], (uint16_t)a[2], (uint16_t)a[3], (uint8_t)a[4], (uint8_t)a[5],
+                                  (boolean)a[6], (uint8_t)a[7]};
+            setTextState(state);
+            break;
+        }
+        }
+    }
+}
+
+void Teensy_Parallel_GFX::getTextState(text_state_t &state) {
+    state.font = font;
+    state.gfx_font = gfxFont;
+    state.rle_font = rleFont;
+    state.cursor_x = cursor_x;
+    state.cursor_y = cursor_y;
+    state.color = textcolor;
+    state.bg_color = textbgcolor;
+    state.size_x = textsize_x;
+    state.size_y = textsize_y;
+    state.wrap = wrap;
+    state.datum = textdatum;
+}
+
+void Teensy_Parallel_GFX::setTextState(const text_state_t &state) {
+    if (state.font)
+        setFont(*state.font);
+    else if (state.rle_font)
+        setFont(*state.rle_font);
+    else
+        setFont(state.gfx_font);
+    cursor_x = state.cursor_x;
+    cursor_y = state.cursor_y;
+    textcolor = state.color;
+    textbgcolor = state.bg_color;
+    textcolorPrexpanded = (textcolor | (textcolor << 16)) & 0b00000111111000001111100000011111;
+    textbgcolorPrexpanded = (textbgcolor | (textbgcolor << 16)) & 0b00000111111000001111100000011111;
+    textsize_x = state.size_x;
+    textsize_y = state.size_y;
+    wrap = state.wrap;
+    textdatum = state.datum;
+    _center_x_text = false;
+    _center_y_text = false;
+    _gfx_last_char_x_write = 0;
+}
+
+// Draw only the part of the list inside x, y, w, h (and the current clip).
+void Teensy_Parallel_GFX::drawDisplayList(Teensy_Parallel_DisplayList &dl, int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t save_x1 = _clipx1, save_y1 = _clipy1, save_x2 = _clipx2, save_y2 = _clipy2;
+    int16_t x1 = max(x, _clipx1);
+    int16_t y1 = max(y, _clipy1);
+    int16_t x2 = min((int16_t)(x + w), _clipx2);
+    int16_t y2 = min((int16_t)(y + h), _clipy2);
+    if ((x2 <= x1) || (y2 <= y1))
+        return;
+    setClipRect(x1, y1, x2 - x1, y2 - y1);
+    drawDisplayList(dl);
+    _clipx1 = save_x1;
+    _clipy1 = save_y1;
+    _clipx2 = save_x2;
+    _clipy2 = save_y2;
+    updateDisplayClip();
 }
 
 void Teensy_Parallel_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    DL_RECORD(DL_DRAW_RECT, x, y, w, h, color);
     drawFastHLine(x, y, w, color);
     drawFastHLine(x, y + h - 1, w, color);
     drawFastVLine(x, y, h, color);
@@ -270,6 +1191,7 @@ void Teensy_Parallel_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, u
 // Draw a rounded rectangle
 void Teensy_Parallel_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w,
                                         int16_t h, int16_t r, uint16_t color) {
+    DL_RECORD(DL_DRAW_ROUND_RECT, x, y, w, h, r, color);
     // smarter version
     drawFastHLine(x + r, y, w - 2 * r, color);         // Top
     drawFastHLine(x + r, y + h - 1, w - 2 * r, color); // Bottom
@@ -285,6 +1207,7 @@ void Teensy_Parallel_GFX::drawRoundRect(int16_t x, int16_t y, int16_t w,
 // Fill a rounded rectangle
 void Teensy_Parallel_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w,
                                         int16_t h, int16_t r, uint16_t color) {
+    DL_RECORD(DL_FILL_ROUND_RECT, x, y, w, h, r, color);
     // smarter version
     fillRect(x + r, y, w - 2 * r, h, color);
 
@@ -327,6 +1250,7 @@ void Teensy_Parallel_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
 // Draw a circle outline
 void Teensy_Parallel_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r,
                                      uint16_t color) {
+    DL_RECORD(DL_DRAW_CIRCLE, x0, y0, r, color);
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
@@ -397,11 +1321,13 @@ void Teensy_Parallel_GFX::drawCircleHelper(int16_t x0, int16_t y0,
 
 void Teensy_Parallel_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r,
                                      uint16_t color) {
+    DL_RECORD(DL_FILL_CIRCLE, x0, y0, r, color);
     drawFastVLine(x0, y0 - r, 2 * r + 1, color);
     fillCircleHelper(x0, y0, r, 3, 0, color);
 }
 
 void Teensy_Parallel_GFX::fillScreen(uint16_t color) {
+    DL_RECORD(DL_FILL_SCREEN, color);
     fillRect(0, 0, _width, _height, color);
 }
 
@@ -409,6 +1335,7 @@ void Teensy_Parallel_GFX::fillScreen(uint16_t color) {
 void Teensy_Parallel_GFX::drawTriangle(int16_t x0, int16_t y0,
                                        int16_t x1, int16_t y1,
                                        int16_t x2, int16_t y2, uint16_t color) {
+    DL_RECORD(DL_DRAW_TRIANGLE, x0, y0, x1, y1, x2, y2, color);
     drawLine(x0, y0, x1, y1, color);
     drawLine(x1, y1, x2, y2, color);
     drawLine(x2, y2, x0, y0, color);
@@ -418,6 +1345,7 @@ void Teensy_Parallel_GFX::drawTriangle(int16_t x0, int16_t y0,
 void Teensy_Parallel_GFX::fillTriangle(int16_t x0, int16_t y0,
                                        int16_t x1, int16_t y1,
                                        int16_t x2, int16_t y2, uint16_t color) {
+    DL_RECORD(DL_FILL_TRIANGLE, x0, y0, x1, y1, x2, y2, color);
 
     int16_t a, b, y, last;
 
@@ -505,6 +1433,7 @@ void Teensy_Parallel_GFX::fillTriangle(int16_t x0, int16_t y0,
 
 void Teensy_Parallel_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                                    uint16_t color) {
+    DL_RECORD(DL_DRAW_LINE, x0, y0, x1, y1, color);
 
     if (y0 == y1) {
         if (x1 > x0) {
@@ -567,6 +1496,7 @@ void Teensy_Parallel_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y
 void Teensy_Parallel_GFX::drawBitmap(int16_t x, int16_t y,
                                      const uint8_t *bitmap, int16_t w, int16_t h,
                                      uint16_t color) {
+    DL_RECORD_PTR(DL_DRAW_BITMAP, bitmap, nullptr, x, y, w, h, color);
 
     int16_t i, j, byteWidth = (w + 7) / 8;
 
@@ -586,6 +1516,14 @@ size_t Teensy_Parallel_GFX::write(uint8_t c) {
 }
 
 size_t Teensy_Parallel_GFX::write(const uint8_t *buffer, size_t size) {
+    if (_display_list) {
+        // Only the text is recorded, the cursor does not move until it is drawn
+        for (size_t cb = 0; cb < size; cb += 0xffff)
+            _display_list->recordText(buffer + cb, min(size - cb, (size_t)0xffff));
+        _center_x_text = false;
+        _center_y_text = false;
+        return size;
+    }
     // Lets try to handle some of the special font centering code that was done for default fonts.
     if (_center_x_text || _center_y_text) {
         int16_t x, y;
@@ -619,6 +1557,17 @@ size_t Teensy_Parallel_GFX::write(const uint8_t *buffer, size_t size) {
             } else {
                 drawFontChar(c);
             }
+        } else if (rleFont) {
+            if (c == '\n') {
+                cursor_y += rleFont->line_space;
+                if (scrollEnable && isWritingScrollArea) {
+                    cursor_x = scroll_x;
+                } else {
+                    cursor_x = 0;
+                }
+            } else if (c != '\r') {
+                drawRLEFontChar(c);
+            }
         } else if (gfxFont) {
             if (c == '\n') {
                 cursor_y += (int16_t)textsize_y * gfxFont->yAdvance;
@@ -662,120 +1611,63 @@ size_t Teensy_Parallel_GFX::write(const uint8_t *buffer, size_t size) {
 }
 
 // Draw a character
+//
+// Uses the row major glcdfont_rows table, so each glyph row is a single lookup.
+// Text size is handled by replicating columns into a line buffer and rows by
+// writing that line buffer size_y times. Consecutive identical glyph rows are
+// merged so they go out as one taller rectangle.
 void Teensy_Parallel_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
                                    uint16_t fgcolor, uint16_t bgcolor, uint8_t size_x, uint8_t size_y) {
+    DL_RECORD(DL_DRAW_CHAR, x, y, c, fgcolor, bgcolor, size_x, size_y);
     if ((x >= _width) ||              // Clip right
         (y >= _height) ||             // Clip bottom
         ((x + 6 * size_x - 1) < 0) || // Clip left  TODO: is this correct?
         ((y + 8 * size_y - 1) < 0))   // Clip top   TODO: is this correct?
         return;
 
+    const uint8_t *rows = glcdfont_rows.rows[c];
+
     //	Serial.printf("drawchar %d %d %c %x %x %d %d\n", x, y, c, fgcolor, bgcolor, size_x, size_y);
     if (fgcolor == bgcolor) {
-        // This transparent approach is only about 20% faster
-        if ((size_x == 1) && (size_y == 1)) {
-            uint8_t mask = 0x01;
-            int16_t xoff, yoff;
-            for (yoff = 0; yoff < 8; yoff++) {
-                uint8_t line = 0;
-                for (xoff = 0; xoff < 5; xoff++) {
-                    if (glcdfont[c * 5 + xoff] & mask)
-                        line |= 1;
-                    line <<= 1;
-                }
-                line >>= 1;
-                xoff = 0;
-                while (line) {
-                    if (line == 0x1F) {
-                        drawFastHLine(x + xoff, y + yoff, 5, fgcolor);
-                        break;
-                    } else if (line == 0x1E) {
-                        drawFastHLine(x + xoff, y + yoff, 4, fgcolor);
-                        break;
-                    } else if ((line & 0x1C) == 0x1C) {
-                        drawFastHLine(x + xoff, y + yoff, 3, fgcolor);
-                        line <<= 4;
-                        xoff += 4;
-                    } else if ((line & 0x18) == 0x18) {
-                        drawFastHLine(x + xoff, y + yoff, 2, fgcolor);
-                        line <<= 3;
-                        xoff += 3;
-                    } else if ((line & 0x10) == 0x10) {
-                        drawPixel(x + xoff, y + yoff, fgcolor);
-                        line <<= 2;
-                        xoff += 2;
-                    } else {
-                        line <<= 1;
-                        xoff += 1;
-                    }
-                }
-                mask = mask << 1;
-            }
-        } else {
-            uint8_t mask = 0x01;
-            int16_t xoff, yoff;
-            for (yoff = 0; yoff < 8; yoff++) {
-                uint8_t line = 0;
-                for (xoff = 0; xoff < 5; xoff++) {
-                    if (glcdfont[c * 5 + xoff] & mask)
-                        line |= 1;
-                    line <<= 1;
-                }
-                line >>= 1;
-                xoff = 0;
-                while (line) {
-                    if (line == 0x1F) {
-                        fillRect(x + xoff * size_x, y + yoff * size_y,
-                                 5 * size_x, size_y, fgcolor);
-                        break;
-                    } else if (line == 0x1E) {
-                        fillRect(x + xoff * size_x, y + yoff * size_y,
-                                 4 * size_x, size_y, fgcolor);
-                        break;
-                    } else if ((line & 0x1C) == 0x1C) {
-                        fillRect(x + xoff * size_x, y + yoff * size_y,
-                                 3 * size_x, size_y, fgcolor);
-                        line <<= 4;
-                        xoff += 4;
-                    } else if ((line & 0x18) == 0x18) {
-                        fillRect(x + xoff * size_x, y + yoff * size_y,
-                                 2 * size_x, size_y, fgcolor);
-                        line <<= 3;
-                        xoff += 3;
-                    } else if ((line & 0x10) == 0x10) {
-                        fillRect(x + xoff * size_x, y + yoff * size_y,
-                                 size_x, size_y, fgcolor);
-                        line <<= 2;
-                        xoff += 2;
-                    } else {
-                        line <<= 1;
-                        xoff += 1;
+        // Transparent, only output the runs of set pixels in each row.
+        uint8_t yoff = 0;
+        while (yoff < 8) {
+            uint8_t line = rows[yoff];
+            uint8_t yrep = 1;
+            while (((yoff + yrep) < 8) && (rows[yoff + yrep] == line))
+                yrep++;
+            int16_t xoff = 0;
+            while (line) {
+                if (line & 0x10) {
+                    int16_t run = 0;
+                    while (line & 0x10) {
+                        run++;
+                        line = (line << 1) & 0x1F;
                     }
+                    fillRect(x + xoff * size_x, y + yoff * size_y, run * size_x, yrep * size_y, fgcolor);
+                    xoff += run;
+                } else {
+                    line = (line << 1) & 0x1F;
+                    xoff++;
                 }
-                mask = mask << 1;
             }
+            yoff += yrep;
         }
     } else {
-        // This solid background approach is about 5 time faster
-        uint8_t xc, yc;
-        uint8_t xr, yr;
-        uint8_t mask = 0x01;
-        uint16_t color;
-
         // We need to offset by the origin.
         x += _originx;
         y += _originy;
         int16_t x_char_start = x; // remember our X where we start outputting...
+        int16_t y_char_top = y;   // remember the y
 
         if ((x >= _displayclipx2) ||                   // Clip right
             (y >= _displayclipy2) ||                   // Clip bottom
-            ((x + 6 * size_x - 1) < _displayclipx1) || // Clip left  TODO: this is not correct
-            ((y + 8 * size_y - 1) < _displayclipy1)) { // Clip top   TODO: this is not correct
+            ((x + 6 * size_x - 1) < _displayclipx1) || // Clip left
+            ((y + 8 * size_y - 1) < _displayclipy1)) { // Clip top
             return;
         }
 
         // need to build actual pixel rectangle we will output into.
-        int16_t y_char_top = y; // remember the y
         int16_t w = 6 * size_x;
         int16_t h = 8 * size_y;
 
@@ -791,75 +1683,90 @@ void Teensy_Parallel_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
         }
         if ((y + h - 1) >= _displayclipy2)
             h = _displayclipy2 - y;
+        if ((w <= 0) || (h <= 0)) // empty clip rect
+            return;
 
-#ifdef ENABLE_FRAMEBUFFER
-        if (_use_fbtft) {
-            // use simplified version of drawing the text, using drawRect
-            for (yc = 0; (yc < 8) && (y < _displayclipy2); yc++) {
-                x = x_char_start; // get our first x position...
-                for (xc = 0; xc < 5; xc++) {
-                    if (glcdfont[c * 5 + xc] & mask) {
-                        color = fgcolor;
-                    } else {
-                        color = bgcolor;
-                    }
-                    fillRect(x, y, size_x, size_y, color);
-                    x += size_x;
-                }
-                fillRect(x, y, size_x, size_y, bgcolor);
-                y += size_y;
-                mask = mask << 1;
-            }
+        uint16_t line_colors[w]; // one output row of the visible part of the character
+        uint8_t line_bits = 0xff; // bits currently expanded into line_colors
 
-        } else
+#ifdef ENABLE_FRAMEBUFFER
+        if (!_use_fbtft)
 #endif
         {
             setAddr(x, y, x + w - 1, y + h - 1);
-
-            y = y_char_top; // restore the actual y.
             beginWrite16BitColors();
-            for (yc = 0; (yc < 8) && (y < _displayclipy2); yc++) {
-                for (yr = 0; (yr < size_y) && (y < _displayclipy2); yr++) {
-                    x = x_char_start; // get our first x position...
-                    if (y >= _displayclipy1) {
-                        for (xc = 0; xc < 5; xc++) {
-                            if (glcdfont[c * 5 + xc] & mask) {
-                                color = fgcolor;
-                            } else {
-                                color = bgcolor;
-                            }
-                            for (xr = 0; xr < size_x; xr++) {
-                                if ((x >= _displayclipx1) && (x < _displayclipx2)) {
-                                    write16BitColor(color);
-                                }
-                                x++;
-                            }
-                        }
-                        for (xr = 0; xr < size_x; xr++) {
-                            if ((x >= _displayclipx1) && (x < _displayclipx2)) {
-                                write16BitColor(bgcolor);
-                            }
-                            x++;
-                        }
-                    }
-                    y++;
+        }
+
+        uint8_t yoff = 0;
+        while (yoff < 8) {
+            uint8_t line = rows[yoff];
+            uint8_t yrep = 1;
+            while (((yoff + yrep) < 8) && (rows[yoff + yrep] == line))
+                yrep++;
+
+            // screen rows covered by these glyph rows, clipped to our rectangle
+            int16_t row_y1 = y_char_top + yoff * size_y;
+            int16_t row_y2 = row_y1 + yrep * size_y;
+            if (row_y1 < y)
+                row_y1 = y;
+            if (row_y2 > (y + h))
+                row_y2 = y + h;
+            yoff += yrep;
+            if (row_y1 >= row_y2)
+                continue;
+
+            if (line != line_bits) {
+                // expand the 5 glyph columns plus spacing column, clipped to x..x+w
+                uint16_t *pcolors = line_colors;
+                int16_t col_x = x_char_start;
+                for (uint8_t xc = 0; xc < 6; xc++) {
+                    uint16_t color = (line & (0x10 >> xc)) ? fgcolor : bgcolor;
+                    int16_t x1 = (col_x > x) ? col_x : x;
+                    int16_t x2 = col_x + size_x;
+                    if (x2 > (x + w))
+                        x2 = x + w;
+                    while (x1++ < x2)
+                        *pcolors++ = color;
+                    col_x += size_x;
                 }
-                mask = mask << 1;
+                line_bits = line;
+            }
+
+#ifdef ENABLE_FRAMEBUFFER
+            if (_use_fbtft) {
+                // w_image of 0 outputs the same row for each of the rows.
+                _tpfb->writeRect(x, row_y1, w, row_y2 - row_y1, 0, line_colors);
+                continue;
+            }
+#endif
+            for (; row_y1 < row_y2; row_y1++) {
+                for (int16_t i = 0; i < w; i++)
+                    write16BitColor(line_colors[i]);
             }
         }
+
+#ifdef ENABLE_FRAMEBUFFER
+        if (!_use_fbtft)
+#endif
+        {
+            endWrite16BitColors();
+        }
     }
 }
 
 void Teensy_Parallel_GFX::setFont(const ILI9341_t3_font_t &f) {
+    if (_display_list)
+        _display_list->recordPtr(Teensy_Parallel_DisplayList::DL_SET_FONT_ILI, &f, nullptr, nullptr);
     _gfx_last_char_x_write = 0; // Don't use cached data here
     font = &f;
+    rleFont = nullptr;
     if (gfxFont) {
         cursor_y -= 6;
         gfxFont = NULL;
     }
     fontbpp = 1;
     // Calculate additional metrics for Anti-Aliased font support (BDF extn v2.3)
-    if (font && font->version == 23) {
+    if (font && ((font->version & ~ILI9341_FONT_VERSION_REMAPPED) == 23)) {
         fontbpp = (font->reserved & 0b000011) + 1;
         fontbppindex = (fontbpp >> 2) + 1;
         fontbppmask = (1 << (fontbppindex + 1)) - 1;
@@ -873,7 +1780,10 @@ void Teensy_Parallel_GFX::setFont(const ILI9341_t3_font_t &f) {
 
 // Maybe support GFX Fonts as well?
 void Teensy_Parallel_GFX::setFont(const GFXfont *f) {
+    if (_display_list)
+        _display_list->recordPtr(Teensy_Parallel_DisplayList::DL_SET_FONT_GFX, f, nullptr, nullptr);
     font = NULL;                // turn off the other font...
+    rleFont = nullptr;
     _gfx_last_char_x_write = 0; // Don't use cached data here
     if (f == gfxFont)
         return; // same font or lack of so can bail.
@@ -936,6 +1846,19 @@ void Teensy_Parallel_GFX::setFont(const GFXfont *f) {
     gfxFont = f;
 }
 
+// Run length encoded fonts, see RLE_fonts.h
+void Teensy_Parallel_GFX::setFont(const RLE_font_t &f) {
+    if (_display_list)
+        _display_list->recordPtr(Teensy_Parallel_DisplayList::DL_SET_FONT_RLE, &f, nullptr, nullptr);
+    _gfx_last_char_x_write = 0; // Don't use cached data here
+    font = NULL;
+    if (gfxFont) {
+        cursor_y -= 6;
+        gfxFont = NULL;
+    }
+    rleFont = &f;
+}
+
 uint32_t Teensy_Parallel_GFX::fetchpixel(const uint8_t *p, uint32_t index, uint32_t x) {
     // The byte
     uint8_t b = p[index >> 3];
@@ -979,25 +1902,39 @@ static uint32_t fetchbits_signed(const uint8_t *p, uint32_t index, uint32_t requ
     return (int32_t)val;
 }
 
+// Find the glyph data for c, or nullptr when the font does not have it.
+// Fonts made by the subsetting tool in extras/font_tools are marked with
+// ILI9341_FONT_VERSION_REMAPPED and use unicode as a remap table, so the
+// lookup stays a single table read.
+static const uint8_t *fontGlyphData(const ILI9341_t3_font_t *font, unsigned int c) {
+    uint32_t slot;
+    if ((font->version & ILI9341_FONT_VERSION_REMAPPED) && font->unicode) {
+        if (c < font->index1_first || c > font->index1_last)
+            return nullptr;
+        slot = font->unicode[c - font->index1_first];
+        if (slot == 0)
+            return nullptr;
+        slot--;
+    } else if (c >= font->index1_first && c <= font->index1_last) {
+        slot = c - font->index1_first;
+    } else if (c >= font->index2_first && c <= font->index2_last) {
+        slot = c - font->index2_first + font->index1_last - font->index1_first + 1;
+    } else {
+        return nullptr;
+    }
+    // Serial.printf("  index =  %d\n", fetchbits_unsigned(font->index, slot * font->bits_index, font->bits_index));
+    return font->data + fetchbits_unsigned(font->index, slot * font->bits_index, font->bits_index);
+}
+
 void Teensy_Parallel_GFX::drawFontChar(unsigned int c) {
     uint32_t bitoffset;
     const uint8_t *data;
 
     // Serial.printf("drawFontChar(%c) %d\n", c, c);
 
-    if (c >= font->index1_first && c <= font->index1_last) {
-        bitoffset = c - font->index1_first;
-        bitoffset *= font->bits_index;
-    } else if (c >= font->index2_first && c <= font->index2_last) {
-        bitoffset = c - font->index2_first + font->index1_last - font->index1_first + 1;
-        bitoffset *= font->bits_index;
-    } else if (font->unicode) {
-        return; // TODO: implement sparse unicode
-    } else {
+    data = fontGlyphData(font, c);
+    if (!data)
         return;
-    }
-    // Serial.printf("  index =  %d\n", fetchbits_unsigned(font->index, bitoffset, font->bits_index));
-    data = font->data + fetchbits_unsigned(font->index, bitoffset, font->bits_index);
 
     uint32_t encoding = fetchbits_unsigned(data, 0, 3);
     if (encoding != 0)
@@ -1393,8 +2330,8 @@ void Teensy_Parallel_GFX::drawFontChar(unsigned int c) {
                                     screen_x++; // Current actual screen X
                                 }
                                 // Serial.println();
-                                bitoffset += xsize;
                             }
+                            bitoffset += xsize; // even when the row is clipped
                             x += xsize;
                         } while (x < width);
                         if ((screen_y >= _displayclipy1) && (screen_y < _displayclipy2)) {
@@ -1442,6 +2379,20 @@ int16_t Teensy_Parallel_GFX::strPixelLen(const char *str, uint16_t cb) {
     }
 
     uint16_t len = 0, maxlen = 0;
+    if (rleFont) {
+        while (*str && cb) {
+            uint8_t c = *str++;
+            cb--;
+            if (c == '\n') {
+                len = 0;
+            } else if ((c >= rleFont->first) && (c <= rleFont->last)) {
+                len += rleFont->glyphs[c - rleFont->first].delta;
+                if (len > maxlen)
+                    maxlen = len;
+            }
+        }
+        return maxlen;
+    }
     while (*str && cb) {
         if (*str == '\n') {
             if (len > maxlen) {
@@ -1459,23 +2410,12 @@ int16_t Teensy_Parallel_GFX::strPixelLen(const char *str, uint16_t cb) {
 
                 //				Serial.printf("char %c(%d)\n", c,c);
 
-                if (c >= font->index1_first && c <= font->index1_last) {
-                    bitoffset = c - font->index1_first;
-                    bitoffset *= font->bits_index;
-                } else if (c >= font->index2_first && c <= font->index2_last) {
-                    bitoffset = c - font->index2_first + font->index1_last - font->index1_first + 1;
-                    bitoffset *= font->bits_index;
-                } else if (font->unicode) {
-                    continue;
-                } else {
+                // Skip characters the font does not have (subset fonts leave many out)
+                data = fontGlyphData(font, c);
+                if (!data || (fetchbits_unsigned(data, 0, 3) != 0)) {
+                    str++;
                     continue;
                 }
-                // Serial.printf("  index =  %d\n", fetchbits_unsigned(font->index, bitoffset, font->bits_index));
-                data = font->data + fetchbits_unsigned(font->index, bitoffset, font->bits_index);
-
-                uint32_t encoding = fetchbits_unsigned(data, 0, 3);
-                if (encoding != 0)
-                    continue;
                 //				uint32_t width = fetchbits_unsigned(data, 3, font->bits_width);
                 //				Serial.printf("  width =  %d\n", width);
                 bitoffset = font->bits_width + 3;
@@ -1515,19 +2455,9 @@ void Teensy_Parallel_GFX::charBounds(char c, int16_t *x, int16_t *y,
         } else if (c != '\r') { // Not a carriage return; is normal char
             uint32_t bitoffset;
             const uint8_t *data;
-            if (c >= font->index1_first && c <= font->index1_last) {
-                bitoffset = c - font->index1_first;
-                bitoffset *= font->bits_index;
-            } else if (c >= font->index2_first && c <= font->index2_last) {
-                bitoffset = c - font->index2_first + font->index1_last - font->index1_first + 1;
-                bitoffset *= font->bits_index;
-            } else if (font->unicode) {
-                return; // TODO: implement sparse unicode
-            } else {
+            data = fontGlyphData(font, c);
+            if (!data)
                 return;
-            }
-            // Serial.printf("  index =  %d\n", fetchbits_unsigned(font->index, bitoffset, font->bits_index));
-            data = font->data + fetchbits_unsigned(font->index, bitoffset, font->bits_index);
 
             uint32_t encoding = fetchbits_unsigned(data, 0, 3);
             if (encoding != 0)
@@ -1572,6 +2502,32 @@ void Teensy_Parallel_GFX::charBounds(char c, int16_t *x, int16_t *y,
         }
     }
 
+    else if (rleFont) {
+        if (c == '\n') { // Newline?
+            *x = 0;      // Reset x to zero, advance y by one line
+            *y += rleFont->line_space;
+        } else if ((c != '\r') && ((uint8_t)c >= rleFont->first) && ((uint8_t)c <= rleFont->last)) {
+            const RLE_glyph_t *glyph = &rleFont->glyphs[(uint8_t)c - rleFont->first];
+            if (wrap && ((*x + glyph->xoffset + glyph->width) > _width)) {
+                *x = 0; // Reset x to zero, advance y by one line
+                *y += rleFont->line_space;
+            }
+            int16_t x1 = *x + glyph->xoffset,
+                    y1 = *y + glyph->yoffset,
+                    x2 = x1 + glyph->width - 1,
+                    y2 = y1 + glyph->height - 1;
+            if (x1 < *minx)
+                *minx = x1;
+            if (y1 < *miny)
+                *miny = y1;
+            if (x2 > *maxx)
+                *maxx = x2;
+            if (y2 > *maxy)
+                *maxy = y2;
+            *x += glyph->delta;
+        }
+    }
+
     else if (gfxFont) {
 
         if (c == '\n') { // Newline?
@@ -2085,6 +3041,115 @@ void Teensy_Parallel_GFX::drawGFXFontChar(unsigned int c) {
     cursor_x += glyph->xAdvance * (int16_t)textsize_x;
 }
 
+//=============================================================================
+// Run length encoded fonts (see RLE_fonts.h)
+// Each run goes out as one fillRect, and rows that repeat the previous row are
+// merged into the same fillRect, so big glyphs only cost a few span writes per
+// row instead of a bit fetch per pixel.
+//=============================================================================
+void Teensy_Parallel_GFX::drawRLEFontChar(unsigned int c) {
+    if ((c < rleFont->first) || (c > rleFont->last))
+        return;
+    const RLE_glyph_t *glyph = &rleFont->glyphs[c - rleFont->first];
+    const uint8_t *data = rleFont->data + glyph->data_offset;
+
+    if (wrap && ((cursor_x + glyph->xoffset + glyph->width) > _width)) {
+        cursor_x = (scrollEnable && isWritingScrollArea) ? scroll_x : 0;
+        cursor_y += rleFont->line_space;
+    }
+    if (scrollEnable && isWritingScrollArea && (cursor_y > (scroll_y + scroll_height - rleFont->cap_height))) {
+        scrollTextArea(rleFont->line_space);
+        cursor_y -= rleFont->line_space;
+        cursor_x = scroll_x;
+    }
+
+    int16_t origin_x = cursor_x + glyph->xoffset;
+    int16_t origin_y = cursor_y + glyph->yoffset;
+    int16_t glyph_w = glyph->width;
+    int16_t glyph_h = glyph->height;
+    bool opaque = (textcolor != textbgcolor);
+
+    if (opaque) {
+        // Fill the parts of the character cell that the bitmap does not cover.
+        int16_t cell_x1 = (origin_x < cursor_x) ? origin_x : cursor_x;
+        int16_t cell_x2 = cursor_x + glyph->delta;
+        if ((origin_x + glyph_w) > cell_x2)
+            cell_x2 = origin_x + glyph_w;
+        int16_t cell_y1 = (origin_y < cursor_y) ? origin_y : cursor_y;
+        int16_t cell_y2 = cursor_y + rleFont->line_space;
+        if ((origin_y + glyph_h) > cell_y2)
+            cell_y2 = origin_y + glyph_h;
+
+        if (origin_y > cell_y1)
+            fillRect(cell_x1, cell_y1, cell_x2 - cell_x1, origin_y - cell_y1, textbgcolor);
+        if ((origin_y + glyph_h) < cell_y2)
+            fillRect(cell_x1, origin_y + glyph_h, cell_x2 - cell_x1, cell_y2 - (origin_y + glyph_h), textbgcolor);
+        if (origin_x > cell_x1)
+            fillRect(cell_x1, origin_y, origin_x - cell_x1, glyph_h, textbgcolor);
+        if ((origin_x + glyph_w) < cell_x2)
+            fillRect(origin_x + glyph_w, origin_y, cell_x2 - (origin_x + glyph_w), glyph_h, textbgcolor);
+    }
+
+    const uint8_t *runs = data;
+    uint8_t count = 0;
+    int16_t y = origin_y;
+    int16_t row = 0;
+    while (row < glyph_h) {
+        uint8_t row_count = *data++;
+        if (row_count != RLE_FONT_ROW_REPEAT) {
+            runs = data;
+            count = row_count;
+            data += count * 2; // skip and length bytes
+        }
+        // Merge in any following rows that are the same
+        int16_t rows = 1;
+        while (((row + rows) < glyph_h) && (*data == RLE_FONT_ROW_REPEAT)) {
+            data++;
+            rows++;
+        }
+        if ((y + _originy) >= _displayclipy2)
+            break; // rest of the character is below the clip rectangle
+        if ((y + rows + _originy) > _displayclipy1)
+            drawRLEFontRow(runs, count, origin_x, y, glyph_w, rows, opaque);
+        y += rows;
+        row += rows;
+    }
+
+    // Increment to setup for the next character.
+    cursor_x += glyph->delta;
+}
+
+void Teensy_Parallel_GFX::drawRLEFontRow(const uint8_t *runs, uint8_t count, int16_t x, int16_t y,
+                                         int16_t w, int16_t rows, bool opaque) {
+    int16_t x_end = x + w;
+    uint8_t bpp = rleFont->bpp;
+    uint8_t alpha_max = (1 << bpp) - 1;
+    // with alpha it is in the top bits of the length
+    uint8_t len_mask = (bpp > 1) ? (0xFF >> bpp) : 0xFF;
+
+    while (count--) {
+        uint8_t skip = *runs++;
+        uint8_t len = *runs & len_mask;
+        uint8_t alpha = (bpp > 1) ? (*runs >> (8 - bpp)) : alpha_max;
+        runs++;
+        if (skip && opaque)
+            fillRect(x, y, skip, rows, textbgcolor);
+        x += skip;
+        if (alpha == alpha_max) {
+            fillRect(x, y, len, rows, textcolor);
+        } else if (opaque) {
+            fillRect(x, y, len, rows, alphaBlendRGB565Premultiplied(textcolorPrexpanded, textbgcolorPrexpanded,
+                                                                    (alpha * 32 + (alpha_max >> 1)) / alpha_max));
+        } else if (alpha >= (1 << (bpp - 1))) {
+            // Like the anti-aliased ILI fonts, transparent mode only draws pixels over half alpha.
+            fillRect(x, y, len, rows, textcolor);
+        }
+        x += len;
+    }
+    if (opaque && (x < x_end))
+        fillRect(x, y, x_end - x, rows, textbgcolor);
+}
+
 // Some fonts overlap characters if we detect that the previous
 // character wrote out more width than they advanced in X direction
 // we may want to know if the last character output a FG or BG at a position.
@@ -2117,6 +3182,8 @@ bool Teensy_Parallel_GFX::gfxFontLastCharPosFG(int16_t x, int16_t y) {
 }
 
 void Teensy_Parallel_GFX::setCursor(int16_t x, int16_t y, bool autoCenter) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_CURSOR, x, y, autoCenter);
     _center_x_text = autoCenter; // remember the state.
     _center_y_text = autoCenter; // remember the state.
     if (x == Teensy_Parallel_GFX::CENTER) {
@@ -2152,6 +3219,8 @@ void Teensy_Parallel_GFX::getCursor(int16_t *x, int16_t *y) {
 }
 
 void Teensy_Parallel_GFX::setTextSize(uint8_t s_x, uint8_t s_y) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_TEXT_SIZE, s_x, s_y);
     textsize_x = (s_x > 0) ? s_x : 1;
     textsize_y = (s_y > 0) ? s_y : 1;
     _gfx_last_char_x_write = 0; // Don't use cached data here
@@ -2162,12 +3231,16 @@ uint8_t Teensy_Parallel_GFX::getTextSize() {
 }
 
 void Teensy_Parallel_GFX::setTextColor(uint16_t c) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_TEXT_COLOR, c);
     // For 'transparent' background, we'll set the bg
     // to the same as fg instead of using a flag
     textcolor = textbgcolor = c;
 }
 
 void Teensy_Parallel_GFX::setTextColor(uint16_t c, uint16_t b) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_TEXT_COLOR_BG, c, b);
     textcolor = c;
     textbgcolor = b;
     // pre-expand colors for fast alpha-blending later
@@ -2176,6 +3249,8 @@ void Teensy_Parallel_GFX::setTextColor(uint16_t c, uint16_t b) {
 }
 
 void Teensy_Parallel_GFX::setTextWrap(boolean w) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_TEXT_WRAP, w);
     wrap = w;
 }
 
@@ -2207,6 +3282,8 @@ void Teensy_Parallel_GFX::sleep(bool enable) {
 ** Description:             Set the text position reference datum
 ***************************************************************************************/
 void Teensy_Parallel_GFX::setTextDatum(uint8_t d) {
+    if (_display_list)
+        _display_list->record(Teensy_Parallel_DisplayList::DL_SET_TEXT_DATUM, d);
     textdatum = d;
 }
 
@@ -2391,6 +3468,7 @@ int16_t Teensy_Parallel_GFX::drawString(const char string[], int16_t len, int po
 void Teensy_Parallel_GFX::writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h,
                                         const uint8_t *pixels,
                                         const uint16_t *palette) {
+    DL_RECORD_PTR(DL_WRITE_RECT_8BPP, pixels, palette, x, y, w, h);
     // Serial.printf("\nWR8: %d %d %d %d %x\n", x, y, w, h, (uint32_t)pixels);
     x += _originx;
     y += _originy;
@@ -2507,6 +3585,7 @@ void Teensy_Parallel_GFX::writeRect1BPP(int16_t x, int16_t y, int16_t w, int16_t
 void Teensy_Parallel_GFX::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t h,
                                         uint8_t bits_per_pixel, const uint8_t *pixels,
                                         const uint16_t *palette) {
+    DL_RECORD_PTR(DL_WRITE_RECT_NBPP, pixels, palette, x, y, w, h, bits_per_pixel);
     // Serial.printf("\nWR8: %d %d %d %d %x\n", x, y, w, h, (uint32_t)pixels);
     x += _originx;
     y += _originy;
@@ -2587,94 +3666,417 @@ void Teensy_Parallel_GFX::writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t
     endWrite16BitColors();
 }
 
-// fillRectVGradient	- fills area with vertical gradient
-void Teensy_Parallel_GFX::fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h,
-                                            uint16_t color1, uint16_t color2) {
+///============================================================================
+// drawRLEImage - 	draw a run length encoded image, see RLE_images.h
+//  Rows that repeat are drawn together, so a solid area is one fill.
+void Teensy_Parallel_GFX::drawRLEImage(int16_t x, int16_t y, const RLE_image_t &image) {
+    DL_RECORD_PTR(DL_DRAW_RLE_IMAGE, &image, nullptr, x, y);
     x += _originx;
     y += _originy;
-
-    // Rectangular clipping
     if ((x >= _displayclipx2) || (y >= _displayclipy2))
         return;
-    if (x < _displayclipx1) {
-        w -= (_displayclipx1 - x);
-        x = _displayclipx1;
-    }
-    if (y < _displayclipy1) {
-        h -= (_displayclipy1 - y);
-        y = _displayclipy1;
+    if (((x + image.width) <= _displayclipx1) || ((y + image.height) <= _displayclipy1))
+        return;
+
+    const uint8_t *data = image.data;
+    int16_t row = 0;
+    while ((row < image.height) && (y < _displayclipy2)) {
+        const uint8_t *runs = data;
+        // Walk past the row, then merge in any following rows that are the same
+        data = drawRLEImageRow(runs, x, y, 1, image.palette, false);
+        int16_t rows = 1;
+        while (((row + rows) < image.height) && (*data == RLE_IMAGE_ROW_REPEAT)) {
+            data++;
+            rows++;
+        }
+        int16_t y_draw = max(y, _displayclipy1);
+        int16_t y_end = min((int16_t)(y + rows), _displayclipy2);
+        if (y_end > y_draw)
+            drawRLEImageRow(runs, x, y_draw, y_end - y_draw, image.palette, true);
+        y += rows;
+        row += rows;
     }
-    if ((x + w - 1) >= _displayclipx2)
-        w = _displayclipx2 - x;
-    if ((y + h - 1) >= _displayclipy2)
-        h = _displayclipy2 - y;
+}
+
+// Draw one row of runs rows times, x and y are display coordinates and y is
+// already clipped.  Returns where the next row starts.
+const uint8_t *Teensy_Parallel_GFX::drawRLEImageRow(const uint8_t *runs, int16_t x, int16_t y, int16_t rows,
+                                                    const uint16_t *palette, bool draw) {
+    uint8_t color_size = palette ? 1 : 2;
+    for (;;) {
+        uint8_t op = *runs++;
+        if (op == RLE_IMAGE_END_ROW)
+            return runs;
+        uint16_t len = op & 0x3f;
+        if (!len) {
+            len = runs[0] | (runs[1] << 8);
+            runs += 2;
+        }
+        op &= 0xc0;
+        const uint8_t *colors = runs;
+        if (op == RLE_IMAGE_FILL)
+            runs += color_size;
+        else if (op == RLE_IMAGE_COPY)
+            runs += len * color_size;
+        if (!draw || (op == RLE_IMAGE_SKIP)) {
+            x += len;
+            continue;
+        }
 
-    uint8_t r1, g1, b1, r2, g2, b2;
-    int dr, dg, db, r, g, b;
-    
-    color565toRGB(color1, r1, g1, b1);
-    color565toRGB(color2, r2, g2, b2);
-    
-    dr = (r2 - r1);
-    dg = (g2 - g1);
-    db = (b2 - b1);
-    r = r1;
-    g = g1;
-    b = b1;
+        // Clip the run
+        int16_t x_run = x;
+        x += len;
+        if ((x_run >= _displayclipx2) || (x <= _displayclipx1))
+            continue;
+        uint16_t skip = 0;
+        if (x_run < _displayclipx1) {
+            skip = _displayclipx1 - x_run;
+            x_run = _displayclipx1;
+        }
+        int16_t w = min(x, _displayclipx2) - x_run;
 
+        if (op == RLE_IMAGE_FILL) {
+            uint16_t color = palette ? palette[*colors] : (colors[0] | (colors[1] << 8));
 #ifdef ENABLE_FRAMEBUFFER
-    if (_use_fbtft) {
-        for (int ih = 1; ih < h; ih++) {
-            if (_bitDepth == 24) {
-                _tpfb->drawFastHLine24(x, y, w, color888(r, g, b));
-            } else {    
-                _tpfb->drawFastHLine(x, y, w, color565(r, g, b));
-            }
-            r = r1 + (dr * ih) / h;
-            g = g1 + (dg * ih) / h;
-            b = b1 + (db * ih) / h;
-            y++;
+            if (_use_fbtft)
+                _tpfb->fillRect(x_run, y, w, rows, color);
+            else
+#endif
+                fillRectFlexIO(x_run, y, w, rows, color);
+            continue;
+        }
+
+        // COPY, an image stride of 0 repeats the row
+        colors += skip * color_size;
+#ifdef ENABLE_FRAMEBUFFER
+        if (_use_fbtft && palette) {
+            _tpfb->writeRect8BPP(x_run, y, w, rows, 0, colors, palette);
+            continue;
         }
-        _tpfb->drawFastHLine(x, y, w, color2);
-    } else
 #endif
-    {
-        setAddr(x, y, x + w - 1, y + h - 1);
-        beginWrite16BitColors();
-        for (int ih = 1; ih < h; ih++) {
-            if (_bitDepth == 24) {
-                uint32_t color = color888(r, g, b);
-
-                for (x = w; x > 1; x--) {
-                    write24BitColor(color);
-                }
-            } else {    
-                uint16_t color = color565(r, g, b);
-                for (x = w; x > 1; x--) {
-                    write16BitColor(color);
+        uint16_t pcolors[w];
+        if (palette) {
+            for (int16_t i = 0; i < w; i++)
+                pcolors[i] = palette[colors[i]];
+        } else {
+            memcpy(pcolors, colors, w * 2); // the runs are not aligned
+        }
+#ifdef ENABLE_FRAMEBUFFER
+        if (_use_fbtft) {
+            _tpfb->writeRect(x_run, y, w, rows, 0, pcolors);
+            continue;
+        }
+#endif
+        for (int16_t iy = 0; iy < rows; iy++)
+            writeRectFlexIO(x_run, y + iy, w, 1, pcolors);
+    }
+}
+
+///============================================================================
+// drawImageScaled - 	draw a whole image stretched (or shrunk) to w x h
+void Teensy_Parallel_GFX::drawImageScaled(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors,
+                                          int16_t image_width, int16_t image_height, uint8_t filter,
+                                          bool keyed, uint16_t key_color) {
+    DL_RECORD_PTR(DL_DRAW_IMAGE_SCALED, pcolors, nullptr, x, y, w, h, image_width, image_height, filter, keyed,
+                  key_color);
+    if ((w < 1) || (h < 1) || (image_width < 1) || (image_height < 1))
+        return;
+    if (x == CENTER)
+        x = (_width - w) / 2;
+    if (y == CENTER)
+        y = (_height - h) / 2;
+    x += _originx;
+    y += _originy;
+
+    // x + w can be past what an int16_t holds
+    int32_t x1 = max((int32_t)x, (int32_t)_displayclipx1);
+    int32_t y1 = max((int32_t)y, (int32_t)_displayclipy1);
+    int32_t x2 = min((int32_t)x + w, (int32_t)_displayclipx2);
+    int32_t y2 = min((int32_t)y + h, (int32_t)_displayclipy2);
+    if ((x1 >= x2) || (y1 >= y2))
+        return;
+
+    // 16.16 steps through the image, starting in the middle of the first pixel.
+    // The clipped start is inside the image, but getting there from far off
+    // screen needs 64 bits.
+    int32_t du = ((int32_t)image_width << 16) / w;
+    int32_t dv = ((int32_t)image_height << 16) / h;
+    int32_t u = du / 2 + (int64_t)(x1 - x) * du;
+    int32_t v = dv / 2 + (int64_t)(y1 - y) * dv;
+    drawImageMapped(x1, y1, x2, y2, u, v, du, 0, 0, dv, pcolors, image_width, image_height, filter, keyed,
+                    key_color);
+}
+
+// drawImageRotated - 	draw an image turned around the pivot pixel
+void Teensy_Parallel_GFX::drawImageRotated(int16_t x, int16_t y, const uint16_t *pcolors, int16_t image_width,
+                                           int16_t image_height, int16_t pivot_x, int16_t pivot_y, float angle,
+                                           uint8_t filter, bool keyed, uint16_t key_color) {
+    // The angle is recorded as the two halves of the float
+    uint32_t angle_bits;
+    memcpy(&angle_bits, &angle, sizeof(angle_bits));
+    DL_RECORD_PTR(DL_DRAW_IMAGE_ROTATED, pcolors, nullptr, x, y, image_width, image_height, pivot_x, pivot_y,
+                  (int16_t)angle_bits, (int16_t)(angle_bits >> 16), filter, keyed, key_color);
+    if ((image_width < 1) || (image_height < 1))
+        return;
+    x += _originx;
+    y += _originy;
+
+    float radians = angle * (float)(M_PI / 180.0);
+    float c = cosf(radians);
+    float s = sinf(radians);
+
+    // Where the corners of the image end up, relative to (x, y)
+    float min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+    for (uint8_t corner = 0; corner < 4; corner++) {
+        float u = ((corner & 1) ? image_width : 0) - (pivot_x + 0.5f);
+        float v = ((corner & 2) ? image_height : 0) - (pivot_y + 0.5f);
+        float cx = c * u - s * v;
+        float cy = s * u + c * v;
+        if (!corner || (cx < min_x))
+            min_x = cx;
+        if (!corner || (cx > max_x))
+            max_x = cx;
+        if (!corner || (cy < min_y))
+            min_y = cy;
+        if (!corner || (cy > max_y))
+            max_y = cy;
+    }
+    int32_t x1 = max((int32_t)x + (int32_t)floorf(min_x), (int32_t)_displayclipx1);
+    int32_t y1 = max((int32_t)y + (int32_t)floorf(min_y), (int32_t)_displayclipy1);
+    int32_t x2 = min((int32_t)x + (int32_t)ceilf(max_x) + 1, (int32_t)_displayclipx2);
+    int32_t y2 = min((int32_t)y + (int32_t)ceilf(max_y) + 1, (int32_t)_displayclipy2);
+    if ((x1 >= x2) || (y1 >= y2))
+        return;
+
+    // Map the middle of display pixel (x1, y1) back into the image, the pivot
+    // pixel's middle is on the middle of (x, y)
+    int32_t cf = lroundf(c * 65536.0f);
+    int32_t sf = lroundf(s * 65536.0f);
+    int32_t dx = x1 - x;
+    int32_t dy = y1 - y;
+    int32_t u = ((int32_t)pivot_x << 16) + 0x8000 + cf * dx + sf * dy;
+    int32_t v = ((int32_t)pivot_y << 16) + 0x8000 - sf * dx + cf * dy;
+    drawImageMapped(x1, y1, x2, y2, u, v, cf, -sf, sf, cf, pcolors, image_width, image_height, filter, keyed,
+                    key_color);
+}
+
+// 565 colors spread out as 00000gggggg00000rrrrr000000bbbbb, so the fields can
+// be weighted together without running into each other
+static inline uint32_t spread565(uint16_t color) {
+    return (color | ((uint32_t)color << 16)) & 0x07E0F81F;
+}
+static inline uint32_t lerpSpread565(uint32_t a, uint32_t b, uint8_t f) {
+    return ((a * (32 - f) + b * f) >> 5) & 0x07E0F81F;
+}
+
+static inline int32_t floorDiv(int32_t a, int32_t b) {
+    return (a < 0) ? -((b - 1 - a) / b) : a / b;
+}
+
+// Narrow [start, end) down to the steps i where value + i * step is in [0, limit)
+static void imageSpan(int32_t value, int32_t step, int32_t limit, int32_t &start, int32_t &end) {
+    int32_t first, last;
+    if (step == 0) {
+        if ((value < 0) || (value >= limit))
+            end = start;
+        return;
+    }
+    if (step > 0) {
+        first = -floorDiv(value, step);
+        last = floorDiv(limit - 1 - value, step);
+    } else {
+        first = -floorDiv(limit - 1 - value, -step);
+        last = floorDiv(value, -step);
+    }
+    if (first > start)
+        start = first;
+    if (last + 1 < end)
+        end = last + 1;
+    if (end < start)
+        end = start;
+}
+
+// Fill the display rect (x1, y1) - (x2, y2) from the image. u, v is where the
+// middle of pixel (x1, y1) is in the image, in 16.16 image pixels, and it
+// steps by du_dx, dv_dx along a row and du_dy, dv_dy down.  Only the part of
+// each row that lands inside the image is drawn, as runs between keyed pixels.
+void Teensy_Parallel_GFX::drawImageMapped(int16_t x1, int16_t y1, int16_t x2, int16_t y2, int32_t u, int32_t v,
+                                          int32_t du_dx, int32_t dv_dx, int32_t du_dy, int32_t dv_dy,
+                                          const uint16_t *pcolors, int16_t image_width, int16_t image_height,
+                                          uint8_t filter, bool keyed, uint16_t key_color) {
+    int32_t u_limit = (int32_t)image_width << 16;
+    int32_t v_limit = (int32_t)image_height << 16;
+    bool bilinear = filter == IMAGE_BILINEAR;
+    // Scaling up without filtering draws the same row until v gets to the
+    // next image row, so those are written once
+    bool repeat_rows = !bilinear && !dv_dx && !du_dy;
+    uint16_t line_colors[x2 - x1];
+
+    for (int16_t y = y1; y < y2;) {
+        int16_t rows = 1;
+        if (repeat_rows) {
+            while (((y + rows) < y2) && (((v + rows * dv_dy) >> 16) == (v >> 16)))
+                rows++;
+        }
+        int32_t start = 0;
+        int32_t end = x2 - x1;
+        imageSpan(u, du_dx, u_limit, start, end);
+        imageSpan(v, dv_dx, v_limit, start, end);
+
+        int32_t su = u + start * du_dx;
+        int32_t sv = v + start * dv_dx;
+        int32_t run = start; // first pixel not written yet
+        for (int32_t i = start; i < end; i++, su += du_dx, sv += dv_dx) {
+            uint16_t color = pcolors[(sv >> 16) * image_width + (su >> 16)];
+            if (keyed && (color == key_color)) {
+                if (i > run)
+                    writeImageRun(x1 + run, y, i - run, rows, line_colors + run);
+                run = i + 1;
+                continue;
+            }
+            if (bilinear) {
+                // The 4 pixels around the sample point, held at the edges
+                int32_t bu = su - 0x8000;
+                int32_t bv = sv - 0x8000;
+                int16_t ix = bu >> 16;
+                int16_t iy = bv >> 16;
+                int16_t ix0 = (ix < 0) ? 0 : ix;
+                int16_t ix1 = (ix + 1 < image_width) ? ix + 1 : image_width - 1;
+                const uint16_t *row0 = pcolors + ((iy < 0) ? 0 : iy) * image_width;
+                const uint16_t *row1 = pcolors + ((iy + 1 < image_height) ? iy + 1 : image_height - 1) * image_width;
+                uint16_t c00 = row0[ix0], c01 = row0[ix1], c10 = row1[ix0], c11 = row1[ix1];
+                if (keyed) {
+                    // keyed neighbours take the nearest color, so there is no fringe
+                    if (c00 == key_color) c00 = color;
+                    if (c01 == key_color) c01 = color;
+                    if (c10 == key_color) c10 = color;
+                    if (c11 == key_color) c11 = color;
                 }
+                uint8_t fx = (bu >> 11) & 31;
+                uint8_t fy = (bv >> 11) & 31;
+                uint32_t blend = lerpSpread565(lerpSpread565(spread565(c00), spread565(c01), fx),
+                                               lerpSpread565(spread565(c10), spread565(c11), fx), fy);
+                color = blend | (blend >> 16);
             }
-            r = r1 + (dr * ih) / h;
-            g = g1 + (dg * ih) / h;
-            b = b1 + (db * ih) / h;
+            line_colors[i] = color;
         }
-        // output last line as the 2nd color
-        for (x = w; x > 1; x--) {
-            write16BitColor(color2);
-        }
-        endWrite16BitColors();
+        if (end > run)
+            writeImageRun(x1 + run, y, end - run, rows, line_colors + run);
+
+        u += du_dy * rows;
+        v += dv_dy * rows;
+        y += rows;
+    }
+}
+
+// Write a span of colors rows times, already clipped
+void Teensy_Parallel_GFX::writeImageRun(int16_t x, int16_t y, int16_t w, int16_t rows, const uint16_t *pcolors) {
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        _tpfb->writeRect(x, y, w, rows, 0, pcolors);
+        return;
     }
+#endif
+    for (int16_t iy = 0; iy < rows; iy++)
+        writeRectFlexIO(x, y + iy, w, 1, pcolors);
+}
+
+// fillRectVGradient	- fills area with vertical gradient
+void Teensy_Parallel_GFX::fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h,
+                                            uint16_t color1, uint16_t color2) {
+    DL_RECORD(DL_FILL_RECT_VGRADIENT, x, y, w, h, color1, color2);
+    const uint16_t colors[2] = {color1, color2};
+    fillRectGradient(x, y, w, h, colors, nullptr, 2, true);
 }
 
 // fillRectHGradient	- fills area with horizontal gradient
 void Teensy_Parallel_GFX::fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h,
                                             uint16_t color1, uint16_t color2) {
-    x += _originx;
-    y += _originy;
+    DL_RECORD(DL_FILL_RECT_HGRADIENT, x, y, w, h, color1, color2);
+    const uint16_t colors[2] = {color1, color2};
+    fillRectGradient(x, y, w, h, colors, nullptr, 2, false);
+}
 
-    // Rectangular clipping
-    if ((x >= _displayclipx2) || (y >= _displayclipy2))
+// fillRectLinearGradient	- fills area with a gradient through count colors
+void Teensy_Parallel_GFX::fillRectLinearGradient(int16_t x, int16_t y, int16_t w, int16_t h,
+                                                 const uint16_t *colors, const uint8_t *stops, uint8_t count,
+                                                 bool vertical) {
+    DL_RECORD_PTR(DL_FILL_RECT_LINEAR_GRADIENT, colors, stops, x, y, w, h, count, vertical);
+    fillRectGradient(x, y, w, h, colors, stops, count, vertical);
+}
+
+// fillRectRadialGradient	- fills area with a gradient going out from cx, cy
+void Teensy_Parallel_GFX::fillRectRadialGradient(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy,
+                                                 int16_t radius, uint16_t color1, uint16_t color2) {
+    DL_RECORD(DL_FILL_RECT_RADIAL_GRADIENT, x, y, w, h, cx, cy, radius, color1, color2);
+    const uint16_t colors[2] = {color1, color2};
+    fillRectRadial(x, y, w, h, cx, cy, radius, colors, nullptr, 2);
+}
+
+void Teensy_Parallel_GFX::fillRectRadialGradient(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy,
+                                                 int16_t radius, const uint16_t *colors, const uint8_t *stops,
+                                                 uint8_t count) {
+    DL_RECORD_PTR(DL_FILL_RECT_RADIAL_GRADIENT_STOPS, colors, stops, x, y, w, h, cx, cy, radius, count);
+    fillRectRadial(x, y, w, h, cx, cy, radius, colors, stops, count);
+}
+
+// Colors first .. first + count - 1 of a gradient length positions long, as
+// XRGB.  Each stretch between two stops is stepped in 16.16 fixed point, so
+// there is no divide per position.  Position 0 is colors[0] and length - 1 the
+// last color, stops (0-255, in order) place the colors along the way, nullptr
+// spaces them evenly.
+void Teensy_Parallel_GFX::gradientRamp(uint32_t *ramp, int32_t first, int16_t count, int32_t length,
+                                       const uint16_t *colors, const uint8_t *stops, uint8_t stop_count) {
+    if ((count < 1) || (stop_count < 1))
         return;
+    int32_t last = max(length - 1, (int32_t)0);
+    int32_t pos = first;
+    int32_t end = first + count;
+    uint8_t r, g, b;
+
+    // before the first stop
+    int32_t p0 = stops ? (stops[0] * last + 127) / 255 : 0;
+    color565toRGB(colors[0], r, g, b);
+    for (; (pos < end) && (pos < p0); pos++)
+        *ramp++ = color888(r, g, b);
+
+    for (uint8_t i = 1; (i < stop_count) && (pos < end); i++) {
+        int32_t p1 = stops ? (stops[i] * last + 127) / 255 : (i * last) / (stop_count - 1);
+        if (p1 > pos) {
+            uint8_t r1, g1, b1, r2, g2, b2;
+            color565toRGB(colors[i - 1], r1, g1, b1);
+            color565toRGB(colors[i], r2, g2, b2);
+            int32_t span = p1 - p0;
+            int32_t dr = (r2 - r1) * 65536 / span;
+            int32_t dg = (g2 - g1) * 65536 / span;
+            int32_t db = (b2 - b1) * 65536 / span;
+            // skip to pos, once per stretch
+            int32_t skip = pos - p0;
+            int32_t rf = (r1 << 16) + 0x8000 + (int32_t)((int64_t)dr * skip);
+            int32_t gf = (g1 << 16) + 0x8000 + (int32_t)((int64_t)dg * skip);
+            int32_t bf = (b1 << 16) + 0x8000 + (int32_t)((int64_t)db * skip);
+            for (int32_t stop_end = min(p1, end); pos < stop_end; pos++) {
+                *ramp++ = color888(rf >> 16, gf >> 16, bf >> 16);
+                rf += dr;
+                gf += dg;
+                bf += db;
+            }
+        }
+        p0 = p1;
+    }
+
+    // the last stop and past it
+    color565toRGB(colors[stop_count - 1], r, g, b);
+    for (; pos < end; pos++)
+        *ramp++ = color888(r, g, b);
+}
+
+// Gradients are clipped after the ramp positions are worked out, so what is
+// drawn doesn't depend on the clip rectangle (or band) it is drawn through.
+// Returns false when nothing is visible.
+bool Teensy_Parallel_GFX::clipGradientRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) {
+    if ((x >= _displayclipx2) || (y >= _displayclipy2) || ((x + w) <= _displayclipx1) || ((y + h) <= _displayclipy1))
+        return false;
     if (x < _displayclipx1) {
         w -= (_displayclipx1 - x);
         x = _displayclipx1;
@@ -2683,68 +4085,168 @@ void Teensy_Parallel_GFX::fillRectHGradient(int16_t x, int16_t y, int16_t w, int
         h -= (_displayclipy1 - y);
         y = _displayclipy1;
     }
-    if ((x + w - 1) >= _displayclipx2)
+    if ((x + w) > _displayclipx2)
         w = _displayclipx2 - x;
-    if ((y + h - 1) >= _displayclipy2)
+    if ((y + h) > _displayclipy2)
         h = _displayclipy2 - y;
-    if ((w < 1) || (h < 1)) return; // nothing to do
-
-    uint8_t r1, g1, b1, r2, g2, b2;
-    int dr, dg, db, r, g, b;
-    
-    color565toRGB(color1, r1, g1, b1);
-    color565toRGB(color2, r2, g2, b2);
-    
-    dr = (r2 - r1);
-    dg = (g2 - g1);
-    db = (b2 - b1);
-    r = r1;
-    g = g1;
-    b = b1;
+    return (w > 0) && (h > 0);
+}
 
+// Does gradient output end up as 565 (and so get dithered when asked)?
+bool Teensy_Parallel_GFX::gradientTo565() {
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft)
+        return _tpfb->dataWidth() <= 16;
+#endif
+    return _bitDepth != 24;
+}
+
+// One row of XRGB gradient colors, x, y, w already clipped.  err is for
+// Floyd-Steinberg dithering.
+void Teensy_Parallel_GFX::writeGradientRow(int16_t x, int16_t y, int16_t w, const uint32_t *row, int16_t *err) {
+    if (!gradientTo565()) {
+#ifdef ENABLE_FRAMEBUFFER
+        if (_use_fbtft) {
+            _tpfb->writeRect24(x, y, w, 1, w, row);
+            return;
+        }
+#endif
+        writeRect24BPPFlexIO(x, y, w, 1, w, row);
+        return;
+    }
+    uint16_t line_colors[w];
+    Teensy_Parallel_Convert::convertRowXRGBTo565Dither(row, line_colors, w, _dither, x, y, err);
 #ifdef ENABLE_FRAMEBUFFER
     if (_use_fbtft) {
-        // start at 1 as we want to output the final one at the end...    
-        for (int iw = 1; iw < w; iw++) {
-            if (_bitDepth == 24) {
-                uint32_t color = color888(r, g, b);
-                //Serial.printf("RRHG(24) %u: %x %x %x = %x\n", iw, r, g, b, color);
-                _tpfb->drawFastVLine24(x, y, h, color);
-            } else {    
-                uint16_t color = color565(r, g, b);
-                _tpfb->drawFastVLine(x, y, h, color);
+        _tpfb->writeRect(x, y, w, 1, w, line_colors);
+        return;
+    }
+#endif
+    writeRectFlexIO(x, y, w, 1, line_colors);
+}
+
+void Teensy_Parallel_GFX::fillRectGradient(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *colors,
+                                           const uint8_t *stops, uint8_t count, bool vertical) {
+    if (!count)
+        return;
+    x += _originx;
+    y += _originy;
+    int16_t x0 = x, y0 = y, w0 = w, h0 = h; // the whole gradient
+    if (!clipGradientRect(x, y, w, h))
+        return;
+
+    bool to565 = gradientTo565();
+    bool dither = to565 && (_dither != Teensy_Parallel_Convert::DITHER_NONE);
+    int16_t err[dither ? 3 * (w + 2) : 1];
+    memset(err, 0, sizeof(err));
+
+    if (vertical) {
+        // One color a row, runs of rows that come out the same are one fill
+        uint32_t ramp[h];
+        gradientRamp(ramp, y - y0, h, h0, colors, stops, count);
+        if (dither) {
+            uint32_t row[w];
+            for (int16_t iy = 0; iy < h; iy++) {
+                for (int16_t ix = 0; ix < w; ix++)
+                    row[ix] = ramp[iy];
+                writeGradientRow(x, y + iy, w, row, err);
             }
-            r = r1 + (dr * iw) / w;
-            g = g1 + (dg * iw) / w;
-            b = b1 + (db * iw) / w;
-            x++;
+            return;
         }
-        _tpfb->drawFastVLine(x, y, h, color2);
-    } else
+        for (int16_t iy = 0; iy < h;) {
+            uint32_t color = ramp[iy];
+            int16_t run = 1;
+            if (to565) {
+                uint16_t color565 = color888To565(color);
+                while (((iy + run) < h) && (color888To565(ramp[iy + run]) == color565))
+                    run++;
+#ifdef ENABLE_FRAMEBUFFER
+                if (_use_fbtft)
+                    _tpfb->fillRect(x, y + iy, w, run, color565);
+                else
 #endif
-    {
-        setAddr(x, y, x + w - 1, y + h - 1);
-        beginWrite16BitColors();
-        for (y = h; y > 0; y--) {
-            for (int iw = 1; iw < w; iw++) {
-                if (_bitDepth == 24) {
-                    write24BitColor(color888(r, g, b));
-                } else {    
-                    write16BitColor(color565(r, g, b));
-                }
-                r = r1 + (dr * iw) / w;
-                g = g1 + (dg * iw) / w;
-                b = b1 + (db * iw) / w;
+                    fillRectFlexIO(x, y + iy, w, run, color565);
+            } else {
+                while (((iy + run) < h) && (ramp[iy + run] == color))
+                    run++;
+#ifdef ENABLE_FRAMEBUFFER
+                if (_use_fbtft)
+                    _tpfb->fillRect24(x, y + iy, w, run, color);
+                else
+#endif
+                    fillRect24BPPFlexIO(x, y + iy, w, run, color);
             }
-            write16BitColor(color2);
-            r = r1;
-            g = g1;
-            b = b1;
+            iy += run;
         }
-        endWrite16BitColors();
+        return;
+    }
+
+    // Horizontal, every row is the same so work it out once
+    uint32_t ramp[w];
+    gradientRamp(ramp, x - x0, w, w0, colors, stops, count);
+    if (dither) {
+        for (int16_t iy = 0; iy < h; iy++)
+            writeGradientRow(x, y + iy, w, ramp, err);
+        return;
+    }
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        // an image stride of 0 repeats the row
+        if (to565) {
+            uint16_t line_colors[w];
+            Teensy_Parallel_Convert::convertRowXRGBTo565(ramp, line_colors, w);
+            _tpfb->writeRect(x, y, w, h, 0, line_colors);
+        } else {
+            _tpfb->writeRect24(x, y, w, h, 0, ramp);
+        }
+        return;
+    }
+#endif
+    if (to565) {
+        uint16_t line_colors[w];
+        Teensy_Parallel_Convert::convertRowXRGBTo565(ramp, line_colors, w);
+        for (int16_t iy = 0; iy < h; iy++)
+            writeRectFlexIO(x, y + iy, w, 1, line_colors);
+    } else {
+        writeRect24BPPFlexIO(x, y, w, h, 0, ramp);
     }
 }
 
+void Teensy_Parallel_GFX::fillRectRadial(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy,
+                                         int16_t radius, const uint16_t *colors, const uint8_t *stops, uint8_t count) {
+    if (!count || (radius < 0))
+        return;
+    x += _originx;
+    y += _originy;
+    cx += _originx;
+    cy += _originy;
+    if (!clipGradientRect(x, y, w, h))
+        return;
+
+    // ramp by distance from the center, anything past radius is the last color.
+    // It only needs to reach the farthest corner of what is drawn, so a big
+    // radius doesn't mean a big table on the stack.
+    int32_t far_dx = max(abs(x - cx), abs(x + w - 1 - cx));
+    int32_t far_dy = max(abs(y - cy), abs(y + h - 1 - cy));
+    int32_t far_d = (int32_t)(sqrtf((float)(far_dx * far_dx + far_dy * far_dy)) + 0.5f);
+    int32_t ramp_last = min(far_d, (int32_t)radius);
+    uint32_t ramp[ramp_last + 1];
+    gradientRamp(ramp, 0, ramp_last + 1, radius + 1, colors, stops, count);
+    bool dither = gradientTo565() && (_dither != Teensy_Parallel_Convert::DITHER_NONE);
+    int16_t err[dither ? 3 * (w + 2) : 1];
+    memset(err, 0, sizeof(err));
+    uint32_t row[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        int32_t dy = y + iy - cy;
+        int32_t dy2 = dy * dy;
+        int32_t dx = x - cx;
+        for (int16_t ix = 0; ix < w; ix++, dx++) {
+            int32_t d = (int32_t)(sqrtf((float)(dx * dx + dy2)) + 0.5f);
+            row[ix] = ramp[min(d, ramp_last)];
+        }
+        writeGradientRow(x, y + iy, w, row, err);
+    }
+}
 
 // fillScreenVGradient - fills screen with vertical gradient
 void Teensy_Parallel_GFX::fillScreenVGradient(uint16_t color1, uint16_t color2) {
@@ -2760,6 +4262,7 @@ void Teensy_Parallel_GFX::fillScreenHGradient(uint16_t color1, uint16_t color2)
 
 // Now lets see if we can writemultiple pixels
 void Teensy_Parallel_GFX::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) {
+    DL_RECORD_PTR(DL_WRITE_RECT, pcolors, nullptr, x, y, w, h);
     int16_t w_image = w; // remember the w that came in.
     if (x == CENTER)
         x = (_width - w) / 2;
@@ -2828,6 +4331,8 @@ void Teensy_Parallel_GFX::writeRect(int16_t x, int16_t y, int16_t w, int16_t h,
 //                                    screen rect
 void Teensy_Parallel_GFX::writeSubImageRect(int16_t x, int16_t y, int16_t w, int16_t h,
                                             int16_t image_offset_x, int16_t image_offset_y, int16_t image_width, int16_t image_height, const uint16_t *pcolors) {
+    DL_RECORD_PTR(DL_WRITE_SUBIMAGE_RECT, pcolors, nullptr, x, y, w, h, image_offset_x, image_offset_y,
+                  image_width, image_height);
     // Serial.printf("writeSubImageRect(%d %d %d %d : %d %d %d %d : %p)\n", x, y, w, h, image_offset_x, image_offset_y, image_width, image_height, pcolors);
     if (x == CENTER)
         x = (_width - w) / 2;
@@ -2894,8 +4399,199 @@ void Teensy_Parallel_GFX::writeSubImageRect(int16_t x, int16_t y, int16_t w, int
     endWrite16BitColors();
 }
 
+// Same clipping as writeSubImageRect, but pixels matching key_color are skipped.
+// Going to the display, each row is broken up into runs of non key pixels so we
+// only set the window for the parts that are drawn.
+void Teensy_Parallel_GFX::writeSubImageRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h,
+                                                 int16_t image_offset_x, int16_t image_offset_y, int16_t image_width,
+                                                 int16_t image_height, const uint16_t *pcolors, uint16_t key_color) {
+    DL_RECORD_PTR(DL_WRITE_SUBIMAGE_RECT_KEYED, pcolors, nullptr, x, y, w, h, image_offset_x, image_offset_y,
+                  image_width, image_height, key_color);
+    if (x == CENTER)
+        x = (_width - w) / 2;
+    if (y == CENTER)
+        y = (_height - h) / 2;
+    x += _originx;
+    y += _originy;
+
+    // See if the whole thing out of bounds...
+    if ((x >= _displayclipx2) || (y >= _displayclipy2))
+        return;
+    if (((x + w) <= _displayclipx1) || ((y + h) <= _displayclipy1))
+        return;
+
+    pcolors += image_offset_y * image_width + image_offset_x;
+
+    if (y < _displayclipy1) {
+        int dy = (_displayclipy1 - y);
+        h -= dy;
+        pcolors += (dy * image_width);
+        y = _displayclipy1;
+    }
+    if ((y + h - 1) >= _displayclipy2)
+        h = _displayclipy2 - y;
+    if (x < _displayclipx1) {
+        uint16_t x_clip_left = _displayclipx1 - x;
+        w -= x_clip_left;
+        x = _displayclipx1;
+        pcolors += x_clip_left;
+    }
+    if ((x + w - 1) >= _displayclipx2)
+        w = _displayclipx2 - x;
+
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        _tpfb->writeRectKeyed(x, y, w, h, image_width, pcolors, key_color);
+        return;
+    }
+#endif
+
+    for (int16_t iy = 0; iy < h; iy++) {
+        const uint16_t *pcolors_row = pcolors + iy * image_width;
+        int16_t ix = 0;
+        while (ix < w) {
+            // skip over the keyed pixels
+            while ((ix < w) && (pcolors_row[ix] == key_color))
+                ix++;
+            int16_t run_start = ix;
+            while ((ix < w) && (pcolors_row[ix] != key_color))
+                ix++;
+            if (ix > run_start) {
+                setAddr(x + run_start, y + iy, x + ix - 1, y + iy);
+                beginWrite16BitColors();
+                for (int16_t i = run_start; i < ix; i++)
+                    write16BitColor(pcolors_row[i]);
+                endWrite16BitColors();
+            }
+        }
+    }
+}
+
+void Teensy_Parallel_GFX::writeSubImageRectBlend(int16_t x, int16_t y, int16_t w, int16_t h,
+                                                 int16_t image_offset_x, int16_t image_offset_y, int16_t image_width,
+                                                 int16_t image_height, const uint16_t *pcolors, uint8_t alpha,
+                                                 bool keyed, uint16_t key_color) {
+    DL_RECORD_PTR(DL_WRITE_SUBIMAGE_RECT_BLEND, pcolors, nullptr, x, y, w, h, image_offset_x, image_offset_y,
+                  image_width, image_height, alpha, keyed, key_color);
+    if (alpha == 0)
+        return;
+    if (alpha == 255) {
+        if (keyed)
+            writeSubImageRectKeyed(x, y, w, h, image_offset_x, image_offset_y, image_width, image_height, pcolors, key_color);
+        else
+            writeSubImageRect(x, y, w, h, image_offset_x, image_offset_y, image_width, image_height, pcolors);
+        return;
+    }
+    if (x == CENTER)
+        x = (_width - w) / 2;
+    if (y == CENTER)
+        y = (_height - h) / 2;
+    x += _originx;
+    y += _originy;
+
+    // See if the whole thing out of bounds...
+    if ((x >= _displayclipx2) || (y >= _displayclipy2))
+        return;
+    if (((x + w) <= _displayclipx1) || ((y + h) <= _displayclipy1))
+        return;
+
+    pcolors += image_offset_y * image_width + image_offset_x;
+
+    if (y < _displayclipy1) {
+        int dy = (_displayclipy1 - y);
+        h -= dy;
+        pcolors += (dy * image_width);
+        y = _displayclipy1;
+    }
+    if ((y + h - 1) >= _displayclipy2)
+        h = _displayclipy2 - y;
+    if (x < _displayclipx1) {
+        uint16_t x_clip_left = _displayclipx1 - x;
+        w -= x_clip_left;
+        x = _displayclipx1;
+        pcolors += x_clip_left;
+    }
+    if ((x + w - 1) >= _displayclipx2)
+        w = _displayclipx2 - x;
+
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        _tpfb->writeRectBlend(x, y, w, h, image_width, pcolors, alpha, keyed, key_color);
+        return;
+    }
+#endif
+
+    // Read back a row at a time, blend and write it out again
+    uint16_t line_colors[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        const uint16_t *pcolors_row = pcolors + iy * image_width;
+        readRectFlexIO(x, y + iy, w, 1, line_colors);
+        for (int16_t ix = 0; ix < w; ix++) {
+            if (!keyed || (pcolors_row[ix] != key_color))
+                line_colors[ix] = alphaBlendRGB565(pcolors_row[ix], line_colors[ix], alpha);
+        }
+        writeRectFlexIO(x, y + iy, w, 1, line_colors);
+    }
+}
+
+void Teensy_Parallel_GFX::writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+                                             const uint16_t *palette, uint8_t alpha, bool keyed, uint8_t key_index) {
+    DL_RECORD_PTR(DL_WRITE_RECT_8BPP_BLEND, pixels, palette, x, y, w, h, alpha, keyed, key_index);
+    if (alpha == 0)
+        return;
+    if ((alpha == 255) && !keyed) {
+        writeRect8BPP(x, y, w, h, pixels, palette);
+        return;
+    }
+    x += _originx;
+    y += _originy;
+
+    // See if the whole thing out of bounds...
+    if ((x >= _displayclipx2) || (y >= _displayclipy2))
+        return;
+    if (((x + w) <= _displayclipx1) || ((y + h) <= _displayclipy1))
+        return;
+
+    int16_t w_image = w;
+    if (y < _displayclipy1) {
+        int dy = (_displayclipy1 - y);
+        h -= dy;
+        pixels += (dy * w_image);
+        y = _displayclipy1;
+    }
+    if ((y + h - 1) >= _displayclipy2)
+        h = _displayclipy2 - y;
+    if (x < _displayclipx1) {
+        uint16_t x_clip_left = _displayclipx1 - x;
+        w -= x_clip_left;
+        x = _displayclipx1;
+        pixels += x_clip_left;
+    }
+    if ((x + w - 1) >= _displayclipx2)
+        w = _displayclipx2 - x;
+
+#ifdef ENABLE_FRAMEBUFFER
+    if (_use_fbtft) {
+        _tpfb->writeRect8BPPBlend(x, y, w, h, w_image, pixels, palette, alpha, keyed, key_index);
+        return;
+    }
+#endif
+
+    uint16_t line_colors[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        const uint8_t *pixels_row = pixels + iy * w_image;
+        readRectFlexIO(x, y + iy, w, 1, line_colors);
+        for (int16_t ix = 0; ix < w; ix++) {
+            if (!keyed || (pixels_row[ix] != key_index))
+                line_colors[ix] = alphaBlendRGB565(palette[pixels_row[ix]], line_colors[ix], alpha);
+        }
+        writeRectFlexIO(x, y + iy, w, 1, line_colors);
+    }
+}
+
 // fill a rectangle
 void Teensy_Parallel_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    DL_RECORD(DL_FILL_RECT, x, y, w, h, color);
     x += _originx;
     y += _originy;
 
@@ -2927,6 +4623,7 @@ void Teensy_Parallel_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, u
 }
 
 void Teensy_Parallel_GFX::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    DL_RECORD(DL_DRAW_PIXEL, x, y, color);
     x += _originx;
     y += _originy;
     if ((x < _displayclipx1) || (x >= _displayclipx2) || (y < _displayclipy1) || (y >= _displayclipy2))
@@ -2942,6 +4639,7 @@ void Teensy_Parallel_GFX::drawPixel(int16_t x, int16_t y, uint16_t color) {
 }
 
 void Teensy_Parallel_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    DL_RECORD(DL_DRAW_FAST_VLINE, x, y, h, color);
     x += _originx;
     y += _originy;
     // Rectangular clipping
@@ -2972,6 +4670,7 @@ void Teensy_Parallel_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_
 }
 
 void Teensy_Parallel_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    DL_RECORD(DL_DRAW_FAST_HLINE, x, y, w, color);
     x += _originx;
     y += _originy;
 
@@ -3067,6 +4766,7 @@ void Teensy_Parallel_GFX::readRect(int16_t x, int16_t y, int16_t w, int16_t h,
 }
 
 void Teensy_Parallel_GFX::drawPixel24BPP(int16_t x, int16_t y, uint32_t color) {
+    DL_RECORD(DL_DRAW_PIXEL_24BPP, x, y, (int16_t)color, (int16_t)(color >> 16));
     x += _originx;
     y += _originy;
     if ((x < _displayclipx1) || (x >= _displayclipx2) || (y < _displayclipy1) || (y >= _displayclipy2))
@@ -3082,6 +4782,7 @@ void Teensy_Parallel_GFX::drawPixel24BPP(int16_t x, int16_t y, uint32_t color) {
 }
 
 void Teensy_Parallel_GFX::drawFastVLine24BPP(int16_t x, int16_t y, int16_t h, uint32_t color) {
+    DL_RECORD(DL_DRAW_FAST_VLINE_24BPP, x, y, h, (int16_t)color, (int16_t)(color >> 16));
     x += _originx;
     y += _originy;
     // Rectangular clipping
@@ -3106,6 +4807,7 @@ void Teensy_Parallel_GFX::drawFastVLine24BPP(int16_t x, int16_t y, int16_t h, ui
 }
 
 void Teensy_Parallel_GFX::drawFastHLine24BPP(int16_t x, int16_t y, int16_t w, uint32_t color) {
+    DL_RECORD(DL_DRAW_FAST_HLINE_24BPP, x, y, w, (int16_t)color, (int16_t)(color >> 16));
     x += _originx;
     y += _originy;
 
@@ -3133,6 +4835,7 @@ void Teensy_Parallel_GFX::drawFastHLine24BPP(int16_t x, int16_t y, int16_t w, ui
 
 
 void Teensy_Parallel_GFX::fillRect24BPP(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) {
+    DL_RECORD(DL_FILL_RECT_24BPP, x, y, w, h, (int16_t)color, (int16_t)(color >> 16));
     x += _originx;
     y += _originy;
 
@@ -3164,6 +4867,9 @@ void Teensy_Parallel_GFX::fillRect24BPP(int16_t x, int16_t y, int16_t w, int16_t
 }
 
 bool Teensy_Parallel_GFX::writeRect24BPP(int16_t x, int16_t y, int16_t w, int16_t h, const uint32_t *pcolors) {
+    if (_display_list)
+        return _display_list->recordPtr(Teensy_Parallel_DisplayList::DL_WRITE_RECT_24BPP, pcolors, nullptr, nullptr,
+                                        x, y, w, h);
     int16_t w_image = w; // remember the w that came in.
     if (x == CENTER)
         x = (_width - w) / 2;
@@ -3228,17 +4934,14 @@ bool Teensy_Parallel_GFX::writeRect24BPPFlexIO(int16_t x, int16_t y, int16_t w,
     // bail if nothing to do
     if (length == 0) return false;
 
-    setAddr(x, y, x + w - 1, y + h - 1);
-    beginWrite16BitColors();
-    const uint32_t *pcolors_row = pcolors;
-    for (y = h; y > 0; y--) {
-        pcolors = pcolors_row;
-        for (x = w; x > 1; x--) {
-            write16BitColor(color888To565(*pcolors++));
-        }
-        write16BitColor(color888To565(*pcolors++));
-        pcolors_row += w_image;
+    // Convert a row at a time and send it as one block
+    uint16_t line_colors[w];
+    int16_t err[(_dither == Teensy_Parallel_Convert::DITHER_FLOYD_STEINBERG) ? 3 * (w + 2) : 1];
+    memset(err, 0, sizeof(err));
+    for (int16_t iy = 0; iy < h; iy++) {
+        Teensy_Parallel_Convert::convertRowXRGBTo565Dither(pcolors, line_colors, w, _dither, x, y + iy, err);
+        writeRectFlexIO(x, y + iy, w, 1, line_colors);
+        pcolors += w_image;
     }
-    endWrite16BitColors();
     return true;
 }
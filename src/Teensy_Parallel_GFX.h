@@ -23,6 +23,8 @@
 //----------------
 //		fillRectVGradient	- fills area with vertical gradient
 //		fillRectHGradient	- fills area with horizontal gradient
+//		fillRectLinearGradient - fills area with a multi color gradient
+//		fillRectRadialGradient - fills area with a gradient around a point
 //		fillScreenVGradient - fills screen with vertical gradient
 //  	fillScreenHGradient - fills screen with horizontal gradient
 
@@ -38,6 +40,7 @@
 //  writeRect4BPP - 	write 4 bit per pixel paletted bitmap
 //  writeRect2BPP - 	write 2 bit per pixel paletted bitmap
 //  writeRect1BPP - 	write 1 bit per pixel paletted bitmap
+//  drawRLEImage - 	draw a run length encoded image with transparency
 
 // String Pixel Length support
 //---------------------------
@@ -50,9 +53,17 @@
 
 #define ENABLE_FRAMEBUFFER
 
+// How many async rectangle updates can be waiting to go out
+#ifndef TPGFX_ASYNC_QUEUE_SIZE
+#define TPGFX_ASYNC_QUEUE_SIZE 8
+#endif
+
 #ifdef __cplusplus
 #include "Arduino.h"
 #include "ILI9341_fonts.h"
+#include "RLE_fonts.h"
+#include "RLE_images.h"
+#include "Teensy_Parallel_Convert.h"
 #include <stdint.h>
 
 #define CL(_r, _g, _b) ((((_r) & 0xF8) << 8) | (((_g) & 0xFC) << 3) | ((_b) >> 3))
@@ -105,6 +116,7 @@ typedef struct {
 #define BL_DATUM 6 // Bottom left
 #define BC_DATUM 7 // Bottom centre
 #define BR_DATUM 8 // Bottom right
+
 // #define L_BASELINE  9 // Left character baseline (Line the 'A' character would sit on)
 // #define C_BASELINE 10 // Centre character baseline
 // #define R_BASELINE 11 // Right character baseline
@@ -131,14 +143,17 @@ typedef struct {
 #define ILI9488_PINK 0xF81F
 
 class Teensy_Parallel_GFX;
+class Teensy_Parallel_DisplayList;
 
 class Teensy_Parallel_FB {
 public:
     Teensy_Parallel_FB(Teensy_Parallel_GFX *ptpgfx) : _ptpgfx(ptpgfx) {}
+    virtual ~Teensy_Parallel_FB() {}
 
     // note these are clipped. 
     virtual uint8_t dataWidth() = 0;
-//    virtual uint8_t countBytesPerPixel() = 0; // how big is each pixel in bytes.
+    virtual uint8_t countBytesPerPixel() = 0; // how big is each pixel in bytes.
+    virtual void setBuffer(uintptr_t fb) = 0;  // move where pixel (0, 0) is in memory, used for panning
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
     virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) = 0;
     virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) = 0;
@@ -158,9 +173,28 @@ public:
     virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color) = 0;
     virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors) = 0;
 
+    // Same as writeRect but pixels matching key_color are left alone
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color) = 0;
+    // Blends pcolors over what is in the buffer, alpha 255 is all pcolors.  When
+    // keyed, pixels matching key_color are left alone.
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color) = 0;
+    // Same for 8 bit palette pixels, keyed on the palette index
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index) = 0;
+
     void setWidthHeight(uint16_t w, uint16_t h) {
         _width = w;
         _height = h;
+        if (!_fixed_stride) _stride = w;
+    }
+
+    // Pixels per row in the buffer, when the buffer is wider than the area drawn into
+    void setStride(uint16_t stride) {
+        _stride = stride;
+        _fixed_stride = true;
     }
 
     void clearChangedRange() {
@@ -199,13 +233,17 @@ public:
 
     Teensy_Parallel_GFX *_ptpgfx;
     uint16_t _width, _height;
+    uint16_t _stride = 0;
+    bool _fixed_stride = false;
     int16_t _changed_min_x, _changed_max_x, _changed_min_y, _changed_max_y;
 };
 
 class Teensy_Parallel_FB16 : public Teensy_Parallel_FB {
 public:
-    Teensy_Parallel_FB16(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (uint16_t*)fb; Serial.printf("Teensy_Parallel_FB16(%p %p)\n", ptpgfx, fb);}
+    Teensy_Parallel_FB16(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (uint16_t*)fb; /*Serial.printf("Teensy_Parallel_FB16(%p %p)\n", ptpgfx, fb);*/}
     virtual uint8_t dataWidth() {return 16;}
+    virtual uint8_t countBytesPerPixel() {return 2;}
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (uint16_t *)fb;}
 
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
     virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -225,6 +263,13 @@ public:
     virtual void drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color);
     virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
     virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors);
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color);
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color);
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index);
 
     uint16_t *_pfbtft;
 };
@@ -233,6 +278,8 @@ class Teensy_Parallel_FB24 : public Teensy_Parallel_FB {
 public:
     Teensy_Parallel_FB24(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (RGB24_t *)fb;}
     virtual uint8_t dataWidth() {return 24;}
+    virtual uint8_t countBytesPerPixel() {return 3;}
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (RGB24_t *)fb;}
 
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
     virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -252,6 +299,13 @@ public:
     virtual void drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color);
     virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
     virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors);
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color);
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color);
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index);
 
     //uint32_t *_pfbtft;
     typedef struct __attribute__((packed)) {
@@ -263,10 +317,53 @@ public:
     RGB24_t *_pfbtft;
 };
 
+// 24 bit color kept as XRGB8888, one uint32 a pixel.  A third more memory than
+// Teensy_Parallel_FB24 but every pixel is an aligned word, so fills and 24 bit
+// writes are just stores.  Select with bit_depth 32.
+class Teensy_Parallel_FB32 : public Teensy_Parallel_FB {
+public:
+    Teensy_Parallel_FB32(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (uint32_t *)fb;}
+    virtual uint8_t dataWidth() {return 32;}
+    virtual uint8_t countBytesPerPixel() {return 4;}
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (uint32_t *)fb;}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors);
+    virtual void readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors);
+
+    virtual void writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+        const uint8_t *pixels, const uint16_t *palette);
+    virtual void writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t h,
+                       uint8_t bits_per_pixel, uint16_t count_of_bytes_per_row, uint8_t row_shift_init,
+                       const uint8_t *pixels, const uint16_t *palette);
+
+    virtual void drawPixel24(int16_t x, int16_t y, uint32_t color);
+    virtual void drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color);
+    virtual void drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color);
+    virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
+    virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors);
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color);
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color);
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index);
+
+    uint32_t *pixelAddress(int16_t x, int16_t y) { return _pfbtft + y * (int)_stride + x; }
+
+    uint32_t *_pfbtft;
+};
+
 class Teensy_Parallel_FB18 : public Teensy_Parallel_FB {
 public:
-    Teensy_Parallel_FB18(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (uint32_t*)fb; Serial.printf("Teensy_Parallel_FB18(%p %p)\n", ptpgfx, fb);}
+    Teensy_Parallel_FB18(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FB(ptpgfx) {_pfbtft = (uint8_t*)fb; /*Serial.printf("Teensy_Parallel_FB18(%p %p)\n", ptpgfx, fb);*/}
     virtual uint8_t dataWidth() {return 18;}
+    virtual uint8_t countBytesPerPixel() {return 3;} // packed, see FB18.cpp
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (uint8_t *)fb;}
 
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
     virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -286,15 +383,107 @@ public:
     virtual void drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color);
     virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
     virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors);
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color);
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color);
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index);
 
-//    typedef struct __attribute__((packed)) {
-//        uint8_t r : 6;
-//        uint8_t g : 6;
-//        uint8_t b : 6;
-//        uint16_t unused : 14;
-//    } RGB18_t;
+    uint8_t *pixelAddress(int16_t x, int16_t y) { return _pfbtft + (y * (int)_stride + x) * 3; }
 
-    uint32_t *_pfbtft;
+    uint8_t *_pfbtft;
+};
+
+// Palette frame buffers hold a palette index per pixel, the colors passed in
+// are 565 and are mapped to the closest palette entry (exact matches are the
+// fast case), and pixels are read back (and sent to the display) through the
+// palette.  The palette is not copied, so changing its entries and calling
+// updateScreen changes the whole screen.  setPalette has to be called again
+// after a change, the last color looked up is remembered.
+class Teensy_Parallel_FBPalette : public Teensy_Parallel_FB {
+public:
+    Teensy_Parallel_FBPalette(Teensy_Parallel_GFX *ptpgfx, uint16_t palette_size)
+        : Teensy_Parallel_FB(ptpgfx), _palette_size(palette_size) {}
+    // nullptr for the default one (RGB332 for 8 bits, the 16 VGA colors for 4)
+    void setPalette(const uint16_t *palette);
+    const uint16_t *getPalette() { return _palette; }
+    uint8_t colorIndex(uint16_t color);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void writeRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint16_t *pcolors);
+    virtual void readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors);
+
+    virtual void writeRect8BPP(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+        const uint8_t *pixels, const uint16_t *palette);
+    virtual void writeRectNBPP(int16_t x, int16_t y, int16_t w, int16_t h,
+                       uint8_t bits_per_pixel, uint16_t count_of_bytes_per_row, uint8_t row_shift_init,
+                       const uint8_t *pixels, const uint16_t *palette);
+
+    virtual void drawPixel24(int16_t x, int16_t y, uint32_t color);
+    virtual void drawFastVLine24(int16_t x, int16_t y, int16_t h, uint32_t color);
+    virtual void drawFastHLine24(int16_t x, int16_t y, int16_t w, uint32_t color);
+    virtual void fillRect24(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color);
+    virtual void writeRect24(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image, const uint32_t *pcolors);
+    virtual void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint16_t key_color);
+    virtual void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                const uint16_t *pcolors, uint8_t alpha, bool keyed, uint16_t key_color);
+    virtual void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, int16_t w_image,
+                                    const uint8_t *pixels, const uint16_t *palette, uint8_t alpha,
+                                    bool keyed, uint8_t key_index);
+
+    // What the 8 and 4 bit versions do, everything else is built on these.
+    virtual void fillIndex(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) = 0;
+    virtual void writeIndexRow(int16_t x, int16_t y, int16_t w, const uint8_t *indices) = 0;
+    virtual void readIndexRow(int16_t x, int16_t y, int16_t w, uint8_t *indices) = 0;
+
+    const uint16_t *_palette = nullptr;
+    uint16_t _palette_size;
+    // last color looked up by colorIndex
+    uint16_t _last_color = 0;
+    uint8_t _last_index = 0;
+    bool _last_valid = false;
+};
+
+class Teensy_Parallel_FB8 : public Teensy_Parallel_FBPalette {
+public:
+    Teensy_Parallel_FB8(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FBPalette(ptpgfx, 256) {
+        _pfbtft = (uint8_t *)fb;
+        setPalette(nullptr);
+    }
+    virtual uint8_t dataWidth() {return 8;}
+    virtual uint8_t countBytesPerPixel() {return 1;}
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (uint8_t *)fb;}
+
+    virtual void fillIndex(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index);
+    virtual void writeIndexRow(int16_t x, int16_t y, int16_t w, const uint8_t *indices);
+    virtual void readIndexRow(int16_t x, int16_t y, int16_t w, uint8_t *indices);
+
+    uint8_t *_pfbtft;
+};
+
+// Two pixels a byte, the even x one in the high nibble.  Rows are
+// (stride + 1) / 2 bytes.
+class Teensy_Parallel_FB4 : public Teensy_Parallel_FBPalette {
+public:
+    Teensy_Parallel_FB4(Teensy_Parallel_GFX *ptpgfx, uintptr_t fb) : Teensy_Parallel_FBPalette(ptpgfx, 16) {
+        _pfbtft = (uint8_t *)fb;
+        setPalette(nullptr);
+    }
+    virtual uint8_t dataWidth() {return 4;}
+    virtual uint8_t countBytesPerPixel() {return 1;} // rounded up, two pixels share a byte
+    virtual void setBuffer(uintptr_t fb) {_pfbtft = (uint8_t *)fb;}
+
+    virtual void fillIndex(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index);
+    virtual void writeIndexRow(int16_t x, int16_t y, int16_t w, const uint8_t *indices);
+    virtual void readIndexRow(int16_t x, int16_t y, int16_t w, uint8_t *indices);
+
+    uint8_t *_pfbtft;
 };
 
 
@@ -340,6 +529,12 @@ class Teensy_Parallel_GFX : public Print {
 
 
   Teensy_Parallel_GFX(int16_t w, int16_t h);
+    // Frees the frame buffer objects (and a buffer useFrameBuffer allocated),
+    // virtual so canvases deleted through a base pointer clean up too.  Not
+    // copyable, a copy would free them a second time.
+    virtual ~Teensy_Parallel_GFX();
+    Teensy_Parallel_GFX(const Teensy_Parallel_GFX &) = delete;
+    Teensy_Parallel_GFX &operator=(const Teensy_Parallel_GFX &) = delete;
     //void pushPixels16bit(const uint16_t *pcolors, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {};
     //void pushPixels16bitDMA(const uint16_t *pcolors, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {};
 
@@ -353,6 +548,12 @@ class Teensy_Parallel_GFX : public Print {
     virtual void writeRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors) = 0;
     virtual void fillRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {};
     virtual void readRectFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) {};
+    // Packed 18 bit pixels (3 bytes, 6 bits of R, G and B at the top of each)
+    // from an 18 bit frame buffer, stride pixels per row.  Drivers with the
+    // panel in 18 bit mode can send these bytes as they are, by default they
+    // are turned back into 565 and go through writeRectFlexIO.
+    virtual void writeRect18BPPPackedFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+                                            uint16_t stride);
     virtual bool writeRectAsyncFlexIO(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors) { return false; }
     virtual bool writeRectAsyncActiveFlexIO() { return false; }
     virtual void setRotation(uint8_t r) = 0;
@@ -384,6 +585,12 @@ class Teensy_Parallel_GFX : public Print {
         // if (Serial) Serial.printf("clear clip Rect\n");
         updateDisplayClip();
     }
+    void getClipRect(int16_t *x1, int16_t *y1, int16_t *w, int16_t *h) {
+        *x1 = _clipx1;
+        *y1 = _clipy1;
+        *w = _clipx2 - _clipx1;
+        *h = _clipy2 - _clipy1;
+    }
 
     // setOrigin sets an offset in display pixels where drawing to (0,0) will appear
     // for example: setOrigin(10,10); drawPixel(5,5); will cause a pixel to be drawn at hardware pixel (15,15)
@@ -470,6 +677,29 @@ class Teensy_Parallel_GFX : public Print {
                            int16_t image_offset_x, int16_t image_offset_y, int16_t image_width,
                            int16_t image_height, const uint16_t *pcolors);
 
+    // Keyed versions of the above, pixels that match key_color are not drawn so
+    // whatever is already there shows through.
+    void writeRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors, uint16_t key_color) {
+        writeSubImageRectKeyed(x, y, w, h, 0, 0, w, h, pcolors, key_color);
+    }
+    void writeSubImageRectKeyed(int16_t x, int16_t y, int16_t w, int16_t h,
+                                int16_t image_offset_x, int16_t image_offset_y, int16_t image_width,
+                                int16_t image_height, const uint16_t *pcolors, uint16_t key_color);
+
+    // Blended versions, alpha 0 (nothing) to 255 (just the image), optionally
+    // keyed as well.  Without a frame buffer the pixels are read back with
+    // readRect, so the driver needs to support that.
+    void writeRectBlend(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors, uint8_t alpha) {
+        writeSubImageRectBlend(x, y, w, h, 0, 0, w, h, pcolors, alpha);
+    }
+    void writeSubImageRectBlend(int16_t x, int16_t y, int16_t w, int16_t h,
+                                int16_t image_offset_x, int16_t image_offset_y, int16_t image_width,
+                                int16_t image_height, const uint16_t *pcolors, uint8_t alpha,
+                                bool keyed = false, uint16_t key_color = 0);
+    // 8 bit palette version, key_index is the palette index that is not drawn
+    void writeRect8BPPBlend(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+                            const uint16_t *palette, uint8_t alpha, bool keyed = false, uint8_t key_index = 0);
+
 
     virtual size_t write(uint8_t);
     virtual size_t write(const uint8_t *buffer, size_t size);
@@ -479,8 +709,10 @@ class Teensy_Parallel_GFX : public Print {
     void setFont(const ILI9341_t3_font_t &f);
     void setFont(const GFXfont *f = NULL);
     void setFontAdafruit(void) { setFont(); }
+    void setFont(const RLE_font_t &f);
     void drawFontChar(unsigned int c);
     void drawGFXFontChar(unsigned int c);
+    void drawRLEFontChar(unsigned int c);
 
     void getTextBounds(const uint8_t *buffer, uint16_t len, int16_t x, int16_t y,
                        int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
@@ -518,7 +750,7 @@ class Teensy_Parallel_GFX : public Print {
 
     void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
     void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
-    void inline drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) { drawChar(x, y, c, color, bg, size); }
+    void inline drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) { drawChar(x, y, c, color, bg, size, size); }
     static const int16_t CENTER = 9998;
     void setCursor(int16_t x, int16_t y, bool autoCenter = false);
     void getCursor(int16_t *x, int16_t *y);
@@ -531,6 +763,21 @@ class Teensy_Parallel_GFX : public Print {
     uint8_t getTextSize();
     void setTextWrap(boolean w);
     boolean getTextWrap();
+
+    // Everything text drawing uses (cursor, colors, size, wrap, datum and
+    // font), so code drawing text for someone else can put it back after.
+    struct text_state_t {
+        const ILI9341_t3_font_t *font;
+        const GFXfont *gfx_font;
+        const RLE_font_t *rle_font;
+        int16_t cursor_x, cursor_y;
+        uint16_t color, bg_color;
+        uint8_t size_x, size_y;
+        boolean wrap;
+        uint8_t datum;
+    };
+    void getTextState(text_state_t &state);
+    void setTextState(const text_state_t &state);
     void sleep(bool enable);
 
     // writeRect8BPP - 	write 8 bit per pixel paletted bitmap
@@ -573,23 +820,143 @@ class Teensy_Parallel_GFX : public Print {
                        uint8_t bits_per_pixel, const uint8_t *pixels,
                        const uint16_t *palette);
 
+    // drawRLEImage - 	draw a run length encoded image (see RLE_images.h),
+    //					transparent runs are left alone, each other run is
+    //					one span write
+    void drawRLEImage(int16_t x, int16_t y, const RLE_image_t &image);
+
+// drawImageScaled / drawImageRotated sampling
+#define IMAGE_NEAREST 0  // closest source pixel
+#define IMAGE_BILINEAR 1 // blend of the 4 closest source pixels, in 565
+
+    // drawImageScaled - 	draw a whole RGB565 image stretched to w x h
+    // drawImageRotated -	draw it turned angle degrees clockwise around the
+    //					image pixel (pivot_x, pivot_y), which lands on (x, y)
+    //  filter is IMAGE_NEAREST or IMAGE_BILINEAR.  When keyed, pixels that
+    //  are key_color are not drawn, nor is anything outside the image.
+    void drawImageScaled(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors,
+                         int16_t image_width, int16_t image_height, uint8_t filter = IMAGE_NEAREST,
+                         bool keyed = false, uint16_t key_color = 0);
+    void drawImageRotated(int16_t x, int16_t y, const uint16_t *pcolors, int16_t image_width,
+                          int16_t image_height, int16_t pivot_x, int16_t pivot_y, float angle,
+                          uint8_t filter = IMAGE_NEAREST, bool keyed = false, uint16_t key_color = 0);
+
     void fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h,
                            uint16_t color1, uint16_t color2);
     void fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h,
                            uint16_t color1, uint16_t color2);
     void fillScreenVGradient(uint16_t color1, uint16_t color2);
     void fillScreenHGradient(uint16_t color1, uint16_t color2);
+    // Gradient through count colors, stops (0-255, in order, nullptr for evenly
+    // spaced) say where along the rect each color is.  colors and stops are
+    // not copied when recorded in a display list.
+    void fillRectLinearGradient(int16_t x, int16_t y, int16_t w, int16_t h,
+                                const uint16_t *colors, const uint8_t *stops, uint8_t count, bool vertical);
+    // Gradient going out from cx, cy (same coordinates as x, y), color1 at the
+    // center to color2 at radius and beyond.  Only the rect is filled.
+    void fillRectRadialGradient(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy,
+                                int16_t radius, uint16_t color1, uint16_t color2);
+    void fillRectRadialGradient(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy,
+                                int16_t radius, const uint16_t *colors, const uint8_t *stops, uint8_t count);
+    // The colors the gradients use: entries first .. first + count - 1 of a
+    // length long gradient as XRGB, see fillRectLinearGradient for stops.
+    static void gradientRamp(uint32_t *ramp, int32_t first, int16_t count, int32_t length,
+                             const uint16_t *colors, const uint8_t *stops, uint8_t stop_count);
+    // Dithering for 24 bit color going into 565, writeRect24BPP (to a 16 bit
+    // frame buffer or the display) and the gradients.  One of
+    // Teensy_Parallel_Convert::DITHER_NONE (default), DITHER_BAYER (4x4 ordered,
+    // fixed to the screen so it doesn't crawl) or DITHER_FLOYD_STEINBERG
+    // (error diffusion, smoother but each rect is dithered on its own).
+    void setDither(uint8_t dither) { _dither = dither; }
+    uint8_t getDither() { return _dither; }
     uint32_t getRequiredframeBufferSize(uint8_t bit_depth = 16);                        // how big should the frame buffer be?
+    // bit_depth 32 is 24 bit color stored as XRGB8888, faster to draw into than
+    // the packed 24 bit buffer at the cost of 4 bytes a pixel.  It is sent with
+    // writeRect24BPPFlexIO, also by the async updates, which wait for it.
     void setFrameBuffer(uint16_t *frame_buffer, uint16_t bit_depth=16);
+    // Frame buffer that can be bigger than the display, buffer_width is also the
+    // stride.  Drawing and updateScreen use the display sized window at the pan
+    // position, so panning is just setFrameBufferPan and updateScreen.  Use a
+    // Teensy_Parallel_Canvas over the same buffer to draw anywhere in it.
+    // Returns false and leaves the frame buffer alone when the buffer is smaller
+    // than the display in the current rotation.  Set it again after a rotation,
+    // useFrameBuffer(true) refuses a buffer the display no longer fits in.
+    bool setFrameBuffer(uint16_t *frame_buffer, uint16_t buffer_width, uint16_t buffer_height, uint16_t bit_depth = 16);
+    void setFrameBufferPan(int16_t x, int16_t y);
+    // Double buffering: drawing goes into one buffer while the other is being
+    // sent.  swapAndUpdateAsync starts sending what was just drawn and switches
+    // drawing to the other buffer, optionally copying over the areas that changed
+    // so the new drawing buffer matches what is on the screen.
+    void setFrameBuffers(uint16_t *front_buffer, uint16_t *back_buffer, uint16_t bit_depth = 16);
+    bool swapAndUpdateAsync(bool copy_changed = true);
+    // bit_depth 8 and 4 frame buffers hold palette indices and are expanded
+    // through the palette (256 or 16 565 colors) when they are sent.  Async
+    // updates of these (and of 18 and 24 bit buffers) need
+    // setAsyncStagingBuffer.  The palette is not copied, after changing its
+    // entries call this again (with the same array) so colors are matched
+    // against the new ones, and updateScreen changes every pixel using it.
+    void setFrameBufferPalette(const uint16_t *palette);
+    void getFrameBufferPan(int16_t *x, int16_t *y) {
+        *x = _fb_pan_x;
+        *y = _fb_pan_y;
+    }
+    // Band rendering, for when there is not enough memory for a frame buffer.
+    // The screen (or just the clip rectangle) is drawn band_height rows at a
+    // time into buffer (_width * band_height pixels, see
+    // getRequiredBandBufferSize), each band being sent to the display when it
+    // is done.  With a second buffer a band is drawn
+    // while the previous one is sent async.  drawBands with a callback calls it
+    // once per band with drawing limited to that band, so it has to draw
+    // everything each time (including setCursor before any text).
+    void setBandBuffer(uint16_t *buffer, uint16_t band_height, uint16_t *buffer2 = nullptr);
+    uint32_t getRequiredBandBufferSize(uint16_t band_height) { return 2 * _width * band_height; }
+    void drawBands(void (*draw)(int16_t band_y, int16_t band_h, void *context), void *context = nullptr);
+    void drawBands(Teensy_Parallel_DisplayList &dl);
     uint8_t useFrameBuffer(boolean b);                // use the frame buffer?  First call will allocate
     void freeFrameBuffer(void);                       // explicit call to release the buffer
     void updateScreen(void);                          // call to say update the screen now.
     bool updateScreenAsync(bool update_cont = false); // call to say update the
                                                       // screen optinoally turn
                                                       // into continuous mode.
+    // Continuous mode moves on to the next frame from the driver's DMA
+    // interrupt when it calls asyncFrameComplete, otherwise only while
+    // asyncUpdateActive or waitUpdateAsyncComplete is being called.
     void waitUpdateAsyncComplete(void);
     void endUpdateAsync(); // Turn of the continueous mode fla
     boolean asyncUpdateActive(void);
+    // Called each time an async update finishes sending a frame (or the queue of
+    // async jobs below runs empty).  Drivers that call asyncFrameComplete do
+    // this from their DMA interrupt, so keep it short.
+    void setFrameCompleteCB(void (*pcb)()) { _frame_complete_callback = pcb; }
+    uint32_t getDMAFrameCount() { return _dma_frame_count; } // frames sent by async updates
+    // Queue an async update of the frame buffer rows covering this rectangle.
+    // Queued updates go out back to back, see also updateChangedAreasOnly.
+    bool updateRectAsync(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    // Async drawing without a frame buffer.  Each call queues one or more
+    // rectangle jobs that the driver sends back to back while the sketch keeps
+    // going, and returns a fence number.  The pixel data must stay untouched
+    // until asyncFenceDone(fence) says so.  Don't mix in normal drawing while
+    // jobs are pending, call waitUpdateAsyncComplete() first.
+    // writeRect8BPPAsync and fillRectAsync expand into the staging buffer, and
+    // without one (or when a row does not fit in half of it) draw synchronously.
+    // In frame buffer mode these all draw into the frame buffer right away.
+    void setAsyncStagingBuffer(uint16_t *buffer, uint32_t count_pixels);
+    uint32_t writeRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors);
+    uint32_t writeRect8BPPAsync(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels, const uint16_t *palette);
+    uint32_t fillRectAsync(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    uint32_t asyncFence() { return _async_seq_queued; } // fence for everything queued so far
+    bool asyncFenceDone(uint32_t fence);
+    void waitAsyncFence(uint32_t fence);
+
+    // Display lists, see Teensy_Parallel_DisplayList.h.  While recording, the
+    // drawing calls (and text) go into dl instead of being drawn.
+    void beginDisplayList(Teensy_Parallel_DisplayList &dl, bool clear = true);
+    void endDisplayList() { _display_list = nullptr; }
+    bool recordingDisplayList() { return _display_list != nullptr; }
+    // Draw the list, the second one only touches pixels inside x, y, w, h
+    void drawDisplayList(Teensy_Parallel_DisplayList &dl);
+    void drawDisplayList(Teensy_Parallel_DisplayList &dl, int16_t x, int16_t y, int16_t w, int16_t h);
 
     // Note: These methods, may not be fully implemented on all devices.
     void drawPixel24BPP(int16_t x, int16_t y, uint32_t color);
@@ -610,23 +977,33 @@ class Teensy_Parallel_GFX : public Print {
     int16_t HEIGHT;
     int16_t _width, _height;
     uint8_t _bitDepth = 16;  // sub-class can change this...
+    uint8_t _dither = 0;     // Teensy_Parallel_Convert::DITHER_...
+    bool clipGradientRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h);
+    bool gradientTo565();
+    void writeGradientRow(int16_t x, int16_t y, int16_t w, const uint32_t *row, int16_t *err);
+    void fillRectGradient(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *colors,
+                          const uint8_t *stops, uint8_t count, bool vertical);
+    void fillRectRadial(int16_t x, int16_t y, int16_t w, int16_t h, int16_t cx, int16_t cy, int16_t radius,
+                        const uint16_t *colors, const uint8_t *stops, uint8_t count);
 
     int16_t cursor_x, cursor_y;
     bool _center_x_text = false;
     bool _center_y_text = false;
 
     int16_t _clipx1, _clipy1, _clipx2, _clipy2;
+    int16_t _band_x1 = 0, _band_y1 = 0, _band_x2 = 0x7fff, _band_y2 = 0x7fff;
     int16_t _originx, _originy;
     int16_t _displayclipx1, _displayclipy1, _displayclipx2, _displayclipy2;
     bool _invisible = false;
     bool _standard = true; // no bounding rectangle or origin set.
 
     inline void updateDisplayClip() {
-        _displayclipx1 = max(0, min(_clipx1 + _originx, width()));
-        _displayclipx2 = max(0, min(_clipx2 + _originx, width()));
+        // the _band_ limits keep drawing inside the band while band rendering
+        _displayclipx1 = max((int)_band_x1, min(_clipx1 + _originx, min(width(), (int)_band_x2)));
+        _displayclipx2 = max((int)_band_x1, min(_clipx2 + _originx, min(width(), (int)_band_x2)));
 
-        _displayclipy1 = max(0, min(_clipy1 + _originy, height()));
-        _displayclipy2 = max(0, min(_clipy2 + _originy, height()));
+        _displayclipy1 = max((int)_band_y1, min(_clipy1 + _originy, min(height(), (int)_band_y2)));
+        _displayclipy2 = max((int)_band_y1, min(_clipy2 + _originy, min(height(), (int)_band_y2)));
         _invisible = (_displayclipx1 == _displayclipx2 || _displayclipy1 == _displayclipy2);
         _standard = (_displayclipx1 == 0) && (_displayclipx2 == _width) && (_displayclipy1 == 0) && (_displayclipy2 == _height);
 
@@ -659,7 +1036,17 @@ class Teensy_Parallel_GFX : public Print {
     uint16_t *_pfbtft;              // Optional Frame buffer
     uint8_t _use_fbtft;             // Are we in frame buffer mode?
     Teensy_Parallel_FB *_tpfb = nullptr; 
+    uint16_t *_pfbtft_other = nullptr; // with setFrameBuffers, the buffer not being drawn into
+    const uint16_t *_fb_palette = nullptr; // for 8 and 4 bit frame buffers
+    uint16_t _fb_buffer_width = 0;  // 0 when the buffer is the size of the display
+    uint16_t _fb_buffer_height = 0;
+    int16_t _fb_pan_x = 0;
+    int16_t _fb_pan_y = 0;
     uint16_t *_we_allocated_buffer; // We allocated the buffer;
+    Teensy_Parallel_FB16 *_band_fb = nullptr; // draws into the current band
+    uint16_t *_band_buffers[2] = {nullptr, nullptr};
+    uint16_t _band_height = 0;
+    void drawBandsInternal(Teensy_Parallel_DisplayList *dl, void (*draw)(int16_t, int16_t, void *), void *context);
     //int16_t _changed_min_x, _changed_max_x, _changed_min_y, _changed_max_y;
     bool _updateChangedAreasOnly = false; // current default off,
 
@@ -667,11 +1054,61 @@ class Teensy_Parallel_GFX : public Print {
         if (_tpfb) _tpfb->clearChangedRange();
     }
 
+    // Buffers the async code can't hand to the driver as they are, anything
+    // but 565 goes through the staging buffer.  So the async row pointers,
+    // which are uint16_t, only ever point into 16 bit frame buffers.
+    bool asyncStaged() { return _tpfb->dataWidth() != 16; }
+
     void updateChangedAreasOnly(bool updateChangedOnly) {
         _updateChangedAreasOnly = updateChangedOnly;
     }
 
 #endif
+    // Async update support.  Drivers should call asyncFrameComplete() when an
+    // async transfer started by writeRectAsyncFlexIO is done and another one
+    // can be started, from their DMA complete interrupt.  After the first call
+    // only that interrupt advances the queue and continuous mode.  For drivers
+    // that don't, asyncUpdateActive() notices when writeRectAsyncActiveFlexIO()
+    // goes false, so continuous mode then only advances while it is polled
+    // (asyncUpdateActive, waitUpdateAsyncComplete or asyncFenceDone).
+    void asyncFrameComplete() {
+        _async_driver_callbacks = true;
+        asyncFrameDone();
+    }
+    void asyncFrameDone();
+    void asyncTransferFinished();
+    void (*_frame_complete_callback)() = nullptr;
+    volatile uint32_t _dma_frame_count = 0;
+    volatile bool _async_in_flight = false;
+    volatile bool _async_continuous = false;
+    volatile bool _async_driver_callbacks = false;
+    uint16_t *_async_frame_buffer = nullptr; // what continuous mode is sending
+
+    // Pending async rectangles, started one after another from asyncFrameDone.
+    typedef struct {
+        int16_t x, y, w, h;
+        uint16_t *pcolors;
+        uint32_t seq; // fence number
+    } async_rect_t;
+    async_rect_t _async_queue[TPGFX_ASYNC_QUEUE_SIZE];
+    volatile uint8_t _async_queue_head = 0; // next one to send
+    volatile uint8_t _async_queue_count = 0;
+    uint32_t _async_seq_queued = 0;
+    volatile uint32_t _async_seq_done = 0;
+    uint32_t _async_in_flight_seq = 0;
+    // Staging buffer used as two halves, so one can be filled while the other is sent
+    uint16_t *_async_staging = nullptr;
+    uint32_t _async_staging_half = 0; // pixels in each half
+    uint32_t _async_staging_seq[2] = {0, 0}; // last job using each half
+    uint8_t _async_staging_next = 0;
+    uint16_t *asyncStagingHalf(uint8_t &index);
+    bool queueAsyncRows(int16_t y, int16_t h);
+    bool queueAsyncStagedRect(int16_t x, int16_t y, int16_t w, int16_t h);
+    bool queueAsyncRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *pcolors);
+    bool startNextAsyncRect();
+
+    Teensy_Parallel_DisplayList *_display_list = nullptr; // recording into this
+
     // GFX Font support
     const GFXfont *gfxFont = nullptr;
     int8_t _gfxFont_min_yOffset = 0;
@@ -684,6 +1121,19 @@ class Teensy_Parallel_GFX : public Print {
     uint16_t _gfx_last_char_textbgcolor;
     bool gfxFontLastCharPosFG(int16_t x, int16_t y);
 
+    // Run length encoded font support
+    const RLE_font_t *rleFont = nullptr;
+    void drawRLEFontRow(const uint8_t *runs, uint8_t count, int16_t x, int16_t y, int16_t w, int16_t rows, bool opaque);
+    const uint8_t *drawRLEImageRow(const uint8_t *runs, int16_t x, int16_t y, int16_t rows, const uint16_t *palette,
+                                   bool draw);
+
+    // Scaled / rotated image support
+    void drawImageMapped(int16_t x1, int16_t y1, int16_t x2, int16_t y2, int32_t u, int32_t v,
+                         int32_t du_dx, int32_t dv_dx, int32_t du_dy, int32_t dv_dy,
+                         const uint16_t *pcolors, int16_t image_width, int16_t image_height,
+                         uint8_t filter, bool keyed, uint16_t key_color);
+    void writeImageRun(int16_t x, int16_t y, int16_t w, int16_t rows, const uint16_t *pcolors);
+
     /**
      * Found in a pull request for the Adafruit framebuffer library. Clever!
      * https://github.com/tricorderproject/arducordermini/pull/1/files#diff-d22a481ade4dbb4e41acc4d7c77f683d
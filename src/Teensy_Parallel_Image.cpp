@@ -0,0 +1,262 @@
+#include "Teensy_Parallel_Image.h"
+
+// BMP headers are little endian
+static inline uint16_t get16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static inline uint32_t get32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+int32_t Teensy_Parallel_Image::readStream(void *context, uint8_t *buf, int32_t count) {
+    return ((Stream *)context)->readBytes((char *)buf, count);
+}
+
+bool Teensy_Parallel_Image::readFully(read_callback_t read, void *context, uint8_t *buf, int32_t count) {
+    while (count > 0) {
+        int32_t cb = read(context, buf, count);
+        if (cb <= 0)
+            return false;
+        buf += cb;
+        count -= cb;
+    }
+    return true;
+}
+
+// Throw away count bytes, the callbacks can't seek
+bool Teensy_Parallel_Image::skip(read_callback_t read, void *context, uint32_t count) {
+    uint8_t buf[32];
+    while (count) {
+        uint32_t cb = min(count, (uint32_t)sizeof(buf));
+        if (!readFully(read, context, buf, cb))
+            return false;
+        count -= cb;
+    }
+    return true;
+}
+
+bool Teensy_Parallel_Image::getBMPSize(read_callback_t read, void *context, int16_t &w, int16_t &h) {
+    uint8_t header[26];
+    if (!readFully(read, context, header, sizeof(header)) || (header[0] != 'B') || (header[1] != 'M'))
+        return false;
+    w = (int16_t)get32(header + 18);
+    h = (int16_t)abs((int32_t)get32(header + 22));
+    return true;
+}
+
+bool Teensy_Parallel_Image::drawBMP(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read,
+                                    void *context) {
+    if (tft.recordingDisplayList())
+        return false;
+
+    // file header (14) and the start of the info header, up to the masks
+    uint8_t header[66];
+    if (!readFully(read, context, header, 18) || (header[0] != 'B') || (header[1] != 'M'))
+        return false;
+    uint32_t data_offset = get32(header + 10);
+    uint32_t info_size = get32(header + 14);
+    if ((info_size < 40) || !readFully(read, context, header + 18, 36))
+        return false;
+    uint32_t read_so_far = 54;
+
+    int32_t w = (int32_t)get32(header + 18);
+    int32_t h = (int32_t)get32(header + 22);
+    uint16_t bpp = get16(header + 28);
+    uint32_t compression = get32(header + 30);
+    uint32_t palette_count = get32(header + 46);
+    bool top_down = h < 0;
+    if (top_down)
+        h = -h;
+    if ((w < 1) || (w > TPGFX_IMAGE_MAX_WIDTH) || (h < 1) || (h > 0x7fff) || (get16(header + 26) != 1))
+        return false;
+
+    // 16 bit is 555 unless bitfields say 565, which is all we take
+    bool is565 = false;
+    if (compression == 3) {
+        if ((bpp != 16) || !readFully(read, context, header + 54, 12))
+            return false;
+        read_so_far += 12;
+        if ((get32(header + 54) == 0xf800) && (get32(header + 58) == 0x07e0) && (get32(header + 62) == 0x001f))
+            is565 = true;
+        else if ((get32(header + 54) != 0x7c00) || (get32(header + 58) != 0x03e0) || (get32(header + 62) != 0x001f))
+            return false;
+    } else if (compression != 0) {
+        return false; // no RLE
+    }
+    if ((bpp != 1) && (bpp != 4) && (bpp != 8) && (bpp != 16) && (bpp != 24))
+        return false;
+
+    // Palette, right after the info header as B G R x
+    uint16_t palette[(bpp <= 8) ? (1 << bpp) : 1];
+    if (bpp <= 8) {
+        if (!skip(read, context, 14 + info_size - read_so_far))
+            return false;
+        read_so_far = 14 + info_size;
+        uint16_t max_colors = 1 << bpp;
+        if ((palette_count == 0) || (palette_count > max_colors))
+            palette_count = max_colors;
+        memset(palette, 0, sizeof(palette));
+        for (uint16_t i = 0; i < palette_count; i++) {
+            uint8_t bgrx[4];
+            if (!readFully(read, context, bgrx, 4))
+                return false;
+            palette[i] = Teensy_Parallel_GFX::color565(bgrx[2], bgrx[1], bgrx[0]);
+        }
+        read_so_far += palette_count * 4;
+    }
+    if ((data_offset < read_so_far) || !skip(read, context, data_offset - read_so_far))
+        return false;
+
+    // Rows are padded to 4 bytes.  24 bit rows are read into the end of the
+    // row buffer and spread out to XRGB from the front, which never catches up.
+    uint32_t stride = ((w * bpp + 31) / 32) * 4;
+    uint32_t row_words = (bpp == 24) ? (w + 1) : ((stride + 3) / 4);
+    uint32_t row_buf[row_words];
+    uint8_t *row_bytes = (uint8_t *)row_buf;
+    uint8_t *row_in = (bpp == 24) ? (row_bytes + row_words * 4 - stride) : row_bytes;
+
+    for (int32_t iy = 0; iy < h; iy++) {
+        if (!readFully(read, context, row_in, stride))
+            return false;
+        int16_t row_y = y + (top_down ? iy : (h - 1 - iy));
+        switch (bpp) {
+        case 1:
+        case 4:
+        case 8:
+            tft.writeRectNBPP(x, row_y, w, 1, bpp, row_bytes, palette);
+            break;
+        case 16: {
+            uint16_t *pcolors = (uint16_t *)row_buf;
+            for (int32_t i = 0; i < w; i++) {
+                uint16_t c = get16(row_bytes + i * 2);
+                // 555 to 565, top bit of green copied down
+                pcolors[i] = is565 ? c : (((c & 0x7fe0) << 1) | ((c & 0x0200) >> 4) | (c & 0x001f));
+            }
+            tft.writeRect(x, row_y, w, 1, pcolors);
+            break;
+        }
+        case 24: {
+            const uint8_t *bgr = row_in;
+            for (int32_t i = 0; i < w; i++, bgr += 3)
+                row_buf[i] = (bgr[2] << 16) | (bgr[1] << 8) | bgr[0];
+            tft.writeRect24BPP(x, row_y, w, 1, row_buf);
+            break;
+        }
+        }
+    }
+    return true;
+}
+
+bool Teensy_Parallel_Image::drawRaw565(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, int16_t w, int16_t h,
+                                       read_callback_t read, void *context, bool big_endian) {
+    if (tft.recordingDisplayList() || (w < 1) || (w > TPGFX_IMAGE_MAX_WIDTH))
+        return false;
+    uint16_t pcolors[w];
+    for (int16_t iy = 0; iy < h; iy++) {
+        if (!readFully(read, context, (uint8_t *)pcolors, w * 2))
+            return false;
+        if (big_endian) {
+            for (int16_t i = 0; i < w; i++)
+                pcolors[i] = __builtin_bswap16(pcolors[i]);
+        }
+        tft.writeRect(x, y + iy, w, 1, pcolors);
+    }
+    return true;
+}
+
+// QOI header is big endian
+static inline uint32_t get32BE(const uint8_t *p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+bool Teensy_Parallel_Image::getQOISize(read_callback_t read, void *context, int16_t &w, int16_t &h) {
+    uint8_t header[14];
+    if (!readFully(read, context, header, sizeof(header)) || memcmp(header, "qoif", 4))
+        return false;
+    w = (int16_t)get32BE(header + 4);
+    h = (int16_t)get32BE(header + 8);
+    return true;
+}
+
+bool Teensy_Parallel_Image::drawQOI(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read,
+                                    void *context) {
+    if (tft.recordingDisplayList())
+        return false;
+    uint8_t header[14];
+    if (!readFully(read, context, header, sizeof(header)) || memcmp(header, "qoif", 4))
+        return false;
+    uint32_t w = get32BE(header + 4);
+    uint32_t h = get32BE(header + 8);
+    if ((w < 1) || (w > TPGFX_IMAGE_MAX_WIDTH) || (h < 1) || (h > 0x7fff))
+        return false;
+
+    reader_t r;
+    r.read = read;
+    r.context = context;
+    r.pos = r.count = 0;
+    // Pixels are kept as 0xAARRGGBB, so a row of them can go straight to
+    // writeRect24BPP which ignores the top byte
+    uint32_t index[64];
+    memset(index, 0, sizeof(index));
+    uint8_t pr = 0, pg = 0, pb = 0, pa = 255;
+    uint32_t px = 0xff000000;
+    uint8_t run = 0;
+    uint32_t row[w];
+
+    for (uint32_t iy = 0; iy < h; iy++) {
+        for (uint32_t ix = 0; ix < w; ix++) {
+            if (run) {
+                run--;
+            } else {
+                int16_t b1 = readByte(r);
+                if (b1 < 0)
+                    return false;
+                if (b1 == 0xfe) { // RGB
+                    int16_t c0 = readByte(r), c1 = readByte(r), c2 = readByte(r);
+                    if (c2 < 0)
+                        return false;
+                    pr = c0;
+                    pg = c1;
+                    pb = c2;
+                } else if (b1 == 0xff) { // RGBA
+                    int16_t c0 = readByte(r), c1 = readByte(r), c2 = readByte(r), c3 = readByte(r);
+                    if (c3 < 0)
+                        return false;
+                    pr = c0;
+                    pg = c1;
+                    pb = c2;
+                    pa = c3;
+                } else {
+                    switch (b1 >> 6) {
+                    case 0: // INDEX
+                        px = index[b1];
+                        pa = px >> 24;
+                        pr = px >> 16;
+                        pg = px >> 8;
+                        pb = px;
+                        row[ix] = px;
+                        continue; // already in the index
+                    case 1: // DIFF
+                        pr += ((b1 >> 4) & 3) - 2;
+                        pg += ((b1 >> 2) & 3) - 2;
+                        pb += (b1 & 3) - 2;
+                        break;
+                    case 2: { // LUMA
+                        int16_t b2 = readByte(r);
+                        if (b2 < 0)
+                            return false;
+                        int8_t vg = (b1 & 0x3f) - 32;
+                        pr += vg - 8 + ((b2 >> 4) & 0x0f);
+                        pg += vg;
+                        pb += vg - 8 + (b2 & 0x0f);
+                        break;
+                    }
+                    case 3: // RUN, this pixel and run more
+                        run = b1 & 0x3f;
+                        row[ix] = px;
+                        continue;
+                    }
+                }
+                px = ((uint32_t)pa << 24) | (pr << 16) | (pg << 8) | pb;
+                index[(pr * 3 + pg * 5 + pb * 7 + pa * 11) & 63] = px;
+            }
+            row[ix] = px;
+        }
+        tft.writeRect24BPP(x, y + iy, w, 1, row);
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef _TEENSY_PARALLEL_IMAGE_H_
+#define _TEENSY_PARALLEL_IMAGE_H_
+
+#include "Teensy_Parallel_GFX.h"
+
+// Widest image row the decoders will take
+#ifndef TPGFX_IMAGE_MAX_WIDTH
+#define TPGFX_IMAGE_MAX_WIDTH 1024
+#endif
+// Bytes read from the callback at a time by the compressed formats
+#ifndef TPGFX_IMAGE_READ_BUFFER
+#define TPGFX_IMAGE_READ_BUFFER 64
+#endif
+
+//=============================================================================
+// Streaming image decoders.
+// The image data comes from a read callback a piece at a time (a file on SD,
+// a network stream...) and is drawn a row at a time as it is decoded, so the
+// whole image never has to be in memory.  Only one row of scratch is used, on
+// the stack.  Rows go through the normal writeRect calls, so they are clipped
+// and end up in the frame buffer when one is in use, or are sent to the
+// display otherwise.  Nothing is drawn while recording a display list, as the
+// rows would be gone by the time it is drawn.
+//
+// The read callback returns how many bytes it put in buf, less than count
+// (or < 0) means the data ran out and the draw stops there.
+//=============================================================================
+class Teensy_Parallel_Image {
+  public:
+    typedef int32_t (*read_callback_t)(void *context, uint8_t *buf, int32_t count);
+
+    // Windows BMP, 1, 4, 8 bit palette, 16 bit (555, or 565 bitfields) and
+    // 24 bit, uncompressed, bottom up or top down.  Returns false if it is
+    // not one of those or the data ran out.
+    static bool drawBMP(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read, void *context);
+    // Width and height of a BMP from its header, reads the first 26 bytes.
+    static bool getBMPSize(read_callback_t read, void *context, int16_t &w, int16_t &h);
+
+    // w x h 565 pixels, a row after another, little endian unless big_endian
+    static bool drawRaw565(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, int16_t w, int16_t h,
+                           read_callback_t read, void *context, bool big_endian = false);
+
+    // QOI (qoiformat.org), RGB or RGBA with the alpha ignored.  Decoding needs
+    // the row, a 256 byte color index and a TPGFX_IMAGE_READ_BUFFER input
+    // buffer.  Returns false if it is not QOI or the data ran out.
+    static bool drawQOI(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read, void *context);
+    // Width and height of a QOI image, reads the 14 byte header.
+    static bool getQOISize(read_callback_t read, void *context, int16_t &w, int16_t &h);
+
+    // Baseline JPEG, grayscale or YCbCr with 4:4:4, 4:2:2 or 4:2:0 chroma, no
+    // progressive or arithmetic coding.  scale 1, 2, 4 or 8 draws it at that
+    // fraction of its size, scaled down while decoding (at 8 the luma blocks
+    // only need their DC, so it is much quicker).  Each MCU (up to 16 x 16
+    // pixels) is drawn as soon as it is decoded, about 6K of tables and
+    // buffers are used on the stack.  Returns false if it can't be decoded or
+    // the data ran out.
+    static bool drawJPEG(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read, void *context,
+                         uint8_t scale = 1);
+    // Width and height of a JPEG, reads up to the frame header.
+    static bool getJPEGSize(read_callback_t read, void *context, int16_t &w, int16_t &h);
+
+    // read callback for any Stream (like an SD File), the stream is the context
+    static int32_t readStream(void *context, uint8_t *buf, int32_t count);
+
+  protected:
+    struct jpeg_t; // decoder state, see Teensy_Parallel_JPEG.cpp
+
+    // Reads the callback a buffer full at a time, for the byte at a time
+    // decoders
+    typedef struct {
+        read_callback_t read;
+        void *context;
+        uint16_t pos, count;
+        uint8_t buf[TPGFX_IMAGE_READ_BUFFER];
+    } reader_t;
+    static inline int16_t readByte(reader_t &r) {
+        if (r.pos == r.count) {
+            int32_t cb = r.read(r.context, r.buf, sizeof(r.buf));
+            if (cb <= 0)
+                return -1;
+            r.pos = 0;
+            r.count = cb;
+        }
+        return r.buf[r.pos++];
+    }
+
+    static bool readFully(read_callback_t read, void *context, uint8_t *buf, int32_t count);
+    static bool skip(read_callback_t read, void *context, uint32_t count);
+};
+
+#endif
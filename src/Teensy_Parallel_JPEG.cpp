@@ -0,0 +1,555 @@
+#include "Teensy_Parallel_Image.h"
+
+// Baseline JPEG decoder for Teensy_Parallel_Image::drawJPEG.
+// Markers are read up to the start of scan, then the MCUs are decoded one at
+// a time: Huffman decode and dequantize each block, fixed point IDCT (the
+// LLM one libjpeg calls islow), scale down if asked, YCbCr to XRGB and
+// writeRect24BPP.
+
+// Where each coefficient of the zigzag order goes in the block
+static const uint8_t jpeg_zigzag[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// JPEG markers we care about
+#define JPEG_SOF0 0xc0
+#define JPEG_SOF1 0xc1
+#define JPEG_DHT 0xc4
+#define JPEG_SOI 0xd8
+#define JPEG_EOI 0xd9
+#define JPEG_SOS 0xda
+#define JPEG_DQT 0xdb
+#define JPEG_DRI 0xdd
+
+struct Teensy_Parallel_Image::jpeg_t {
+    typedef struct {
+        // codes up to 8 bits long are looked up from the next 8 bits, len 0
+        // means the code is longer
+        uint8_t lookup_len[256];
+        uint8_t lookup_val[256];
+        int32_t maxcode[18]; // largest code of each length, -1 for none
+        int16_t valptr[17];  // values index of the first code of each length, less that code
+        uint8_t values[256];
+    } huffman_t;
+    typedef struct {
+        uint8_t id;
+        uint8_t h, v; // sampling factors
+        uint8_t tq;   // quantization table
+        uint8_t td, ta; // DC and AC Huffman tables
+        int32_t dc_pred;
+    } component_t;
+
+    reader_t r;
+    uint16_t quant[4][64]; // zigzag order
+    huffman_t huffman[4];  // DC 0, 1 then AC 0, 1
+    component_t comp[3];
+    uint8_t comp_count;
+    uint16_t width, height;
+    uint16_t restart_interval;
+    // entropy coded data, next bits at the top of bit_buf
+    uint32_t bit_buf;
+    int8_t bit_count;
+    int16_t marker;   // marker found in the data, it stops the bits
+    int16_t pad_bits; // zero bits put in bit_buf past the marker
+
+    bool readMarkers(bool stop_at_frame);
+    bool readSegment(uint8_t marker, uint16_t len);
+    int16_t read16() {
+        int16_t hi = readByte(r), lo = readByte(r);
+        return ((hi < 0) || (lo < 0)) ? -1 : ((hi << 8) | lo);
+    }
+    bool buildHuffman(huffman_t &t, const uint8_t counts[16]);
+
+    void fillBits() {
+        while (bit_count <= 24) {
+            uint32_t b = 0;
+            if (marker < 0) {
+                int16_t c = readByte(r);
+                if (c < 0) {
+                    marker = JPEG_EOI;
+                } else if (c == 0xff) {
+                    int16_t c2 = readByte(r);
+                    while (c2 == 0xff) // fill bytes
+                        c2 = readByte(r);
+                    if (c2 == 0)
+                        b = 0xff; // stuffed
+                    else
+                        marker = (c2 < 0) ? JPEG_EOI : c2;
+                } else {
+                    b = c;
+                }
+            }
+            if (marker >= 0)
+                pad_bits += 8; // past a marker it is zeros
+            bit_buf |= b << (24 - bit_count);
+            bit_count += 8;
+        }
+    }
+    uint32_t getBits(uint8_t n) {
+        fillBits();
+        uint32_t v = bit_buf >> (32 - n);
+        bit_buf <<= n;
+        bit_count -= n;
+        return v;
+    }
+    // n bit value as the signed difference it stands for
+    int32_t receiveExtend(uint8_t n) {
+        if (!n)
+            return 0;
+        int32_t v = getBits(n);
+        return (v < (1 << (n - 1))) ? v - (1 << n) + 1 : v;
+    }
+    int16_t decodeHuffman(const huffman_t &t) {
+        fillBits();
+        uint8_t look = bit_buf >> 24;
+        uint8_t len = t.lookup_len[look];
+        if (len) {
+            bit_buf <<= len;
+            bit_count -= len;
+            return t.lookup_val[look];
+        }
+        for (len = 9; len <= 16; len++) {
+            int32_t code = bit_buf >> (32 - len);
+            if (code <= t.maxcode[len]) {
+                bit_buf <<= len;
+                bit_count -= len;
+                return t.values[(t.valptr[len] + code) & 0xff];
+            }
+        }
+        return -1; // bad code
+    }
+    // true when the decoding has gone past the end of the data
+    bool ranOut() { return bit_count < pad_bits; }
+    bool decodeBlock(component_t &c, int32_t *coef, bool dc_only);
+    bool restart();
+};
+
+static void jpegIDCT(int32_t *coef, uint8_t *out);
+
+bool Teensy_Parallel_Image::jpeg_t::buildHuffman(huffman_t &t, const uint8_t counts[16]) {
+    memset(t.lookup_len, 0, sizeof(t.lookup_len));
+    int32_t code = 0;
+    int16_t k = 0;
+    for (uint8_t len = 1; len <= 16; len++) {
+        if (code + counts[len - 1] > (1 << len))
+            return false; // more codes than fit
+        t.valptr[len] = k - code;
+        for (uint8_t i = 0; i < counts[len - 1]; i++, k++, code++) {
+            if (len <= 8) {
+                uint16_t first = code << (8 - len);
+                for (uint16_t j = 0; j < (1 << (8 - len)); j++) {
+                    t.lookup_len[first + j] = len;
+                    t.lookup_val[first + j] = t.values[k];
+                }
+            }
+        }
+        t.maxcode[len] = counts[len - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    t.maxcode[17] = 0x7fffffff;
+    return true;
+}
+
+bool Teensy_Parallel_Image::jpeg_t::readSegment(uint8_t m, uint16_t len) {
+    switch (m) {
+    case JPEG_DQT:
+        while (len > 0) {
+            int16_t pq_tq = readByte(r);
+            if (pq_tq < 0)
+                return false;
+            bool wide = pq_tq >> 4;
+            uint16_t *q = quant[pq_tq & 3];
+            for (uint8_t i = 0; i < 64; i++) {
+                int16_t v = wide ? read16() : readByte(r);
+                if (v < 0)
+                    return false;
+                q[i] = v;
+            }
+            if (len < (wide ? 129 : 65))
+                return false;
+            len -= wide ? 129 : 65;
+        }
+        return true;
+
+    case JPEG_DHT:
+        while (len > 0) {
+            int16_t tc_th = readByte(r);
+            if ((tc_th < 0) || (tc_th & 0xee))
+                return false; // only baseline table numbers
+            uint8_t counts[16];
+            uint16_t total = 0;
+            for (uint8_t i = 0; i < 16; i++) {
+                int16_t c = readByte(r);
+                if (c < 0)
+                    return false;
+                counts[i] = c;
+                total += c;
+            }
+            if ((total > 256) || (len < (17 + total)))
+                return false;
+            huffman_t &t = huffman[((tc_th >> 4) ? 2 : 0) + (tc_th & 1)];
+            for (uint16_t i = 0; i < total; i++) {
+                int16_t v = readByte(r);
+                if (v < 0)
+                    return false;
+                t.values[i] = v;
+            }
+            if (!buildHuffman(t, counts))
+                return false;
+            len -= 17 + total;
+        }
+        return true;
+
+    case JPEG_SOF0:
+    case JPEG_SOF1: {
+        int16_t precision = readByte(r);
+        int16_t h = read16(), w = read16();
+        int16_t count = readByte(r);
+        if ((precision != 8) || (h <= 0) || (w <= 0) || ((count != 1) && (count != 3)) || (len != (6 + count * 3)))
+            return false;
+        height = h;
+        width = w;
+        comp_count = count;
+        for (uint8_t i = 0; i < comp_count; i++) {
+            comp[i].id = readByte(r);
+            int16_t hv = readByte(r);
+            int16_t tq = readByte(r);
+            if ((hv < 0) || (tq < 0))
+                return false;
+            comp[i].h = hv >> 4;
+            comp[i].v = hv & 0xf;
+            comp[i].tq = tq & 3;
+        }
+        if (comp_count == 1) {
+            comp[0].h = comp[0].v = 1; // a single component scan is always a block an MCU
+        } else if ((comp[0].h < 1) || (comp[0].h > 2) || (comp[0].v < 1) || (comp[0].v > 2) ||
+                   (comp[1].h != 1) || (comp[1].v != 1) || (comp[2].h != 1) || (comp[2].v != 1)) {
+            return false; // chroma has to be at one block an MCU
+        }
+        return true;
+    }
+
+    case JPEG_SOS: {
+        int16_t count = readByte(r);
+        if ((count != comp_count) || (len != (4 + count * 2)))
+            return false; // only interleaved scans, which is all baseline files ever have
+        for (uint8_t i = 0; i < count; i++) {
+            int16_t id = readByte(r);
+            int16_t tables = readByte(r);
+            if (tables < 0)
+                return false;
+            uint8_t j;
+            for (j = 0; (j < comp_count) && (comp[j].id != id); j++)
+                ;
+            if ((j != i) || ((tables >> 4) > 1) || ((tables & 0xf) > 1))
+                return false;
+            comp[i].td = tables >> 4;
+            comp[i].ta = 2 + (tables & 0xf);
+            comp[i].dc_pred = 0;
+        }
+        for (uint8_t i = 0; i < 3; i++) // spectral selection and approximation, fixed for baseline
+            readByte(r);
+        return true;
+    }
+
+    case JPEG_DRI: {
+        int16_t ri = read16();
+        if ((ri < 0) || (len != 2))
+            return false;
+        restart_interval = ri;
+        return true;
+    }
+
+    default:
+        if ((m >= 0xc2) && (m <= 0xcf) && (m != JPEG_DHT) && (m != 0xc8) && (m != 0xcc))
+            return false; // progressive, lossless, arithmetic...
+        // APPn, COM and anything else, skip it
+        while (len--)
+            if (readByte(r) < 0)
+                return false;
+        return true;
+    }
+}
+
+// Read markers up to the start of scan, or just the frame header
+bool Teensy_Parallel_Image::jpeg_t::readMarkers(bool stop_at_frame) {
+    if ((readByte(r) != 0xff) || (readByte(r) != JPEG_SOI))
+        return false;
+    for (;;) {
+        int16_t m = readByte(r);
+        if (m < 0)
+            return false;
+        if (m != 0xff)
+            continue; // shouldn't be here, look for the next marker
+        while (m == 0xff)
+            m = readByte(r);
+        if ((m < 0) || (m == JPEG_EOI))
+            return false;
+        if ((m == 0) || (m == 0x01) || ((m >= 0xd0) && (m <= JPEG_SOI)))
+            continue; // no length
+        int16_t len = read16();
+        if (len < 2)
+            return false;
+        if (((m == JPEG_SOS) && !width) || !readSegment(m, len - 2))
+            return false;
+        if ((m == JPEG_SOS) || (stop_at_frame && ((m == JPEG_SOF0) || (m == JPEG_SOF1))))
+            return true;
+    }
+}
+
+// Huffman decode a block into coef (natural order, dequantized).  dc_only
+// still has to get through the AC codes but leaves them out of coef.
+bool Teensy_Parallel_Image::jpeg_t::decodeBlock(component_t &c, int32_t *coef, bool dc_only) {
+    int16_t t = decodeHuffman(huffman[c.td]);
+    if ((t < 0) || (t > 11))
+        return false;
+    c.dc_pred += receiveExtend(t);
+    const uint16_t *q = quant[c.tq];
+    if (!dc_only)
+        memset(coef, 0, 64 * sizeof(int32_t));
+    coef[0] = c.dc_pred * q[0];
+
+    const huffman_t &ac = huffman[c.ta];
+    for (uint8_t k = 1; k < 64;) {
+        int16_t rs = decodeHuffman(ac);
+        if (rs < 0)
+            return false;
+        uint8_t run = rs >> 4;
+        uint8_t size = rs & 0xf;
+        if (size) {
+            k += run;
+            if (k > 63)
+                return false;
+            int32_t v = receiveExtend(size);
+            if (!dc_only)
+                coef[jpeg_zigzag[k]] = v * q[k];
+            k++;
+        } else if (run == 15) {
+            k += 16; // 16 zeros
+        } else {
+            break; // end of block
+        }
+    }
+    return true;
+}
+
+// Skip to the next RSTn and start the bits and DC predictions over
+bool Teensy_Parallel_Image::jpeg_t::restart() {
+    while (marker < 0) {
+        int16_t c = readByte(r);
+        if (c < 0)
+            return false;
+        if (c == 0xff) {
+            while (c == 0xff)
+                c = readByte(r);
+            if (c < 0)
+                return false;
+            if (c)
+                marker = c;
+        }
+    }
+    if ((marker < 0xd0) || (marker > 0xd7))
+        return false;
+    marker = -1;
+    bit_buf = 0;
+    bit_count = 0;
+    pad_bits = 0;
+    for (uint8_t i = 0; i < comp_count; i++)
+        comp[i].dc_pred = 0;
+    return true;
+}
+
+// 8x8 integer IDCT, columns then rows, 13 bit constants with 2 extra bits
+// kept between the passes.
+#define IDCT_CONST_BITS 13
+#define IDCT_PASS1_BITS 2
+#define IDCT_DESCALE(x, n) (((x) + (1 << ((n) - 1))) >> (n))
+
+static inline uint8_t idctClamp(int32_t v) { return (v < 0) ? 0 : ((v > 255) ? 255 : v); }
+
+static void jpegIDCT(int32_t *coef, uint8_t *out) {
+    int32_t ws[64];
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        // pass 0 reads coef columns into ws, pass 1 reads ws rows into out
+        const int32_t *in = pass ? ws : coef;
+        uint8_t step = pass ? 1 : 8; // between the 8 values transformed
+        uint8_t next = pass ? 8 : 1; // to the next set of them
+        for (uint8_t i = 0; i < 8; i++, in += next) {
+            int32_t *o = ws + i * next;
+            if (!in[step] && !in[step * 2] && !in[step * 3] && !in[step * 4] && !in[step * 5] && !in[step * 6] &&
+                !in[step * 7]) {
+                // only DC, which is most of them
+                if (pass) {
+                    uint8_t v = idctClamp(IDCT_DESCALE(in[0], IDCT_PASS1_BITS + 3) + 128);
+                    memset(out + i * 8, v, 8);
+                } else {
+                    for (uint8_t k = 0; k < 8; k++)
+                        o[k * step] = in[0] * (1 << IDCT_PASS1_BITS);
+                }
+                continue;
+            }
+            // even part
+            int32_t z2 = in[step * 2], z3 = in[step * 6];
+            int32_t z1 = (z2 + z3) * 4433;     // 0.541196100
+            int32_t tmp2 = z1 - z3 * 15137;    // 1.847759065
+            int32_t tmp3 = z1 + z2 * 6270;     // 0.765366865
+            int32_t tmp0 = (in[0] + in[step * 4]) * (1 << IDCT_CONST_BITS); // can be negative
+            int32_t tmp1 = (in[0] - in[step * 4]) * (1 << IDCT_CONST_BITS);
+            int32_t tmp10 = tmp0 + tmp3, tmp13 = tmp0 - tmp3;
+            int32_t tmp11 = tmp1 + tmp2, tmp12 = tmp1 - tmp2;
+            // odd part
+            tmp0 = in[step * 7];
+            tmp1 = in[step * 5];
+            tmp2 = in[step * 3];
+            tmp3 = in[step];
+            z1 = tmp0 + tmp3;
+            z2 = tmp1 + tmp2;
+            z3 = tmp0 + tmp2;
+            int32_t z4 = tmp1 + tmp3;
+            int32_t z5 = (z3 + z4) * 9633; // 1.175875602
+            tmp0 *= 2446;                  // 0.298631336
+            tmp1 *= 16819;                 // 2.053119869
+            tmp2 *= 25172;                 // 3.072711026
+            tmp3 *= 12299;                 // 1.501321110
+            z1 *= -7373;                   // 0.899976223
+            z2 *= -20995;                  // 2.562915447
+            z3 = z3 * -16069 + z5;         // 1.961570560
+            z4 = z4 * -3196 + z5;          // 0.390180644
+            tmp0 += z1 + z3;
+            tmp1 += z2 + z4;
+            tmp2 += z2 + z3;
+            tmp3 += z1 + z4;
+
+            int32_t v[8] = {tmp10 + tmp3, tmp11 + tmp2, tmp12 + tmp1, tmp13 + tmp0,
+                            tmp13 - tmp0, tmp12 - tmp1, tmp11 - tmp2, tmp10 - tmp3};
+            if (pass) {
+                for (uint8_t k = 0; k < 8; k++)
+                    out[i * 8 + k] = idctClamp(IDCT_DESCALE(v[k], IDCT_CONST_BITS + IDCT_PASS1_BITS + 3) + 128);
+            } else {
+                for (uint8_t k = 0; k < 8; k++)
+                    o[k * step] = IDCT_DESCALE(v[k], IDCT_CONST_BITS - IDCT_PASS1_BITS);
+            }
+        }
+    }
+}
+
+bool Teensy_Parallel_Image::getJPEGSize(read_callback_t read, void *context, int16_t &w, int16_t &h) {
+    jpeg_t j;
+    memset(&j, 0, sizeof(j));
+    j.r.read = read;
+    j.r.context = context;
+    if (!j.readMarkers(true) || !j.width)
+        return false;
+    w = j.width;
+    h = j.height;
+    return true;
+}
+
+bool Teensy_Parallel_Image::drawJPEG(Teensy_Parallel_GFX &tft, int16_t x, int16_t y, read_callback_t read,
+                                     void *context, uint8_t scale) {
+    if (tft.recordingDisplayList() || ((scale != 1) && (scale != 2) && (scale != 4) && (scale != 8)))
+        return false;
+    jpeg_t j;
+    memset(&j, 0, sizeof(j));
+    j.r.read = read;
+    j.r.context = context;
+    j.marker = -1;
+    for (uint8_t i = 0; i < 4; i++)
+        memset(j.huffman[i].maxcode, 0xff, sizeof(j.huffman[i].maxcode)); // no codes till a DHT
+    if (!j.readMarkers(false))
+        return false;
+
+    // MCU size, and what it comes out as once scaled.  Chroma is only scaled
+    // down as far as the output size, so 4:2:0 at 1/2 keeps all of its color.
+    uint8_t hmax = j.comp[0].h, vmax = j.comp[0].v;
+    uint8_t block_size = 8 / scale;
+    uint8_t out_w = hmax * block_size, out_h = vmax * block_size;
+    uint8_t chroma_w = min(out_w, (uint8_t)8), chroma_h = min(out_h, (uint8_t)8);
+    uint16_t mcus_x = (j.width + hmax * 8 - 1) / (hmax * 8);
+    uint16_t mcus_y = (j.height + vmax * 8 - 1) / (vmax * 8);
+    int16_t image_w = (j.width + scale - 1) / scale;
+    int16_t image_h = (j.height + scale - 1) / scale;
+
+    uint8_t luma[16 * 16];
+    uint8_t chroma[2][8 * 8];
+    uint32_t pixels[16 * 16];
+    int32_t coef[64];
+    uint8_t block[64];
+    uint16_t restart_count = j.restart_interval;
+
+    for (uint16_t my = 0; my < mcus_y; my++) {
+        for (uint16_t mx = 0; mx < mcus_x; mx++) {
+            if (j.restart_interval) {
+                if (!restart_count) {
+                    if (!j.restart())
+                        return false;
+                    restart_count = j.restart_interval;
+                }
+                restart_count--;
+            }
+            for (uint8_t c = 0; c < j.comp_count; c++) {
+                jpeg_t::component_t &comp = j.comp[c];
+                uint8_t *plane = c ? chroma[c - 1] : luma;
+                uint8_t stride = c ? chroma_w : out_w;
+                // how much each block is scaled down across and down
+                uint8_t fx = c ? (8 / chroma_w) : scale;
+                uint8_t fy = c ? (8 / chroma_h) : scale;
+                uint8_t shift = __builtin_ctz(fx * fy);
+                for (uint8_t bv = 0; bv < comp.v; bv++) {
+                    for (uint8_t bh = 0; bh < comp.h; bh++) {
+                        bool dc_only = (fx == 8) && (fy == 8);
+                        if (!j.decodeBlock(comp, coef, dc_only))
+                            return false;
+                        uint8_t *dst = plane + bv * block_size * stride + bh * block_size;
+                        if (dc_only) {
+                            // the DC is the average
+                            *dst = idctClamp(IDCT_DESCALE(coef[0], 3) + 128);
+                            continue;
+                        }
+                        jpegIDCT(coef, block);
+                        if (!shift) {
+                            for (uint8_t row = 0; row < 8; row++)
+                                memcpy(dst + row * stride, block + row * 8, 8);
+                            continue;
+                        }
+                        // average each fx x fy area
+                        for (uint8_t oy = 0; oy < 8 / fy; oy++) {
+                            for (uint8_t ox = 0; ox < 8 / fx; ox++) {
+                                uint16_t sum = 0;
+                                const uint8_t *p = block + oy * fy * 8 + ox * fx;
+                                for (uint8_t sy = 0; sy < fy; sy++, p += 8)
+                                    for (uint8_t sx = 0; sx < fx; sx++)
+                                        sum += p[sx];
+                                dst[oy * stride + ox] = (sum + (1 << (shift - 1))) >> shift;
+                            }
+                        }
+                    }
+                }
+            }
+            if (j.ranOut())
+                return false;
+
+            // the part of the MCU inside the image
+            int16_t px = mx * out_w, py = my * out_h;
+            int16_t w = min((int16_t)out_w, (int16_t)(image_w - px));
+            int16_t h = min((int16_t)out_h, (int16_t)(image_h - py));
+            for (int16_t row = 0; row < h; row++) {
+                uint32_t *dst = pixels + row * w;
+                const uint8_t *src = luma + row * out_w;
+                if (j.comp_count == 1) {
+                    for (int16_t i = 0; i < w; i++)
+                        dst[i] = src[i] * 0x010101;
+                } else {
+                    // chroma is the output size or half of it
+                    uint8_t chroma_row = ((out_h > chroma_h) ? (row >> 1) : row) * chroma_w;
+                    Teensy_Parallel_Convert::convertRowYCbCrToXRGB(src, chroma[0] + chroma_row, chroma[1] + chroma_row,
+                                                                   dst, w, (out_w > chroma_w) ? 1 : 0);
+                }
+            }
+            tft.writeRect24BPP(x + px, y + py, w, h, pixels);
+        }
+    }
+    return true;
+}
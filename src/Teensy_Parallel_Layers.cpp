@@ -0,0 +1,218 @@
+#include "Teensy_Parallel_Layers.h"
+
+Teensy_Parallel_Layers::Teensy_Parallel_Layers(Teensy_Parallel_GFX &tft, uint16_t background_color)
+    : _tft(tft), _background_color(background_color), _damage(tft, _damage_rects, TPGFX_LAYERS_MAX_DAMAGE) {
+    memset(_layers, 0, sizeof(_layers));
+    invalidate(); // first update draws everything
+}
+
+Teensy_Parallel_Layers::layer_t *Teensy_Parallel_Layers::getLayer(int8_t layer) {
+    if ((layer < 0) || (layer >= TPGFX_MAX_LAYERS) || !_layers[layer].used)
+        return nullptr;
+    return &_layers[layer];
+}
+
+int8_t Teensy_Parallel_Layers::addLayer(const uint16_t *pcolors, const uint8_t *pixels, const uint16_t *palette,
+                                        int16_t w, int16_t h, int16_t x, int16_t y, uint16_t stride) {
+    for (int8_t i = 0; i < TPGFX_MAX_LAYERS; i++) {
+        layer_t &l = _layers[i];
+        if (l.used)
+            continue;
+        memset(&l, 0, sizeof(l));
+        l.used = true;
+        l.visible = true;
+        l.alpha = 255;
+        l.pcolors = pcolors;
+        l.pixels = pixels;
+        l.palette = palette;
+        l.x = x;
+        l.y = y;
+        l.w = w;
+        l.h = h;
+        l.stride = stride ? stride : w;
+        invalidateLayer(l);
+        return i;
+    }
+    return -1;
+}
+
+int8_t Teensy_Parallel_Layers::addLayer(const uint16_t *pcolors, int16_t w, int16_t h, int16_t x, int16_t y,
+                                        uint16_t stride) {
+    return addLayer(pcolors, nullptr, nullptr, w, h, x, y, stride);
+}
+
+int8_t Teensy_Parallel_Layers::addLayer(const uint8_t *pixels, const uint16_t *palette, int16_t w, int16_t h,
+                                        int16_t x, int16_t y, uint16_t stride) {
+    return addLayer(nullptr, pixels, palette, w, h, x, y, stride);
+}
+
+int8_t Teensy_Parallel_Layers::addLayer(Teensy_Parallel_Canvas &canvas, int16_t x, int16_t y) {
+    if (canvas.getBitDepth() != 16)
+        return -1;
+    return addLayer(canvas.getBuffer(), nullptr, nullptr, canvas.width(), canvas.height(), x, y, canvas.getStride());
+}
+
+void Teensy_Parallel_Layers::removeLayer(int8_t layer) {
+    layer_t *l = getLayer(layer);
+    if (!l)
+        return;
+    invalidateLayer(*l);
+    l->used = false;
+}
+
+void Teensy_Parallel_Layers::setPosition(int8_t layer, int16_t x, int16_t y) {
+    layer_t *l = getLayer(layer);
+    if (!l || ((l->x == x) && (l->y == y)))
+        return;
+    invalidateLayer(*l); // where it was
+    l->x = x;
+    l->y = y;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::setVisible(int8_t layer, bool visible) {
+    layer_t *l = getLayer(layer);
+    if (!l || (l->visible == visible))
+        return;
+    l->visible = visible;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::setAlpha(int8_t layer, uint8_t alpha) {
+    layer_t *l = getLayer(layer);
+    if (!l || (l->alpha == alpha))
+        return;
+    l->alpha = alpha;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::setKey(int8_t layer, uint16_t key) {
+    layer_t *l = getLayer(layer);
+    if (!l)
+        return;
+    l->keyed = true;
+    l->key = key;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::clearKey(int8_t layer) {
+    layer_t *l = getLayer(layer);
+    if (!l || !l->keyed)
+        return;
+    l->keyed = false;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::setPalette(int8_t layer, const uint16_t *palette) {
+    layer_t *l = getLayer(layer);
+    if (!l)
+        return;
+    l->palette = palette;
+    invalidateLayer(*l);
+}
+
+void Teensy_Parallel_Layers::setBackground(uint16_t color) {
+    if (color == _background_color)
+        return;
+    _background_color = color;
+    invalidate();
+}
+
+void Teensy_Parallel_Layers::invalidate(int8_t layer, int16_t x, int16_t y, int16_t w, int16_t h) {
+    layer_t *l = getLayer(layer);
+    if (!l || !l->visible)
+        return;
+    // keep it inside the layer
+    int16_t x2 = min((int16_t)(x + w), l->w);
+    int16_t y2 = min((int16_t)(y + h), l->h);
+    x = max(x, (int16_t)0);
+    y = max(y, (int16_t)0);
+    if ((x < x2) && (y < y2))
+        invalidateScreen(l->x + x, l->y + y, x2 - x, y2 - y);
+}
+
+void Teensy_Parallel_Layers::invalidate(int8_t layer) {
+    layer_t *l = getLayer(layer);
+    if (l && l->visible)
+        invalidateLayer(*l);
+}
+
+// Put the part of row y between x1 and x2 of layer l over what is already there
+void Teensy_Parallel_Layers::composeRow(const layer_t &l, int16_t x1, int16_t x2, int16_t y) {
+    if ((y < l.y) || (y >= (l.y + l.h)))
+        return;
+    x1 = max(x1, l.x);
+    x2 = min(x2, (int16_t)(l.x + l.w));
+    if (x1 >= x2)
+        return;
+    int16_t w = x2 - x1;
+    uint32_t offset = (uint32_t)(y - l.y) * l.stride + (x1 - l.x);
+    if (l.pcolors) {
+        const uint16_t *pcolors = l.pcolors + offset;
+        if (l.alpha != 255)
+            _tft.writeSubImageRectBlend(x1, y, w, 1, 0, 0, w, 1, pcolors, l.alpha, l.keyed, l.key);
+        else if (l.keyed)
+            _tft.writeRectKeyed(x1, y, w, 1, pcolors, l.key);
+        else
+            _tft.writeRect(x1, y, w, 1, pcolors);
+    } else if (l.pixels && l.palette) {
+        const uint8_t *pixels = l.pixels + offset;
+        if ((l.alpha != 255) || l.keyed)
+            _tft.writeRect8BPPBlend(x1, y, w, 1, pixels, l.palette, l.alpha, l.keyed, l.key);
+        else
+            _tft.writeRect8BPP(x1, y, w, 1, pixels, l.palette);
+    }
+}
+
+bool Teensy_Parallel_Layers::update(bool async) {
+    if (!_damage.count())
+        return false;
+    // Don't draw into the frame buffer while the last update is going out
+    _tft.waitUpdateAsyncComplete();
+    // the caller's clip is put back at the end
+    int16_t clip_x, clip_y, clip_w, clip_h;
+    _tft.getClipRect(&clip_x, &clip_y, &clip_w, &clip_h);
+
+    for (uint8_t i = 0; i < _damage.count(); i++) {
+        const Teensy_Parallel_DamageList::rect_t &d = _damage[i];
+        _tft.setClipRect(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1);
+
+        // Start from the top most layer that hides everything under it here
+        int8_t first = 0;
+        bool covered = false;
+        for (int8_t j = TPGFX_MAX_LAYERS - 1; j >= 0; j--) {
+            layer_t &l = _layers[j];
+            if (l.used && l.visible && (l.alpha == 255) && !l.keyed && (l.pcolors || (l.pixels && l.palette)) &&
+                (l.x <= d.x1) && (l.y <= d.y1) && ((l.x + l.w) >= d.x2) && ((l.y + l.h) >= d.y2)) {
+                first = j;
+                covered = true;
+                break;
+            }
+        }
+
+        for (int16_t y = d.y1; y < d.y2; y++) {
+            if (!covered)
+                _tft.fillRect(d.x1, y, d.x2 - d.x1, 1, _background_color);
+            for (int8_t j = first; j < TPGFX_MAX_LAYERS; j++) {
+                layer_t &l = _layers[j];
+                if (l.used && l.visible && l.alpha)
+                    composeRow(l, d.x1, d.x2, y);
+            }
+        }
+    }
+    _tft.setClipRect();
+
+    // Everything is composed before any of it is sent, async updates send
+    // whole rows so they could pick up another area half done.
+    for (uint8_t i = 0; i < _damage.count(); i++) {
+        const Teensy_Parallel_DamageList::rect_t &d = _damage[i];
+        if (async && _tft.updateRectAsync(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1))
+            continue;
+        // updateScreen only sends the clip rectangle
+        _tft.setClipRect(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1);
+        _tft.updateScreen();
+    }
+    _tft.setClipRect(clip_x, clip_y, clip_w, clip_h);
+    _damage.clear();
+    return true;
+}
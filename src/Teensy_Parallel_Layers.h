@@ -0,0 +1,93 @@
+#ifndef _TEENSY_PARALLEL_LAYERS_H_
+#define _TEENSY_PARALLEL_LAYERS_H_
+
+#include "Teensy_Parallel_Canvas.h"
+#include "Teensy_Parallel_DamageList.h"
+
+// Most layers a compositor holds
+#ifndef TPGFX_MAX_LAYERS
+#define TPGFX_MAX_LAYERS 8
+#endif
+
+// How many separate damaged areas are kept before they get merged
+#ifndef TPGFX_LAYERS_MAX_DAMAGE
+#define TPGFX_LAYERS_MAX_DAMAGE 8
+#endif
+
+//=============================================================================
+// Layer compositor.
+// Layers are offscreen buffers you own, 565 or 8 bit palette, stacked by
+// layer number (layer 0 is at the bottom) over a background color.  addLayer
+// hands out the lowest free number.  Each layer has a position, an alpha
+// (255 is solid) and optionally a key color (or palette index) that is left
+// transparent.
+//
+// When you draw into a layer, tell the compositor with invalidate(layer, ...)
+// and update() rebuilds just the damaged areas of the frame buffer, a row at
+// a time, blending each layer's part of the row over the ones under it with
+// the frame buffer's own kernels (16, 18 or 24 bit), and then sends those
+// areas to the display.  Layers that hide the whole damaged area skip
+// everything under them.  Meant to be used with a frame buffer, without one
+// blending reads the display back with readRect.
+//=============================================================================
+class Teensy_Parallel_Layers {
+  public:
+    Teensy_Parallel_Layers(Teensy_Parallel_GFX &tft, uint16_t background_color = 0);
+
+    // These return the layer number, or -1 when there is no room.  stride is
+    // the pixels per row in the buffer, 0 for w.
+    int8_t addLayer(const uint16_t *pcolors, int16_t w, int16_t h, int16_t x = 0, int16_t y = 0, uint16_t stride = 0);
+    int8_t addLayer(const uint8_t *pixels, const uint16_t *palette, int16_t w, int16_t h, int16_t x = 0, int16_t y = 0,
+                    uint16_t stride = 0);
+    // 16 bit canvases only
+    int8_t addLayer(Teensy_Parallel_Canvas &canvas, int16_t x = 0, int16_t y = 0);
+    void removeLayer(int8_t layer);
+
+    void setPosition(int8_t layer, int16_t x, int16_t y);
+    void setVisible(int8_t layer, bool visible);
+    void setAlpha(int8_t layer, uint8_t alpha);
+    // key is the 565 color for 565 layers and the palette index for 8 bit ones
+    void setKey(int8_t layer, uint16_t key);
+    void clearKey(int8_t layer);
+    void setPalette(int8_t layer, const uint16_t *palette);
+    void setBackground(uint16_t color);
+
+    // The layer's pixels in x, y, w, h (layer coordinates) changed
+    void invalidate(int8_t layer, int16_t x, int16_t y, int16_t w, int16_t h);
+    void invalidate(int8_t layer);
+    // Redraw the whole screen on the next update
+    void invalidate() { invalidateScreen(0, 0, _tft.width(), _tft.height()); }
+
+    // Composite and send whatever changed, returns false when nothing had.
+    // async uses updateRectAsync (the next update waits for it to go out).
+    bool update(bool async = false);
+
+  protected:
+    typedef struct {
+        const uint16_t *pcolors; // 565 layer
+        const uint8_t *pixels;   // or 8 bit one
+        const uint16_t *palette;
+        int16_t x, y, w, h;
+        uint16_t stride;
+        uint16_t key;
+        uint8_t alpha;
+        bool used;
+        bool visible;
+        bool keyed;
+    } layer_t;
+
+    layer_t *getLayer(int8_t layer);
+    int8_t addLayer(const uint16_t *pcolors, const uint8_t *pixels, const uint16_t *palette, int16_t w, int16_t h,
+                    int16_t x, int16_t y, uint16_t stride);
+    void invalidateLayer(layer_t &l) { invalidateScreen(l.x, l.y, l.w, l.h); }
+    void invalidateScreen(int16_t x, int16_t y, int16_t w, int16_t h) { _damage.add(x, y, w, h); }
+    void composeRow(const layer_t &l, int16_t x1, int16_t x2, int16_t y);
+
+    Teensy_Parallel_GFX &_tft;
+    layer_t _layers[TPGFX_MAX_LAYERS];
+    uint16_t _background_color;
+    Teensy_Parallel_DamageList::rect_t _damage_rects[TPGFX_LAYERS_MAX_DAMAGE];
+    Teensy_Parallel_DamageList _damage;
+};
+
+#endif
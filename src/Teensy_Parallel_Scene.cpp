@@ -0,0 +1,248 @@
+#include "Teensy_Parallel_Scene.h"
+
+//=============================================================================
+// Nodes
+//=============================================================================
+void Teensy_Parallel_SceneNode::invalidate() {
+    if (_scene && _visible)
+        _scene->invalidate(_x, _y, _w, _h);
+}
+
+void Teensy_Parallel_SceneNode::setPosition(int16_t x, int16_t y) {
+    if ((x == _x) && (y == _y))
+        return;
+    invalidate(); // where it was
+    _x = x;
+    _y = y;
+    invalidate();
+}
+
+void Teensy_Parallel_SceneNode::setSize(int16_t w, int16_t h) {
+    if ((w == _w) && (h == _h))
+        return;
+    invalidate();
+    _w = w;
+    _h = h;
+    invalidate();
+}
+
+void Teensy_Parallel_SceneNode::setVisible(bool visible) {
+    if (visible == _visible)
+        return;
+    invalidate();
+    _visible = visible;
+    invalidate();
+}
+
+void Teensy_Parallel_SceneNode::setZ(int16_t z) {
+    if (z == _z)
+        return;
+    _z = z;
+    if (_scene) {
+        // move it to its new place in the list
+        _scene->unlink(*this);
+        _scene->insertSorted(*this);
+        invalidate();
+    }
+}
+
+void Teensy_Parallel_RectNode::setColor(uint16_t color) {
+    if (color == _color)
+        return;
+    _color = color;
+    invalidate();
+}
+
+void Teensy_Parallel_RectNode::setRadius(int16_t radius) {
+    _radius = radius;
+    invalidate();
+}
+
+void Teensy_Parallel_RectNode::draw(Teensy_Parallel_GFX &tft) {
+    if (_radius) {
+        if (_filled)
+            tft.fillRoundRect(_x, _y, _w, _h, _radius, _color);
+        else
+            tft.drawRoundRect(_x, _y, _w, _h, _radius, _color);
+    } else if (_filled) {
+        tft.fillRect(_x, _y, _w, _h, _color);
+    } else {
+        tft.drawRect(_x, _y, _w, _h, _color);
+    }
+}
+
+void Teensy_Parallel_TextNode::setText(const char *text) {
+    _text = text;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setColor(uint16_t color) {
+    _color = color;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setBackground(uint16_t color) {
+    _bg_color = color;
+    _has_bg = true;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setTransparent() {
+    _has_bg = false;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setFont(const ILI9341_t3_font_t &f) {
+    _ili_font = &f;
+    _gfx_font = nullptr;
+    _rle_font = nullptr;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setFont(const GFXfont *f) {
+    _ili_font = nullptr;
+    _gfx_font = f;
+    _rle_font = nullptr;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setFont(const RLE_font_t &f) {
+    _ili_font = nullptr;
+    _gfx_font = nullptr;
+    _rle_font = &f;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::setTextSize(uint8_t size) {
+    _text_size = size;
+    invalidate();
+}
+
+void Teensy_Parallel_TextNode::draw(Teensy_Parallel_GFX &tft) {
+    if (_has_bg)
+        tft.fillRect(_x, _y, _w, _h, _bg_color);
+    if (!_text)
+        return;
+    Teensy_Parallel_GFX::text_state_t save;
+    tft.getTextState(save);
+    if (_ili_font)
+        tft.setFont(*_ili_font);
+    else if (_rle_font)
+        tft.setFont(*_rle_font);
+    else
+        tft.setFont(_gfx_font);
+    tft.setTextSize(_text_size);
+    tft.setTextColor(_color); // background is already done
+    tft.setCursor(_x, _y);
+    tft.write((const uint8_t *)_text, strlen(_text));
+    tft.setTextState(save);
+}
+
+void Teensy_Parallel_ImageNode::setImage(const uint16_t *pcolors) {
+    _pcolors = pcolors;
+    invalidate();
+}
+
+void Teensy_Parallel_ImageNode::setKeyColor(uint16_t key_color) {
+    _key_color = key_color;
+    _keyed = true;
+    invalidate();
+}
+
+void Teensy_Parallel_ImageNode::clearKeyColor() {
+    _keyed = false;
+    invalidate();
+}
+
+void Teensy_Parallel_ImageNode::draw(Teensy_Parallel_GFX &tft) {
+    if (!_pcolors)
+        return;
+    if (_keyed)
+        tft.writeRectKeyed(_x, _y, _w, _h, _pcolors, _key_color);
+    else
+        tft.writeRect(_x, _y, _w, _h, _pcolors);
+}
+
+//=============================================================================
+// Scene
+//=============================================================================
+Teensy_Parallel_Scene::Teensy_Parallel_Scene(Teensy_Parallel_GFX &tft, uint16_t background_color)
+    : _tft(tft), _background_color(background_color), _damage(tft, _damage_rects, TPGFX_SCENE_MAX_DAMAGE) {
+    invalidate(); // first render draws everything
+}
+
+void Teensy_Parallel_Scene::add(Teensy_Parallel_SceneNode &node) {
+    if (node._scene)
+        node._scene->remove(node);
+    node._scene = this;
+    insertSorted(node);
+    node.invalidate();
+}
+
+void Teensy_Parallel_Scene::remove(Teensy_Parallel_SceneNode &node) {
+    if (node._scene != this)
+        return;
+    node.invalidate();
+    unlink(node);
+    node._scene = nullptr;
+}
+
+void Teensy_Parallel_Scene::setBackground(uint16_t color) {
+    _background_color = color;
+    invalidate();
+}
+
+// Nodes with the same z are drawn in the order they were added
+void Teensy_Parallel_Scene::insertSorted(Teensy_Parallel_SceneNode &node) {
+    Teensy_Parallel_SceneNode **pp = &_nodes;
+    while (*pp && ((*pp)->_z <= node._z))
+        pp = &(*pp)->_next;
+    node._next = *pp;
+    *pp = &node;
+}
+
+void Teensy_Parallel_Scene::unlink(Teensy_Parallel_SceneNode &node) {
+    for (Teensy_Parallel_SceneNode **pp = &_nodes; *pp; pp = &(*pp)->_next) {
+        if (*pp == &node) {
+            *pp = node._next;
+            node._next = nullptr;
+            return;
+        }
+    }
+}
+
+void Teensy_Parallel_Scene::invalidate(int16_t x, int16_t y, int16_t w, int16_t h) {
+    _damage.add(x, y, w, h);
+}
+
+bool Teensy_Parallel_Scene::render() {
+    if (!_damage.count())
+        return false;
+    // the caller's clip is put back at the end
+    int16_t clip_x, clip_y, clip_w, clip_h;
+    _tft.getClipRect(&clip_x, &clip_y, &clip_w, &clip_h);
+    for (uint8_t i = 0; i < _damage.count(); i++) {
+        const Teensy_Parallel_DamageList::rect_t &d = _damage[i];
+        _tft.setClipRect(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1);
+        _tft.fillRect(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1, _background_color);
+        for (Teensy_Parallel_SceneNode *node = _nodes; node; node = node->_next) {
+            if (!node->_visible)
+                continue;
+            // Keep each node inside its bounds as well
+            int16_t x1 = max(d.x1, node->_x);
+            int16_t y1 = max(d.y1, node->_y);
+            int16_t x2 = min(d.x2, (int16_t)(node->_x + node->_w));
+            int16_t y2 = min(d.y2, (int16_t)(node->_y + node->_h));
+            if ((x1 >= x2) || (y1 >= y2))
+                continue;
+            _tft.setClipRect(x1, y1, x2 - x1, y2 - y1);
+            node->draw(_tft);
+        }
+        // updateScreen only sends the clip rectangle (and does nothing without a frame buffer)
+        _tft.setClipRect(d.x1, d.y1, d.x2 - d.x1, d.y2 - d.y1);
+        _tft.updateScreen();
+    }
+    _tft.setClipRect(clip_x, clip_y, clip_w, clip_h);
+    _damage.clear();
+    return true;
+}
@@ -0,0 +1,154 @@
+#ifndef _TEENSY_PARALLEL_SCENE_H_
+#define _TEENSY_PARALLEL_SCENE_H_
+
+#include "Teensy_Parallel_Canvas.h"
+#include "Teensy_Parallel_DamageList.h"
+
+// How many separate damaged areas are kept before they get merged
+#ifndef TPGFX_SCENE_MAX_DAMAGE
+#define TPGFX_SCENE_MAX_DAMAGE 8
+#endif
+
+class Teensy_Parallel_Scene;
+
+//=============================================================================
+// Retained mode scene.
+// Nodes (rectangles, text, images, canvases) are added to a scene, and
+// changing one of them through its set functions remembers the area that
+// needs to be redrawn.  render() then redraws only those areas, each one
+// clipped with setClipRect: the background, then every node touching it in
+// z order (lowest first), followed by updateScreen of that area when a frame
+// buffer is used.
+//
+// The nodes are your objects, the scene just links them together, so they
+// have to stay around while they are in the scene.  Node bounds are also
+// where it draws, drawing outside of them is clipped off on the next redraw.
+//=============================================================================
+class Teensy_Parallel_SceneNode {
+  public:
+    Teensy_Parallel_SceneNode(int16_t x, int16_t y, int16_t w, int16_t h) : _x(x), _y(y), _w(w), _h(h) {}
+    virtual ~Teensy_Parallel_SceneNode() {}
+
+    void setPosition(int16_t x, int16_t y);
+    void setSize(int16_t w, int16_t h);
+    void setVisible(bool visible);
+    void setZ(int16_t z); // higher z is drawn on top
+    int16_t x() { return _x; }
+    int16_t y() { return _y; }
+    int16_t width() { return _w; }
+    int16_t height() { return _h; }
+    int16_t z() { return _z; }
+    bool visible() { return _visible; }
+    // Redraw this node on the next render, call it when something it draws
+    // changed behind its back (like the contents of an image).
+    void invalidate();
+
+    virtual void draw(Teensy_Parallel_GFX &tft) = 0;
+
+  protected:
+    friend class Teensy_Parallel_Scene;
+    Teensy_Parallel_Scene *_scene = nullptr;
+    Teensy_Parallel_SceneNode *_next = nullptr; // scene list, in z order
+    int16_t _x, _y, _w, _h;
+    int16_t _z = 0;
+    bool _visible = true;
+};
+
+// Filled (or outlined) rectangle, optionally with rounded corners
+class Teensy_Parallel_RectNode : public Teensy_Parallel_SceneNode {
+  public:
+    Teensy_Parallel_RectNode(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, bool filled = true)
+        : Teensy_Parallel_SceneNode(x, y, w, h), _color(color), _filled(filled) {}
+    void setColor(uint16_t color);
+    void setRadius(int16_t radius);
+    virtual void draw(Teensy_Parallel_GFX &tft);
+
+  protected:
+    uint16_t _color;
+    bool _filled;
+    int16_t _radius = 0;
+};
+
+// Text drawn at the top left of the node, the node size is the area it can use.
+// The text is not copied, so call setText again after changing it.
+class Teensy_Parallel_TextNode : public Teensy_Parallel_SceneNode {
+  public:
+    Teensy_Parallel_TextNode(int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint16_t color)
+        : Teensy_Parallel_SceneNode(x, y, w, h), _text(text), _color(color) {}
+    void setText(const char *text);
+    void setColor(uint16_t color);
+    void setBackground(uint16_t color); // fill the node area behind the text
+    void setTransparent();              // no background (the default)
+    void setFont(const ILI9341_t3_font_t &f);
+    void setFont(const GFXfont *f = NULL);
+    void setFont(const RLE_font_t &f);
+    void setTextSize(uint8_t size);
+    virtual void draw(Teensy_Parallel_GFX &tft);
+
+  protected:
+    const char *_text;
+    uint16_t _color;
+    uint16_t _bg_color = 0;
+    bool _has_bg = false;
+    uint8_t _text_size = 1;
+    const ILI9341_t3_font_t *_ili_font = nullptr;
+    const GFXfont *_gfx_font = nullptr;
+    const RLE_font_t *_rle_font = nullptr;
+};
+
+// w x h 565 image, pixels matching the key color are left alone when one is set
+class Teensy_Parallel_ImageNode : public Teensy_Parallel_SceneNode {
+  public:
+    Teensy_Parallel_ImageNode(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors)
+        : Teensy_Parallel_SceneNode(x, y, w, h), _pcolors(pcolors) {}
+    void setImage(const uint16_t *pcolors);
+    void setKeyColor(uint16_t key_color);
+    void clearKeyColor();
+    virtual void draw(Teensy_Parallel_GFX &tft);
+
+  protected:
+    const uint16_t *_pcolors;
+    uint16_t _key_color = 0;
+    bool _keyed = false;
+};
+
+// Offscreen canvas, the node is the size of the canvas
+class Teensy_Parallel_CanvasNode : public Teensy_Parallel_SceneNode {
+  public:
+    Teensy_Parallel_CanvasNode(int16_t x, int16_t y, Teensy_Parallel_Canvas &canvas)
+        : Teensy_Parallel_SceneNode(x, y, canvas.width(), canvas.height()), _canvas(&canvas) {}
+    virtual void draw(Teensy_Parallel_GFX &tft) { _canvas->drawTo(tft, _x, _y); }
+
+  protected:
+    Teensy_Parallel_Canvas *_canvas;
+};
+
+class Teensy_Parallel_Scene {
+  public:
+    Teensy_Parallel_Scene(Teensy_Parallel_GFX &tft, uint16_t background_color = 0);
+
+    void add(Teensy_Parallel_SceneNode &node);
+    void remove(Teensy_Parallel_SceneNode &node);
+    void setBackground(uint16_t color);
+
+    // Mark an area (or everything) to be redrawn
+    void invalidate(int16_t x, int16_t y, int16_t w, int16_t h);
+    void invalidate() { invalidate(0, 0, _tft.width(), _tft.height()); }
+    bool damaged() { return _damage.count() != 0; }
+
+    // Redraw the damaged areas, returns false if there were none
+    bool render();
+
+  protected:
+    friend class Teensy_Parallel_SceneNode;
+    void insertSorted(Teensy_Parallel_SceneNode &node);
+    void unlink(Teensy_Parallel_SceneNode &node);
+
+    Teensy_Parallel_GFX &_tft;
+    Teensy_Parallel_SceneNode *_nodes = nullptr;
+    uint16_t _background_color;
+    Teensy_Parallel_DamageList::rect_t _damage_rects[TPGFX_SCENE_MAX_DAMAGE];
+    Teensy_Parallel_DamageList _damage;
+};
+
+#endif
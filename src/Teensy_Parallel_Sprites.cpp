@@ -0,0 +1,218 @@
+#include "Teensy_Parallel_Sprites.h"
+
+Teensy_Parallel_Sprites::Teensy_Parallel_Sprites(Teensy_Parallel_GFX &tft) : _tft(tft) {
+    memset(_sprites, 0, sizeof(_sprites));
+}
+
+void Teensy_Parallel_Sprites::setBackground(uint16_t color) {
+    _background_color = color;
+    _background_image = nullptr;
+    _background_canvas = nullptr;
+    _redraw_all = true;
+}
+
+void Teensy_Parallel_Sprites::setBackground(const uint16_t *image) {
+    _background_image = image;
+    _background_canvas = nullptr;
+    _redraw_all = true;
+}
+
+void Teensy_Parallel_Sprites::setBackground(Teensy_Parallel_Canvas &canvas) {
+    _background_image = nullptr;
+    _background_canvas = &canvas;
+    _redraw_all = true;
+}
+
+void Teensy_Parallel_Sprites::invalidate() {
+    _redraw_all = true;
+}
+
+Teensy_Parallel_Sprites::sprite_t *Teensy_Parallel_Sprites::getSprite(int8_t sprite) {
+    if ((sprite < 0) || (sprite >= TPGFX_MAX_SPRITES) || !_sprites[sprite].used || _sprites[sprite].removed)
+        return nullptr;
+    return &_sprites[sprite];
+}
+
+int8_t Teensy_Parallel_Sprites::add(const uint16_t *image, int16_t w, int16_t h, int16_t x, int16_t y, int16_t z) {
+    for (int8_t i = 0; i < TPGFX_MAX_SPRITES; i++) {
+        sprite_t &s = _sprites[i];
+        if (s.used)
+            continue;
+        memset(&s, 0, sizeof(s));
+        s.used = true;
+        s.visible = true;
+        s.image = image;
+        s.x = x;
+        s.y = y;
+        s.w = w;
+        s.h = h;
+        s.z = z;
+        s.alpha = 255;
+        changed(s);
+        return i;
+    }
+    return -1;
+}
+
+void Teensy_Parallel_Sprites::remove(int8_t sprite) {
+    sprite_t *s = getSprite(sprite);
+    if (!s)
+        return;
+    // Keep it around hidden until the next update has put the background back
+    s->visible = false;
+    s->removed = true;
+    s->used = s->drawn;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setPosition(int8_t sprite, int16_t x, int16_t y) {
+    sprite_t *s = getSprite(sprite);
+    if (!s || ((s->x == x) && (s->y == y)))
+        return;
+    s->x = x;
+    s->y = y;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setImage(int8_t sprite, const uint16_t *image, int16_t w, int16_t h) {
+    sprite_t *s = getSprite(sprite);
+    if (!s)
+        return;
+    s->image = image;
+    s->w = w;
+    s->h = h;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setZ(int8_t sprite, int16_t z) {
+    sprite_t *s = getSprite(sprite);
+    if (!s || (s->z == z))
+        return;
+    s->z = z;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setVisible(int8_t sprite, bool visible) {
+    sprite_t *s = getSprite(sprite);
+    if (!s || (s->visible == visible))
+        return;
+    s->visible = visible;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setKeyColor(int8_t sprite, uint16_t key_color) {
+    sprite_t *s = getSprite(sprite);
+    if (!s)
+        return;
+    s->keyed = true;
+    s->key_color = key_color;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::clearKeyColor(int8_t sprite) {
+    sprite_t *s = getSprite(sprite);
+    if (!s)
+        return;
+    s->keyed = false;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::setAlpha(int8_t sprite, uint8_t alpha) {
+    sprite_t *s = getSprite(sprite);
+    if (!s || (s->alpha == alpha))
+        return;
+    s->alpha = alpha;
+    changed(*s);
+}
+
+void Teensy_Parallel_Sprites::drawArea(const Teensy_Parallel_DamageList::rect_t &area, const uint8_t *order, uint8_t order_count) {
+    int16_t w = area.x2 - area.x1;
+    int16_t h = area.y2 - area.y1;
+    _tft.setClipRect(area.x1, area.y1, w, h);
+
+    // Background first
+    if (_background_image)
+        _tft.writeRect(0, 0, _tft.width(), _tft.height(), _background_image);
+    else if (_background_canvas)
+        _background_canvas->drawTo(_tft, 0, 0);
+    else
+        _tft.fillRect(area.x1, area.y1, w, h, _background_color);
+
+    // Then the sprites on top of it
+    for (uint8_t i = 0; i < order_count; i++) {
+        sprite_t &s = _sprites[order[i]];
+        if ((s.x >= area.x2) || (s.y >= area.y2) || ((s.x + s.w) <= area.x1) || ((s.y + s.h) <= area.y1))
+            continue;
+        if (s.alpha != 255)
+            _tft.writeSubImageRectBlend(s.x, s.y, s.w, s.h, 0, 0, s.w, s.h, s.image, s.alpha, s.keyed, s.key_color);
+        else if (s.keyed)
+            _tft.writeRectKeyed(s.x, s.y, s.w, s.h, s.image, s.key_color);
+        else
+            _tft.writeRect(s.x, s.y, s.w, s.h, s.image);
+    }
+}
+
+void Teensy_Parallel_Sprites::update(bool async) {
+    // Don't draw into the frame buffer while the last update is going out
+    _tft.waitUpdateAsyncComplete();
+    // the caller's clip is put back at the end
+    int16_t clip_x, clip_y, clip_w, clip_h;
+    _tft.getClipRect(&clip_x, &clip_y, &clip_w, &clip_h);
+
+    // Each changed sprite dirties where it was and where it is now, areas that
+    // touch get merged.  There is room for all of them.
+    Teensy_Parallel_DamageList::rect_t area_rects[2 * TPGFX_MAX_SPRITES + 1];
+    Teensy_Parallel_DamageList areas(_tft, area_rects, 2 * TPGFX_MAX_SPRITES + 1);
+    if (_redraw_all) {
+        areas.add(0, 0, _tft.width(), _tft.height());
+        _redraw_all = false;
+    }
+    for (uint8_t i = 0; i < TPGFX_MAX_SPRITES; i++) {
+        sprite_t &s = _sprites[i];
+        if (!s.used || !s.changed)
+            continue;
+        if (s.drawn)
+            areas.add(s.drawn_x, s.drawn_y, s.drawn_w, s.drawn_h);
+        if (s.visible && s.image)
+            areas.add(s.x, s.y, s.w, s.h);
+    }
+
+    // Visible sprites sorted by z, lowest first
+    uint8_t order[TPGFX_MAX_SPRITES];
+    uint8_t order_count = 0;
+    for (uint8_t i = 0; i < TPGFX_MAX_SPRITES; i++) {
+        sprite_t &s = _sprites[i];
+        if (s.removed)
+            s.used = s.removed = false;
+        s.drawn = s.used && s.visible && s.image;
+        if (s.drawn) {
+            s.drawn_x = s.x;
+            s.drawn_y = s.y;
+            s.drawn_w = s.w;
+            s.drawn_h = s.h;
+            uint8_t j = order_count++;
+            while (j && (_sprites[order[j - 1]].z > s.z)) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+        s.changed = false;
+    }
+
+    for (uint8_t i = 0; i < areas.count(); i++)
+        drawArea(areas[i], order, order_count);
+    _tft.setClipRect();
+
+    // Send what changed
+    for (uint8_t i = 0; i < areas.count(); i++) {
+        const Teensy_Parallel_DamageList::rect_t &a = areas[i];
+        if (async) {
+            _tft.updateRectAsync(a.x1, a.y1, a.x2 - a.x1, a.y2 - a.y1);
+        } else {
+            _tft.setClipRect(a.x1, a.y1, a.x2 - a.x1, a.y2 - a.y1);
+            _tft.updateScreen();
+        }
+    }
+    _tft.setClipRect(clip_x, clip_y, clip_w, clip_h);
+}
@@ -0,0 +1,78 @@
+#ifndef _TEENSY_PARALLEL_SPRITES_H_
+#define _TEENSY_PARALLEL_SPRITES_H_
+
+#include "Teensy_Parallel_Canvas.h"
+#include "Teensy_Parallel_DamageList.h"
+
+// Size of the sprite pool
+#ifndef TPGFX_MAX_SPRITES
+#define TPGFX_MAX_SPRITES 16
+#endif
+
+//=============================================================================
+// Sprites over a static background.
+// A fixed pool of sprites, each a 565 image with a position, z order and
+// optional transparent key color and/or alpha.  update() puts the background
+// back only where sprites changed (the old and new bounds of each one), draws
+// the sprites touching those areas in z order and sends just those areas to
+// the screen.  Meant to be used with a frame buffer, without one the sprites
+// are drawn straight to the display (and blending needs readRect support).
+//
+// The background is a display sized 565 image, a canvas or a solid color,
+// and like the sprite images it is not copied.
+//=============================================================================
+class Teensy_Parallel_Sprites {
+  public:
+    Teensy_Parallel_Sprites(Teensy_Parallel_GFX &tft);
+
+    void setBackground(uint16_t color);
+    void setBackground(const uint16_t *image); // width() x height() pixels
+    void setBackground(Teensy_Parallel_Canvas &canvas);
+
+    // Returns the sprite number, or -1 when the pool is full
+    int8_t add(const uint16_t *image, int16_t w, int16_t h, int16_t x, int16_t y, int16_t z = 0);
+    void remove(int8_t sprite);
+
+    void setPosition(int8_t sprite, int16_t x, int16_t y);
+    void setImage(int8_t sprite, const uint16_t *image, int16_t w, int16_t h);
+    void setZ(int8_t sprite, int16_t z); // higher z is drawn on top
+    void setVisible(int8_t sprite, bool visible);
+    void setKeyColor(int8_t sprite, uint16_t key_color);
+    void clearKeyColor(int8_t sprite);
+    void setAlpha(int8_t sprite, uint8_t alpha); // 255 (default) is solid
+    // Redraw everything on the next update
+    void invalidate();
+
+    // Bring the screen up to date, async uses updateRectAsync for the
+    // changed areas (the next update waits for them to go out first).
+    void update(bool async = false);
+
+  protected:
+    typedef struct {
+        const uint16_t *image;
+        int16_t x, y, w, h;
+        int16_t z;
+        int16_t drawn_x, drawn_y, drawn_w, drawn_h; // where it is on the screen now
+        uint8_t alpha;
+        bool used;
+        bool removed; // used until the next update clears it off the screen
+        bool visible;
+        bool drawn;
+        bool changed;
+        bool keyed;
+        uint16_t key_color;
+    } sprite_t;
+
+    sprite_t *getSprite(int8_t sprite);
+    void changed(sprite_t &s) { s.changed = true; }
+    void drawArea(const Teensy_Parallel_DamageList::rect_t &area, const uint8_t *order, uint8_t order_count);
+
+    Teensy_Parallel_GFX &_tft;
+    sprite_t _sprites[TPGFX_MAX_SPRITES];
+    uint16_t _background_color = 0;
+    const uint16_t *_background_image = nullptr;
+    Teensy_Parallel_Canvas *_background_canvas = nullptr;
+    bool _redraw_all = true;
+};
+
+#endif